@@ -0,0 +1,349 @@
+#ifndef LU_H
+#define LU_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <utility>
+#include <algorithm>
+#include "solverCache.h"
+#include "trace.h"
+#include "workspace.h"
+
+namespace lu{
+    inline long double EPSILON = 0.0001; //許容誤差範囲
+}
+
+class LU{
+private:
+    //連立方程式(SimultaneousEquations)の要素
+    int variable_amount; //変数数=方程式数
+    std::vector<std::vector<long double> > coefficient_matrix; //係数行列(方程式数)*(変数数+1)
+    SolverCache* cache; //分解結果のキャッシュ(使わない場合はNULL)
+    SolverCache::Key cache_key;
+    void decomposeInPlace(long double* factor);
+    void unpack(const long double* factor, std::vector<std::vector<long double> >& L_matrix, std::vector<std::vector<long double> >& U_matrix);
+    template<class Lower, class Upper> void substituteInPlace(Lower lower, Upper upper, long double* y_vec, long double* x_vec);
+public:
+    LU(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix);//コンストラクター
+    std::vector<std::vector<long double> > copyCoefficientMatrix();
+    void setCache(SolverCache* cache);
+    void setCache(SolverCache* cache, uint64_t matrix_id);
+    void setRightHandSide(const std::vector<long double>& b_vec);
+    std::vector<long double> runLU();
+    bool runLU(Workspace& workspace, long double* result);
+    static size_t workspaceSize(int variable_amount);
+    std::vector<long double> substitute(const std::vector<std::vector<long double> >& L_matrix, const std::vector<std::vector<long double> >& U_matrix, const std::vector<long double>& b_vec);
+    void LUdecomposition(std::vector<std::vector<long double> >& L_matrix, std::vector<std::vector<long double> >& U_matrix);
+    void showSimultaneousEquations();
+    void showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix);
+    void printMatrix(std::vector<std::vector<long double> > matrix);
+    void printAnswer(std::vector<long double> answer);
+};
+
+//コンストラクター
+inline LU::LU(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix){
+    this->variable_amount = variable_amount;
+    this->coefficient_matrix = coefficient_matrix;
+    this->cache = NULL;
+}
+
+inline std::vector<std::vector<long double> > LU::copyCoefficientMatrix(){
+    std::vector<std::vector<long double> > new_coefficient_matrix;
+    for(std::vector<long double> equation : this->coefficient_matrix){
+        std::vector<long double> new_equation;
+        for(long double coefficient : equation){
+            new_equation.push_back(coefficient);
+        }
+        new_coefficient_matrix.push_back(new_equation);
+    }
+    return new_coefficient_matrix;
+}
+
+//分解結果をcacheに保存し、同じ係数行列なら再利用する(係数行列の内容のハッシュ値をキーとする)
+inline void LU::setCache(SolverCache* cache){
+    this->cache = cache;
+    this->cache_key = SolverCache::keyFor(coefficient_matrix, variable_amount);
+}
+
+//呼び出し側が係数行列に固有のIDを与える場合はハッシュを計算しない
+inline void LU::setCache(SolverCache* cache, uint64_t matrix_id){
+    this->cache = cache;
+    this->cache_key = SolverCache::keyFor(matrix_id, variable_amount);
+}
+
+//係数行列はそのままで右辺だけを差し替える
+inline void LU::setRightHandSide(const std::vector<long double>& b_vec){
+    for(int i = 0; i < variable_amount; i++){
+        coefficient_matrix.at(i).at(variable_amount) = b_vec.at(i);
+    }
+}
+
+/* LU分解法
+Ax = b を LUx = b に変形してからxを求める
+
+(1) Ly = bのyを求めてから
+(2) Ux = yとしてxを求める
+
+(1) Ly = bのyを求める
+Lは下三角行列であるから
+y_{i} = (b_{i} - ∑_{k=0~i-1}(l_{i,k} * y_{k}) )/l_{i,i}
+で求められる(iは0,1,2, ... ,n-1)
+
+(2) Ux = yとしてxを求める
+Uは上三角行列であるから
+x_{i} = y_{i} - ∑_{k=i+1~n-1}(u_{i,k} * x_{k})
+で求められる(iはn-1,n-2,n-3, ... ,0)
+*/
+inline std::vector<long double> LU::runLU(){
+    Workspace workspace(LU::workspaceSize(variable_amount));
+    std::vector<long double> answer(variable_amount);
+    if(!LU::runLU(workspace, answer.data())){
+        return std::vector<long double>();
+    }
+    return answer;
+}
+
+//作業領域(分解したLとUを詰めたn*nの行列とy)のバイト数
+inline size_t LU::workspaceSize(int variable_amount){
+    return Workspace::bytesFor<long double>((size_t)variable_amount * variable_amount) + Workspace::bytesFor<long double>(variable_amount);
+}
+
+//workspaceで分解と代入をしてresultに書く(キャッシュへ初めて保存するとき以外はヒープ確保をしない)。作業領域が足りなければfalse
+inline bool LU::runLU(Workspace& workspace, long double* result){
+    TRACE_SOLVE("lu");
+    WorkspaceScope scope(workspace);
+    int n = variable_amount;
+    long double* y_vec = workspace.allocate<long double>(n);
+    if(y_vec == NULL){
+        return false;
+    }
+    // 与えられた連立方程式を LUx = b とおく.
+    for(int i = 0; i < n; i++){
+        y_vec[i] = coefficient_matrix[i][n];
+    }
+
+    //同じ係数行列の分解結果がキャッシュにあればそれを使う
+    std::shared_ptr<CachedSetup> setup = cache != NULL ? cache->find(cache_key) : nullptr;
+    if(setup != nullptr && !setup->L_matrix.empty()){
+        const std::vector<std::vector<long double> >& L_matrix = setup->L_matrix;
+        const std::vector<std::vector<long double> >& U_matrix = setup->U_matrix;
+        substituteInPlace([&](int i, int k){ return L_matrix[i][k]; }, [&](int i, int k){ return U_matrix[i][k]; }, y_vec, result);
+        return true;
+    }
+
+    //LU分解
+    long double* factor = workspace.allocate<long double>((size_t)n * n);
+    if(factor == NULL){
+        return false;
+    }
+    LU::decomposeInPlace(factor);
+    TRACE_DEBUG(
+        std::vector<std::vector<long double> > L_matrix(n, std::vector<long double>(n, 0));
+        std::vector<std::vector<long double> > U_matrix(n, std::vector<long double>(n, 0));
+        unpack(factor, L_matrix, U_matrix);
+        printf("L:\n");
+        printMatrix(L_matrix);
+        printf("U:\n");
+        printMatrix(U_matrix);
+
+        //＊LU分解の検算
+        std::vector<std::vector<long double> > tmp_matrix(n, std::vector<long double>(n, 0));
+        for(int i = 0; i < n; i++){
+            for(int j = 0; j < n; j++){
+                for(int k = 0; k < n; k++){
+                    tmp_matrix.at(i).at(j) += L_matrix.at(i).at(k) * U_matrix.at(k).at(j);
+                }
+            }
+        }
+        printf("LU:\n");
+        printMatrix(tmp_matrix)
+    );
+
+    if(cache != NULL){
+        //他のソルバーの前処理結果と同じ項目に追記する
+        setup = setup != nullptr ? std::make_shared<CachedSetup>(*setup) : std::make_shared<CachedSetup>();
+        setup->L_matrix.assign(n, std::vector<long double>(n, 0));
+        setup->U_matrix.assign(n, std::vector<long double>(n, 0));
+        unpack(factor, setup->L_matrix, setup->U_matrix);
+        cache->store(cache_key, setup);
+    }
+
+    substituteInPlace([&](int i, int k){ return factor[(size_t)i * n + k]; }, [&](int i, int k){ return factor[(size_t)i * n + k]; }, y_vec, result);
+    return true;
+}
+
+//L、Uの行列から連立方程式の解を導く
+inline std::vector<long double> LU::substitute(const std::vector<std::vector<long double> >& L_matrix, const std::vector<std::vector<long double> >& U_matrix, const std::vector<long double>& b_vec){
+    std::vector<long double> y_vec(b_vec.begin(), b_vec.begin() + variable_amount);
+    std::vector<long double> x_vec(variable_amount, 0);
+    substituteInPlace([&](int i, int k){ return L_matrix.at(i).at(k); }, [&](int i, int k){ return U_matrix.at(i).at(k); }, y_vec.data(), x_vec.data());
+    return x_vec;
+}
+
+//y_vecに入れたbを書き換えてyにし、xをx_vecに書く。lower(i, k), upper(i, k)はL, Uの(i, k)成分
+template<class Lower, class Upper> inline void LU::substituteInPlace(Lower lower, Upper upper, long double* y_vec, long double* x_vec){
+    TRACE_SCOPE("lu.substitute");
+    TRACE_FLOPS(2LL * variable_amount * variable_amount);
+    //(1) Ly = bのyを求める
+    for(int i = 0; i < variable_amount; i++){
+        //y_{i} = (b_{i} - ∑_{k=0~i-1}(l_{i,k} * y_{k}) )/l_{i,i}
+        double long s = 0;
+        for(int k = 0; k < i; k++){
+            s += lower(i, k) * y_vec[k];
+        }
+        y_vec[i] = (y_vec[i] - s) / lower(i, i);
+    }
+    //(2) Ux = yとしてxを求める
+    for(int i = variable_amount-1; i >= 0; i--){
+        //x_{i} = y_{i} - ∑_{k=i+1~n-1}(u_{i,k} * x_{k})
+        double long s = 0;
+        for(int k = i+1; k < variable_amount; k++){
+            s += upper(i, k) * x_vec[k];
+        }
+        x_vec[i] = (y_vec[i] - s);
+    }
+}
+
+/*
+* 大文字の変数は行列(A,A_{1,1},L,Uなど)
+* 小文字の変数はベクトル(a_{1~n-1,0})
+* o、Oは全ての要素が0である
+A=LUに分解する
+A=LUを以下のように解釈できる
+[a_{0,0}    , a_{0    ,1~n-1}]   [l_{0,0}    , o_{0    ,1~n-1}][1          , u_{0    ,1~n-1}]
+[a_{1~n-1,0}, A_{1~n-1,1~n-1}] = [l_{1~n-1,0}, L_{1~n-1,1~n-1}][o_{1~n-1,0}, U_{1~n-1,1~n-1}]
+以上から右辺を計算すると
+                                 [l_{0,0}    , l_{0,0}*u_{0    ,1~n-1}                                  ]
+                               = [l_{1~n-1,0}, l_{1~n-1,0}*u_{0,1~n-1} + L_{1~n-1,1~n-1}*U_{1~n-1,1~n-1}]
+となるため、
+(1)  l_{0    ,0    } = a_{0,0}
+(2)  l_{1~n-1,0    } = a_{1~n-1,0}
+(3)  u_{0    ,1~n-1} = a_{0    ,1~n-1}/l_{0,0}
+(4)  A_{1~n-1,1~n-1} = l_{1~n-1,0}*u_{0,1~n-1} + L_{1~n-1,1~n-1}*U_{1~n-1,1~n-1}
+と得られる
+また(4)より
+(4') A' = A_{1~n-1,1~n-1} - l_{1~n-1,0}*u_{0,1~n-1}  とおく
+=> 
+(5)  A' = L'U' ( = L_{1~n-1,1~n-1}*U_{1~n-1,1~n-1})
+次元が下がったLU分解の式(5)が得られるため再起的に分解することで(1)(2)(3)よりL、Uを決定できる。
+*/
+//LU分解
+inline void LU::LUdecomposition(std::vector<std::vector<long double> >& L_matrix, std::vector<std::vector<long double> >& U_matrix){
+    std::vector<long double> factor((size_t)variable_amount * variable_amount);
+    LU::decomposeInPlace(factor.data());
+    LU::unpack(factor.data(), L_matrix, U_matrix);
+}
+
+//係数行列をfactor(n*n、行優先)に写してその場で分解する
+//終わるとfactorの対角を含む下三角がL、対角を除く上三角がU(Uの対角は1)になる
+inline void LU::decomposeInPlace(long double* factor){
+    TRACE_SCOPE("lu.decomposition");
+    TRACE_FLOPS(2LL * variable_amount * variable_amount * variable_amount / 3);
+    size_t n = variable_amount;
+    for(size_t i = 0; i < n; i++){
+        std::copy(coefficient_matrix[i].begin(), coefficient_matrix[i].begin() + n, factor + i * n);
+    }
+
+    //pivotを対角要素上でずらすことで擬似的に次元を下げる
+    for(size_t pivot = 0; pivot < n; pivot++){
+        //(1)(2) l_{0~n-1,0} = a_{0~n-1,0} はそのまま残す
+        //(3) u_{0    ,1~n-1} = a_{0    ,1~n-1}/l_{0,0}
+        long double* pivot_row = factor + pivot * n;
+        for(size_t j = pivot+1; j < n; j++){
+            pivot_row[j] /= pivot_row[pivot];
+        }
+
+        //(4') A' = A_{1~n-1,1~n-1} - l_{1~n-1,0}*u_{0,1~n-1}
+        for(size_t i = pivot+1; i < n; i++){
+            long double* row = factor + i * n;
+            long double l = row[pivot];
+            for(size_t j = pivot+1; j < n; j++){
+                row[j] -= l * pivot_row[j];
+            }
+        }
+    }
+}
+
+//詰めた分解結果をL、Uの行列に分ける(Uの対角は1にする)
+inline void LU::unpack(const long double* factor, std::vector<std::vector<long double> >& L_matrix, std::vector<std::vector<long double> >& U_matrix){
+    size_t n = variable_amount;
+    for(size_t i = 0; i < n; i++){
+        for(size_t j = 0; j < n; j++){
+            if(j < i){
+                L_matrix.at(i).at(j) = factor[i * n + j];
+            }else if(j == i){
+                L_matrix.at(i).at(j) = factor[i * n + j];
+                U_matrix.at(i).at(j) = 1;
+            }else{
+                U_matrix.at(i).at(j) = factor[i * n + j];
+            }
+        }
+    }
+}
+
+inline void LU::showSimultaneousEquations(){
+    printf("連立方程式:\n");
+    for(std::vector<long double> equation : this->coefficient_matrix){
+        for(int v = 0; v <= variable_amount; v++){
+            long double c = equation.at(v);
+            if(v == variable_amount){
+                printf("\t = ");
+            }else if(c >= 0){
+                printf("\t + ");
+            }else if(c < 0){
+                printf("\t - ");
+            }
+            
+            if(v == variable_amount){
+                printf("%.6Lf", c);
+            }else{
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+inline void LU::showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix){
+    printf("連立方程式:\n");
+    for(std::vector<long double> equation : coefficient_matrix){
+        for(int v = 0; v <= variable_amount; v++){
+            long double c = equation.at(v);
+            if(v == variable_amount){
+                printf("\t = ");
+            }else if(c >= 0){
+                printf("\t + ");
+            }else if(c < 0){
+                printf("\t - ");
+            }
+            
+            if(v == variable_amount){
+                printf("%.6Lf", c);
+            }else{
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+
+//行列を表示
+inline void LU::printMatrix(std::vector<std::vector<long double> > matrix){
+    for(std::vector<long double> rows : matrix){
+        for(long double m : rows){
+            printf("%.6Lf ", m);
+        }
+        printf("\n");
+    }
+}
+
+inline void LU::printAnswer(std::vector<long double> answer){
+    printf("解:\n");
+    for(int i = 0; i < variable_amount; i++){
+        printf("\tx_%02d = %.6Lf\n", i, answer.at(i));
+    }
+}
+
+#endif
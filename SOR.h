@@ -0,0 +1,425 @@
+#ifndef SOR_H
+#define SOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <utility>
+#include <algorithm>
+#include "trace.h"
+#include "workspace.h"
+#include "solverCache.h"
+#include "checkpoint.h"
+
+namespace sor
+{
+    inline long double EPSILON = 0.0001; //許容誤差範囲
+    inline long double OMEGA = 0.96014;      //加速パラメータ(0 < ω < 2)
+    inline int MAX_LOOP = 50;            //最大繰り返し回数
+    inline int TUNE_LOOP = 100;          //ω調整でスペクトル半径を求める冪乗法の繰り返し回数
+}
+
+class SOR
+{
+private:
+    //連立方程式(SimultaneousEquations)の要素
+    int variable_amount;                                      //変数数=方程式数
+    std::vector<std::vector<long double>> coefficient_matrix; //係数行列(方程式数)*(変数数+1)
+    long double omega;                                        //加速パラメータ
+    std::vector<long double> inverted_diagonal;               //対角成分の逆数
+    SolverCache *cache;                                       //前処理結果のキャッシュ(使わない場合はNULL)
+    SolverCache::Key cache_key;
+    Checkpointer *checkpointer;                               //チェックポイントの書き出し(使わない場合はNULL)
+    CheckpointState restart;                                  //resumeで読み込んだ状態
+    bool resuming;                                            //次の実行をrestartから始めるか
+    bool converged;                                           //直前の実行が許容誤差内に収まったか
+    int loop_count;                                           //直前の実行の繰り返し回数
+    long double adjust(const long double *equation, const long double *equation_parameter, int variable_number);
+public:
+    SOR(int variable_amount, std::vector<std::vector<long double>> coefficient_matrix); //コンストラクター
+    std::vector<std::vector<long double>> copyCoefficientMatrix();
+    void setCache(SolverCache *cache);
+    void setCache(SolverCache *cache, uint64_t matrix_id);
+    void setRightHandSide(const std::vector<long double>& b_vec);
+    void setCheckpoint(Checkpointer *checkpointer);
+    bool resume(std::string path);
+    void prepare();
+    long double tuneOmega();
+    long double getOmega();
+    std::vector<long double> runSOR();
+    bool runSOR(Workspace &workspace, long double *result);
+    static size_t workspaceSize(int variable_amount);
+    bool isConverged();
+    int getLoopCount();
+    long double runAjustEquation(std::vector<long double> equation, std::vector<long double> equation_parameter, int variable_number);
+    void showSimultaneousEquations();
+    void showSimultaneousEquations(std::vector<std::vector<long double>> coefficient_matrix);
+    void printAnswer(std::vector<long double> answer);
+};
+
+//コンストラクター
+inline SOR::SOR(int variable_amount, std::vector<std::vector<long double>> coefficient_matrix)
+{
+    this->variable_amount = variable_amount;
+    this->coefficient_matrix = coefficient_matrix;
+    this->omega = sor::OMEGA;
+    this->cache = NULL;
+    this->checkpointer = NULL;
+    this->resuming = false;
+    this->converged = false;
+    this->loop_count = 0;
+}
+
+inline std::vector<std::vector<long double>> SOR::copyCoefficientMatrix()
+{
+    std::vector<std::vector<long double>> new_coefficient_matrix;
+    for (std::vector<long double> equation : this->coefficient_matrix)
+    {
+        std::vector<long double> new_equation;
+        for (long double coefficient : equation)
+        {
+            new_equation.push_back(coefficient);
+        }
+        new_coefficient_matrix.push_back(new_equation);
+    }
+    return new_coefficient_matrix;
+}
+
+//対角成分の逆数と調整済みのωをcacheに保存し、同じ係数行列なら再利用する
+inline void SOR::setCache(SolverCache *cache)
+{
+    this->cache = cache;
+    this->cache_key = SolverCache::keyFor(coefficient_matrix, variable_amount);
+}
+
+//呼び出し側が係数行列に固有のIDを与える場合はハッシュを計算しない
+inline void SOR::setCache(SolverCache *cache, uint64_t matrix_id)
+{
+    this->cache = cache;
+    this->cache_key = SolverCache::keyFor(matrix_id, variable_amount);
+}
+
+//係数行列はそのままで右辺だけを差し替える
+inline void SOR::setRightHandSide(const std::vector<long double>& b_vec)
+{
+    for (int i = 0; i < variable_amount; i++)
+    {
+        coefficient_matrix.at(i).at(variable_amount) = b_vec.at(i);
+    }
+}
+
+//runSORの途中の状態をcheckpointerに渡す(checkpoint::INTERVAL回ごとと最後)
+inline void SOR::setCheckpoint(Checkpointer *checkpointer)
+{
+    this->checkpointer = checkpointer;
+}
+
+//チェックポイントを読み込み、次のrunSORをその解、繰り返し回数、ωから続ける
+inline bool SOR::resume(std::string path)
+{
+    if (!restart.load(path, checkpoint::SOR, coefficient_matrix, variable_amount))
+    {
+        return false;
+    }
+    omega = restart.omega;
+    resuming = true;
+    return true;
+}
+
+//対角成分の逆数を用意する(キャッシュにあればそれを使う)
+inline void SOR::prepare()
+{
+    TRACE_SCOPE("sor.prepare");
+    std::shared_ptr<CachedSetup> setup = cache != NULL ? cache->find(cache_key) : nullptr;
+    if (setup != nullptr && !setup->inverted_diagonal.empty())
+    {
+        inverted_diagonal = setup->inverted_diagonal;
+        return;
+    }
+    inverted_diagonal.assign(variable_amount, 0);
+    for (int i = 0; i < variable_amount; i++)
+    {
+        inverted_diagonal.at(i) = 1 / coefficient_matrix.at(i).at(i);
+    }
+    if (cache != NULL)
+    {
+        setup = setup != nullptr ? std::make_shared<CachedSetup>(*setup) : std::make_shared<CachedSetup>();
+        setup->inverted_diagonal = inverted_diagonal;
+        cache->store(cache_key, setup);
+    }
+}
+
+/* ωの調整
+ヤコビ法の反復行列 B = I - D^{-1}A のスペクトル半径ρを冪乗法で求め、
+最適な加速パラメータ ω = 2 / (1 + √(1 - ρ^2)) とする。
+ρ >= 1 の場合(ヤコビ法が収束しない場合)はωを変えない。
+*/
+inline long double SOR::tuneOmega()
+{
+    std::shared_ptr<CachedSetup> setup = cache != NULL ? cache->find(cache_key) : nullptr;
+    if (setup != nullptr && setup->has_omega)
+    {
+        omega = setup->omega;
+        return omega;
+    }
+    TRACE_SCOPE("sor.tuneOmega");
+    prepare();
+
+    std::vector<long double> v(variable_amount, 1);
+    long double rho = 0;
+    for (int loop = 0; loop < sor::TUNE_LOOP; loop++)
+    {
+        // w = Bv = v - D^{-1}Av
+        std::vector<long double> w(variable_amount, 0);
+        long double norm_v = 0, norm_w = 0;
+        for (int i = 0; i < variable_amount; i++)
+        {
+            long double s = 0;
+            for (int j = 0; j < variable_amount; j++)
+            {
+                if (j != i)
+                {
+                    s += coefficient_matrix.at(i).at(j) * v.at(j);
+                }
+            }
+            w.at(i) = -s * inverted_diagonal.at(i);
+            norm_v += v.at(i) * v.at(i);
+            norm_w += w.at(i) * w.at(i);
+        }
+        if (norm_w == 0)
+        {
+            rho = 0;
+            break;
+        }
+        TRACE_FLOPS(2LL * variable_amount * variable_amount);
+        rho = sqrtl(norm_w / norm_v);
+        long double scale = 1 / sqrtl(norm_w);
+        for (int i = 0; i < variable_amount; i++)
+        {
+            v.at(i) = w.at(i) * scale;
+        }
+    }
+    if (rho < 1)
+    {
+        omega = 2 / (1 + sqrtl(1 - rho * rho));
+    }
+
+    if (cache != NULL)
+    {
+        setup = cache->find(cache_key);
+        setup = setup != nullptr ? std::make_shared<CachedSetup>(*setup) : std::make_shared<CachedSetup>();
+        setup->has_omega = true;
+        setup->omega = omega;
+        cache->store(cache_key, setup);
+    }
+    return omega;
+}
+
+inline long double SOR::getOmega()
+{
+    return omega;
+}
+
+//作業領域(解の1本分)のバイト数
+inline size_t SOR::workspaceSize(int variable_amount)
+{
+    return Workspace::bytesFor<long double>(variable_amount);
+}
+
+inline std::vector<long double> SOR::runSOR()
+{
+    Workspace workspace(SOR::workspaceSize(variable_amount));
+    std::vector<long double> answer(variable_amount);
+    SOR::runSOR(workspace, answer.data());
+    return answer;
+}
+
+//workspaceから解の配列を切り出して解き、resultに書く(前処理が済んでいればヒープ確保をしない)。作業領域が足りなければfalse
+inline bool SOR::runSOR(Workspace &workspace, long double *result)
+{
+    TRACE_SOLVE("sor");
+    WorkspaceScope scope(workspace);
+    prepare();
+    converged = false;
+    long double *answer = workspace.allocate<long double>(variable_amount);
+    if (answer == NULL)
+    {
+        return false;
+    }
+    int first = 0;
+    if (resuming)
+    {
+        std::copy(restart.answer.begin(), restart.answer.end(), answer);
+        first = restart.loop;
+        resuming = false;
+    }
+    else
+    {
+        std::fill(answer, answer + variable_amount, 1); //解の初期値
+    }
+    uint64_t fingerprint = 0;
+    if (checkpointer != NULL)
+    {
+        checkpointer->setHistory(first > 0 ? restart.history : std::vector<long double>());
+        fingerprint = checkpoint::fingerprint(coefficient_matrix, variable_amount);
+    }
+
+    // 修正式を用いて解の計算
+    for (int loop = first; loop < sor::MAX_LOOP; loop++)
+    {
+        TRACE_SCOPE("sor.sweep");
+        TRACE_COUNT("sor.iterations", 1);
+        TRACE_FLOPS(2LL * variable_amount * variable_amount + 3LL * variable_amount);
+        loop_count = loop + 1;
+        //緩和した値でその場で更新し、絶対値誤差の総和も同じ走査で足す(i番目の更新はそれより前の更新に依存するので、ベクトル全体の式にはできない)
+        long double difference = 0;
+        for (int i = 0; i < variable_amount; i++)
+        {
+            long double n_ans = adjust(coefficient_matrix[i].data(), answer, i); //修正式
+            long double relaxed = answer[i] + omega * (n_ans - answer[i]);
+            difference += fabsl(relaxed - answer[i]);
+            answer[i] = relaxed;
+        }
+        TRACE_DEBUG(std::cout << loop + 1 << "回目" << std::endl; SOR::printAnswer(std::vector<long double>(answer, answer + variable_amount)));
+        if (checkpointer != NULL)
+        {
+            checkpointer->record(difference);
+            if (checkpointer->due(loop + 1) || difference < sor::EPSILON || loop + 1 == sor::MAX_LOOP)
+            {
+                checkpointer->submit(checkpoint::SOR, variable_amount, loop + 1, omega, fingerprint, answer);
+            }
+        }
+
+        // 許容誤差範囲なら終了
+        if (difference < sor::EPSILON)
+        {
+            converged = true;
+            std::copy(answer, answer + variable_amount, result);
+            return true;
+        }
+    }
+    printf("最大繰り返し回数を超過しました\n");
+    //解の出力
+    std::copy(answer, answer + variable_amount, result);
+    return true;
+}
+
+inline bool SOR::isConverged()
+{
+    return converged;
+}
+
+inline int SOR::getLoopCount()
+{
+    return loop_count;
+}
+
+//修正式の計算
+inline long double SOR::runAjustEquation(std::vector<long double> equation, std::vector<long double> equation_parameter, int variable_number)
+{
+    return adjust(equation.data(), equation_parameter.data(), variable_number);
+}
+
+//修正式の計算(行をコピーせずに読む)
+inline long double SOR::adjust(const long double *equation, const long double *equation_parameter, int variable_number)
+{
+    long double answer = equation[variable_amount];
+    for (int i = 0; i < variable_amount; i++)
+    {
+        if (i == variable_number)
+        {
+            continue;
+        }
+        answer -= equation[i] * equation_parameter[i];
+    }
+    if (inverted_diagonal.empty())
+    {
+        answer /= equation[variable_number];
+    }
+    else
+    {
+        answer *= inverted_diagonal[variable_number];
+    }
+    return answer;
+}
+
+inline void SOR::showSimultaneousEquations()
+{
+    printf("連立方程式:\n");
+    for (std::vector<long double> equation : this->coefficient_matrix)
+    {
+        for (int v = 0; v <= variable_amount; v++)
+        {
+            long double c = equation.at(v);
+            if (v == variable_amount)
+            {
+                printf("\t = ");
+            }
+            else if (c >= 0)
+            {
+                printf("\t + ");
+            }
+            else if (c < 0)
+            {
+                printf("\t - ");
+            }
+
+            if (v == variable_amount)
+            {
+                printf("%.6Lf", c);
+            }
+            else
+            {
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+inline void SOR::showSimultaneousEquations(std::vector<std::vector<long double>> coefficient_matrix)
+{
+    printf("連立方程式:\n");
+    for (std::vector<long double> equation : coefficient_matrix)
+    {
+        for (int v = 0; v <= variable_amount; v++)
+        {
+            long double c = equation.at(v);
+            if (v == variable_amount)
+            {
+                printf("\t = ");
+            }
+            else if (c >= 0)
+            {
+                printf("\t + ");
+            }
+            else if (c < 0)
+            {
+                printf("\t - ");
+            }
+
+            if (v == variable_amount)
+            {
+                printf("%.6Lf", c);
+            }
+            else
+            {
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+
+inline void SOR::printAnswer(std::vector<long double> answer)
+{
+    printf("解: ");
+    for (int i = 0; i < variable_amount; i++)
+    {
+        printf("\tx_%02d = %.6Lf", i, answer.at(i));
+    }
+    printf("\n");
+}
+
+#endif
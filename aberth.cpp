@@ -0,0 +1,65 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include<vector>
+#include<chrono>
+#include<random>
+#include"aberth.h"
+
+//相対誤差 |f(z)| / ∑|a_k||z|^k (|z| > 1 では係数を逆順にして w = 1/z で求める)
+double relativeResidual(std::vector<double> coefficients, double zr, double zi){
+    double m = zr * zr + zi * zi;
+    if(m > 1){
+        coefficients = std::vector<double>(coefficients.rbegin(), coefficients.rend());
+        zr = zr / m;
+        zi = -zi / m;
+    }
+    double pr, pi, dr, di;
+    horner::evaluateComplex(coefficients.data(), coefficients.size() - 1, zr, zi, pr, pi, dr, di);
+    std::vector<double> absolute;
+    for(double c : coefficients){
+        absolute.push_back(fabs(c));
+    }
+    double scale = horner::evaluate(absolute, sqrt(zr * zr + zi * zi));
+    return sqrt(pr * pr + pi * pi) / scale;
+}
+
+int main(int argc, char* argv[]){
+    //関数の指定
+    int division = 2; //関数の次元
+    std::vector<double> coefficients = {-2, 0, 1}; //係数行列(昇べきの順)
+
+    //関数作成
+    Aberth fx;
+    fx.set(division, coefficients);
+    fx.run();
+    for(std::pair<long double, long double> a : fx.getAnswers()){
+        if(a.second >= 0){
+            printf("近似解 = %Lf + i* %Lf\n", a.first, a.second);
+        }else{
+            printf("近似解 = %Lf - i* %Lf\n", a.first, -a.second);
+        }
+    }
+
+    //係数が乱数の高次多項式
+    int degree = argc > 1 ? atoi(argv[1]) : 1000;
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<double> large(degree + 1);
+    for(double& c : large){
+        c = distribution(random);
+    }
+    ThreadPool pool;
+    Aberth high;
+    high.set(degree, large);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    high.run(&pool);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double worst = 0;
+    for(std::pair<long double, long double> a : high.getAnswers()){
+        worst = fmax(worst, relativeResidual(large, a.first, a.second));
+    }
+    printf("%d次: 収束%s, %d回, %.3f 秒 (%d スレッド), 最大相対誤差 %e\n",
+        degree, high.isConverged() ? "した" : "しなかった", high.getLoopCount(), elapsed, pool.size(), worst);
+    return 0;
+}
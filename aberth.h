@@ -0,0 +1,237 @@
+#ifndef ABERTH_H
+#define ABERTH_H
+
+#include<stdio.h>
+#include<math.h>
+#include<float.h>
+#include<vector>
+#include<utility>
+#include"horner.h"
+#include"threadPool.h"
+
+/* --- --- Aberth-Ehrlich法の概要 --- ---
+n次多項式 f の全ての解 z_1, ..., z_n を同時に更新する。
+   N_i = f(z_i) / f'(z_i)                     (ニュートン法の補正)
+   S_i = ∑_{j≠i} 1 / (z_i - z_j)              (他の解からの反発)
+   z_i ← z_i - N_i / (1 - N_i * S_i)
+単根なら3次収束する。因数を割らないので割り算の誤差が溜まらず、
+各解の更新は前回の値だけから求まるので(ヤコビ型)、解ごとにスレッドへ分けられる。
+・S_i の和はLANES個ずつの配列に足し込むので、最も内側のループがSIMD命令になる
+・|z| > 1 では f(z) が桁あふれするので、係数を逆順にした q(w) = w^n f(1/w) (w = 1/z) から
+     N = z / (n - w*q'(w)/q(w))
+  として求める(1000次を超える多項式でも桁あふれしない)
+・初期値は半径 |a_0/a_n|^(1/n) の円周上に等間隔に置き、角度を少しずらす(実軸対称を崩すため)
+・補正量が相対的にEPSILON以下になった解と、|f(z)|が丸め誤差の大きさ NOISE*∑|a_k||z|^k 以下になった解
+  (重解ではこれ以上近づけない)は固定し、全ての解が固定されれば終了する
+--- --- --- --- */
+namespace aberth{
+    inline double EPSILON = 1e-14; //収束判定(|補正量| <= EPSILON*max(1, |z|))
+    inline int MAX_ITERATION = 1000; //最大繰り返し回数
+    const int LANES = 8; //S_iの和を分ける数
+    const double ANGLE_OFFSET = 0.4; //初期値の角度のずれ
+    const double NOISE = 4 * DBL_EPSILON; //f(z)の評価の丸め誤差の相対的な大きさ
+}
+
+class Aberth{
+private:
+    int division; //関数の次元
+    std::vector<double> coefficients; //係数行列(昇べきの順)
+    std::vector<double> reversed; //係数を逆順にしたもの(|z| > 1 の評価用)
+    std::vector<double> absolute, reversed_absolute; //係数の絶対値(丸め誤差の見積もり用)
+    std::vector<double> real, imag; //解の実部と虚部
+    std::vector<double> next_real, next_imag;
+    std::vector<char> fixed; //収束して固定した解
+    int loop_count = 0;
+    bool converged = false;
+    bool newtonCorrection(double zr, double zi, double& nr, double& ni);
+    void update(int i);
+public:
+    void set(int division, std::vector<double> coefficients);
+    void run(ThreadPool* pool = NULL);
+    std::vector<std::pair<long double, long double> > getAnswers(); //解の配列(pairは実部と虚部)
+    int getLoopCount();
+    bool isConverged();
+};
+
+//コンストラクター
+inline void Aberth::set(int division, std::vector<double> coefficients){
+    //最高次の係数が0なら次数を下げる
+    while(division > 0 && coefficients.at(division) == 0){
+        division--;
+    }
+    this->division = division;
+    this->coefficients.assign(coefficients.begin(), coefficients.begin() + division + 1);
+    this->reversed.assign(this->coefficients.rbegin(), this->coefficients.rend());
+    this->absolute.clear();
+    for(double c : this->coefficients){
+        this->absolute.push_back(fabs(c));
+    }
+    this->reversed_absolute.assign(this->absolute.rbegin(), this->absolute.rend());
+}
+
+//z = (zr, zi) での f(z)/f'(z)。f(z)が丸め誤差に埋もれていればtrueを返す
+inline bool Aberth::newtonCorrection(double zr, double zi, double& nr, double& ni){
+    double pr, pi, dr, di;
+    bool noise;
+    if(zr * zr + zi * zi <= 1){
+        horner::evaluateComplex(coefficients.data(), division, zr, zi, pr, pi, dr, di);
+        noise = sqrt(pr * pr + pi * pi) <= aberth::NOISE * horner::evaluate(absolute.data(), division, sqrt(zr * zr + zi * zi));
+        double norm = dr * dr + di * di;
+        nr = (pr * dr + pi * di) / norm;
+        ni = (pi * dr - pr * di) / norm;
+    }else{
+        double m = zr * zr + zi * zi;
+        double wr = zr / m, wi = -zi / m; //w = 1/z
+        horner::evaluateComplex(reversed.data(), division, wr, wi, pr, pi, dr, di);
+        noise = sqrt(pr * pr + pi * pi) <= aberth::NOISE * horner::evaluate(reversed_absolute.data(), division, 1 / sqrt(m));
+        //t = w*q'/q
+        double norm = pr * pr + pi * pi;
+        double ur = (dr * pr + di * pi) / norm, ui = (di * pr - dr * pi) / norm; //q'/q
+        double tr = wr * ur - wi * ui, ti = wr * ui + wi * ur;
+        //N = z / (n - t)
+        double er = division - tr, ei = -ti;
+        double e = er * er + ei * ei;
+        nr = (zr * er + zi * ei) / e;
+        ni = (zi * er - zr * ei) / e;
+    }
+    if(!std::isfinite(nr) || !std::isfinite(ni)){ //f'(z) = 0など。更新しない
+        nr = 0;
+        ni = 0;
+    }
+    return noise;
+}
+
+//i番目の解を前回の値から更新してnext_real, next_imagへ書く
+inline void Aberth::update(int i){
+    double zr = real[i], zi = imag[i];
+    if(fixed[i]){
+        next_real[i] = zr;
+        next_imag[i] = zi;
+        return;
+    }
+    double nr, ni;
+    if(newtonCorrection(zr, zi, nr, ni)){ //f(z)が丸め誤差に埋もれた: これ以上動かさない
+        next_real[i] = zr;
+        next_imag[i] = zi;
+        fixed[i] = 1;
+        return;
+    }
+
+    //S_i = ∑_{j≠i} 1/(z_i - z_j) = ∑ conj(d)/|d|^2
+    const int L = aberth::LANES;
+    double sr[L] = {0}, si[L] = {0};
+    const double* rr = real.data();
+    const double* ri = imag.data();
+    auto accumulate = [&](int from, int to){
+        int j = from;
+        for(; j + L <= to; j += L){
+            for(int l = 0; l < L; l++){
+                double dr = zr - rr[j + l];
+                double di = zi - ri[j + l];
+                double inverse = 1.0 / (dr * dr + di * di);
+                sr[l] += dr * inverse;
+                si[l] -= di * inverse;
+            }
+        }
+        for(; j < to; j++){
+            double dr = zr - rr[j];
+            double di = zi - ri[j];
+            double inverse = 1.0 / (dr * dr + di * di);
+            sr[0] += dr * inverse;
+            si[0] -= di * inverse;
+        }
+    };
+    accumulate(0, i);
+    accumulate(i + 1, division);
+    double s_real = 0, s_imag = 0;
+    for(int l = 0; l < L; l++){
+        s_real += sr[l];
+        s_imag += si[l];
+    }
+
+    //w = N / (1 - N*S)
+    double er = 1 - (nr * s_real - ni * s_imag);
+    double ei = -(nr * s_imag + ni * s_real);
+    double e = er * er + ei * ei;
+    double wr = (nr * er + ni * ei) / e;
+    double wi = (ni * er - nr * ei) / e;
+    if(!std::isfinite(wr) || !std::isfinite(wi)){ //2つの解が重なった場合などはニュートン法の補正だけにする
+        wr = nr;
+        wi = ni;
+    }
+    next_real[i] = zr - wr;
+    next_imag[i] = zi - wi;
+    if(wr * wr + wi * wi <= aberth::EPSILON * aberth::EPSILON * fmax(1.0, zr * zr + zi * zi)){
+        fixed[i] = 1;
+    }
+}
+
+//Aberth-Ehrlich法の実行(poolがあれば解ごとに並列に更新する)
+inline void Aberth::run(ThreadPool* pool){
+    int n = division;
+    real.assign(n, 0);
+    imag.assign(n, 0);
+    next_real.assign(n, 0);
+    next_imag.assign(n, 0);
+    fixed.assign(n, 0);
+    loop_count = 0;
+    converged = n <= 0;
+    if(n <= 0){
+        return;
+    }
+    //初期値
+    double radius = pow(fabs(coefficients.at(0) / coefficients.at(n)), 1.0 / n);
+    if(radius == 0 || !std::isfinite(radius)){
+        radius = 1;
+    }
+    for(int i = 0; i < n; i++){
+        double angle = 2 * M_PI * i / n + aberth::ANGLE_OFFSET;
+        real[i] = radius * cos(angle);
+        imag[i] = radius * sin(angle);
+    }
+
+    auto step = [this](size_t i){
+        update(i);
+    };
+    for(loop_count = 0; loop_count < aberth::MAX_ITERATION; loop_count++){
+        if(pool != NULL){
+            pool->parallelFor(0, n, step);
+        }else{
+            for(int i = 0; i < n; i++){
+                update(i);
+            }
+        }
+        real.swap(next_real);
+        imag.swap(next_imag);
+        converged = true;
+        for(int i = 0; i < n; i++){
+            if(!fixed[i]){
+                converged = false;
+                break;
+            }
+        }
+        if(converged){
+            loop_count++;
+            break;
+        }
+    }
+}
+
+//getter(answers)
+inline std::vector<std::pair<long double, long double> > Aberth::getAnswers(){
+    std::vector<std::pair<long double, long double> > answers;
+    for(size_t i = 0; i < real.size(); i++){
+        answers.push_back(std::make_pair(real[i], imag[i]));
+    }
+    return answers;
+}
+
+inline int Aberth::getLoopCount(){
+    return loop_count;
+}
+
+inline bool Aberth::isConverged(){
+    return converged;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include "matrixFile.h"
+#include "autoSolver.h"
+
+int main(int argc, char* argv[]){
+    //連立方程式の定義
+    int variable_amount = 3;
+    std::vector<std::vector<long double> > coefficient_matrix = {//連立方程式の拡大係数行列
+        { 0,  2,  1,   7},
+        { 1,  4,  1,  12},
+        { 2,  2,  5,  21}
+    };
+    //ファイルが指定されればそこから読み込む(Matrix Market/CSV/バイナリ形式)
+    if(argc > 1 && !loadAugmentedMatrix(argv[1], variable_amount, coefficient_matrix)){
+        return 1;
+    }
+
+    //関数作成
+    AutoSolver simultaneous_equations(variable_amount, coefficient_matrix);
+    //解法を自動で選んで実行
+    std::vector<long double> answer = simultaneous_equations.run();
+    simultaneous_equations.printAnalysis();
+    simultaneous_equations.printLog();
+    printf("解法: %s\n", simultaneous_equations.getSolverName().c_str());
+    printf("解:\n");
+    for(int i = 0; i < (int)answer.size(); i++){
+        printf("\tx_%02d = %.6Lf\n", i, answer.at(i));
+    }
+    return 0;
+}
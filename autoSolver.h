@@ -0,0 +1,256 @@
+#ifndef AUTO_SOLVER_H
+#define AUTO_SOLVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "LU.h"
+#include "gaussJordan.h"
+#include "jacobi.h"
+#include "gaussSeidel.h"
+#include "SOR.h"
+#include "expression.h"
+
+/* --- --- 解法の自動選択 --- ---
+係数行列を1度だけ走査して、次元、非零要素数、対称性、対角優位性、帯幅、対角成分の符号を調べ、
+以下の順に解法を選ぶ。選んだ理由は全てログに残す。
+(1) 対角成分に0がある           → ガウスジョルダン法(行の入れ替えができる)
+(2) 次元がSMALL_DIRECT以下      → 直接法(反復の準備の方が高くつく)
+                                  対角優位または対称で対角成分が正ならLU分解法、それ以外はガウスジョルダン法
+(3) 狭義対角優位                → 反復法(ヤコビ法・ガウスザイデル法の収束が保証される)
+                                  対称で対角成分が正ならωを調整したSOR法、それ以外はガウスザイデル法
+                                  (ヤコビ法は1回の更新の手間がガウスザイデル法と同じで収束が遅いので選ばない)
+(4) 対称で対角成分が正          → LU分解法(正定値ならピボット選択が要らない)
+(5) それ以外                    → ガウスジョルダン法
+反復法が最大繰り返し回数以内に収束しなかった場合や、LU分解法の解が有限でない場合、
+LU分解法の解の相対残差 |b - Ax|∞ / (|A|∞|x|∞ + |b|∞) がRESIDUAL_TOLERANCEを超える場合
+(対称で対角成分が正でも正定値とは限らず、小さなピボットで精度を失うことがある)は
+ガウスジョルダン法など次の直接法に切り替える。
+--- --- --- --- */
+namespace autoSolver{
+    inline int SMALL_DIRECT = 10; //この次元以下は直接法で解く
+    inline long double SYMMETRY_TOLERANCE = 1e-12; //対称とみなす相対誤差
+    inline long double RESIDUAL_TOLERANCE = 1e-10; //LU分解法の解を受け入れる相対残差の上限
+}
+
+//係数行列の解析結果
+struct MatrixAnalysis{
+    int variable_amount = 0;
+    long long nonzeros = 0; //非零要素数
+    double density = 0; //非零要素の割合
+    bool symmetric = true;
+    bool diagonally_dominant = true; //狭義対角優位(全ての行で |a_ii| > ∑|a_ij|)
+    bool zero_diagonal = false; //対角成分に0がある
+    bool positive_diagonal = true; //対角成分が全て正
+    int bandwidth = 0; //max|i - j| (a_ij ≠ 0)
+    long double dominance_ratio = 0; //max(∑|a_ij| / |a_ii|)。1未満なら狭義対角優位
+};
+
+class AutoSolver{
+private:
+    int variable_amount; //変数数=方程式数
+    std::vector<std::vector<long double> > coefficient_matrix; //係数行列(方程式数)*(変数数+1)
+    MatrixAnalysis analysis;
+    std::string solver_name; //最終的に解を出した解法
+    std::vector<std::string> log; //選択の理由
+    void note(std::string message);
+    bool isFinite(const std::vector<long double>& answer);
+    long double relativeResidual(const std::vector<long double>& answer);
+    std::vector<long double> runDirect(bool try_lu);
+public:
+    AutoSolver(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix);//コンストラクター
+    MatrixAnalysis analyze();
+    std::vector<long double> run();
+    std::string getSolverName();
+    std::vector<std::string> getLog();
+    void printAnalysis();
+    void printLog();
+};
+
+
+//コンストラクター
+inline AutoSolver::AutoSolver(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix){
+    this->variable_amount = variable_amount;
+    this->coefficient_matrix = coefficient_matrix;
+}
+
+inline void AutoSolver::note(std::string message){
+    log.push_back(message);
+}
+
+//係数行列を1度走査して性質を調べる
+inline MatrixAnalysis AutoSolver::analyze(){
+    MatrixAnalysis a;
+    a.variable_amount = variable_amount;
+    for(int i = 0; i < variable_amount; i++){
+        const std::vector<long double>& equation = coefficient_matrix.at(i);
+        long double off_diagonal = 0;
+        for(int j = 0; j < variable_amount; j++){
+            long double c = equation.at(j);
+            if(c != 0){
+                a.nonzeros++;
+                a.bandwidth = std::max(a.bandwidth, abs(i - j));
+            }
+            if(j != i){
+                off_diagonal += fabsl(c);
+            }
+            //対称性は上三角だけを調べる
+            if(j > i && a.symmetric){
+                long double t = coefficient_matrix.at(j).at(i);
+                if(fabsl(c - t) > autoSolver::SYMMETRY_TOLERANCE * fmaxl(fabsl(c), fabsl(t))){
+                    a.symmetric = false;
+                }
+            }
+        }
+        long double d = equation.at(i);
+        if(d == 0){
+            a.zero_diagonal = true;
+            a.diagonally_dominant = false;
+            a.dominance_ratio = INFINITY;
+        }else{
+            long double ratio = off_diagonal / fabsl(d);
+            a.dominance_ratio = fmaxl(a.dominance_ratio, ratio);
+            if(ratio >= 1){
+                a.diagonally_dominant = false;
+            }
+        }
+        if(d <= 0){
+            a.positive_diagonal = false;
+        }
+    }
+    a.density = variable_amount > 0 ? (double)a.nonzeros / ((double)variable_amount * variable_amount) : 0;
+    analysis = a;
+    return a;
+}
+
+inline bool AutoSolver::isFinite(const std::vector<long double>& answer){
+    if(answer.empty()){
+        return false;
+    }
+    for(long double x : answer){
+        if(!std::isfinite(x)){
+            return false;
+        }
+    }
+    return true;
+}
+
+// |b - Ax|∞ / (|A|∞|x|∞ + |b|∞)
+inline long double AutoSolver::relativeResidual(const std::vector<long double>& answer){
+    expression::Augmented<long double> matrix = expression::augmented(coefficient_matrix, variable_amount);
+    expression::ResidualNorms<long double> norms = expression::residualNorms(matrix, matrix.rhs(), expression::vector(answer));
+    long double scale = norms.matrix * expression::normInf(expression::vector(answer)) + norms.rhs;
+    return scale > 0 ? norms.residual / scale : norms.residual;
+}
+
+//直接法で解く(LU分解法の解が有限でないか残差が大きければガウスジョルダン法に切り替える)
+inline std::vector<long double> AutoSolver::runDirect(bool try_lu){
+    if(try_lu){
+        LU solver(variable_amount, coefficient_matrix);
+        std::vector<long double> answer = solver.runLU();
+        if(!isFinite(answer)){
+            note("LU分解法でピボットが0になったため、行を入れ替えられるガウスジョルダン法に切り替える");
+        }else{
+            long double residual = relativeResidual(answer);
+            if(residual <= autoSolver::RESIDUAL_TOLERANCE){
+                solver_name = "LU";
+                return answer;
+            }
+            char buffer[256];
+            snprintf(buffer, sizeof(buffer), "LU分解法の解の相対残差が %.3Le と大きいため、行を入れ替えられるガウスジョルダン法に切り替える", residual);
+            note(buffer);
+        }
+    }
+    GaussJordan solver(variable_amount, coefficient_matrix);
+    std::vector<long double> answer = solver.runGaussJordan();
+    solver_name = "GaussJordan";
+    if(answer.empty()){
+        note("ガウスジョルダン法でも解が一意に定まらない");
+    }else if(relativeResidual(answer) > autoSolver::RESIDUAL_TOLERANCE){
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer), "ガウスジョルダン法の解も相対残差が %.3Le と大きい(ピボットが0のときしか行を入れ替えないため、小さなピボットでは精度を失う)", relativeResidual(answer));
+        note(buffer);
+    }
+    return answer;
+}
+
+inline std::vector<long double> AutoSolver::run(){
+    log.clear();
+    analyze();
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "n = %d, 非零要素の割合 %.3f, 帯幅 %d, 対称%s, 対角優位比 %.3Lf",
+        analysis.variable_amount, analysis.density, analysis.bandwidth,
+        analysis.symmetric ? "" : "でない", analysis.dominance_ratio);
+    note(buffer);
+
+    if(analysis.zero_diagonal){
+        note("対角成分に0があるため、行を入れ替えられるガウスジョルダン法を選ぶ");
+        return runDirect(false);
+    }
+    if(variable_amount <= autoSolver::SMALL_DIRECT){
+        bool lu = analysis.diagonally_dominant || (analysis.symmetric && analysis.positive_diagonal);
+        note(std::string("次元が小さいため直接法を選ぶ(") + (lu ? "ピボット選択が要らないのでLU分解法" : "ガウスジョルダン法") + ")");
+        return runDirect(lu);
+    }
+    if(analysis.diagonally_dominant){
+        std::vector<long double> answer;
+        int loops;
+        bool converged;
+        if(analysis.symmetric && analysis.positive_diagonal){
+            SOR solver(variable_amount, coefficient_matrix);
+            snprintf(buffer, sizeof(buffer), "狭義対角優位で対称、対角成分が正なのでSOR法を選ぶ(ω = %.4Lf)", solver.tuneOmega());
+            note(buffer);
+            answer = solver.runSOR();
+            loops = solver.getLoopCount();
+            converged = solver.isConverged();
+            solver_name = "SOR";
+        }else{
+            note("狭義対角優位なので収束が保証されるガウスザイデル法を選ぶ");
+            GaussSeidel solver(variable_amount, coefficient_matrix);
+            answer = solver.runGaussSeidel();
+            loops = solver.getLoopCount();
+            converged = solver.isConverged();
+            solver_name = "GaussSeidel";
+        }
+        if(converged && isFinite(answer)){
+            snprintf(buffer, sizeof(buffer), "%d回の反復で収束した", loops);
+            note(buffer);
+            return answer;
+        }
+        snprintf(buffer, sizeof(buffer), "%d回の反復で収束しなかったため、直接法(LU分解法)に切り替える", loops);
+        note(buffer);
+        return runDirect(true);
+    }
+    if(analysis.symmetric && analysis.positive_diagonal){
+        note("対称で対角成分が正なので、正定値ならピボット選択の要らないLU分解法を選ぶ");
+        return runDirect(true);
+    }
+    note("対角優位でも対称でもないため、行を入れ替えられるガウスジョルダン法を選ぶ");
+    return runDirect(false);
+}
+
+inline std::string AutoSolver::getSolverName(){
+    return solver_name;
+}
+
+inline std::vector<std::string> AutoSolver::getLog(){
+    return log;
+}
+
+inline void AutoSolver::printAnalysis(){
+    printf("次元 %d, 非零要素 %lld (%.1f%%), 帯幅 %d, 対称: %s, 狭義対角優位: %s, 対角成分に0: %s\n",
+        analysis.variable_amount, analysis.nonzeros, analysis.density * 100, analysis.bandwidth,
+        analysis.symmetric ? "はい" : "いいえ", analysis.diagonally_dominant ? "はい" : "いいえ",
+        analysis.zero_diagonal ? "あり" : "なし");
+}
+
+inline void AutoSolver::printLog(){
+    for(std::string& message : log){
+        printf("[自動選択] %s\n", message.c_str());
+    }
+}
+
+#endif
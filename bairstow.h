@@ -0,0 +1,399 @@
+#ifndef BAIRSTOW_H
+#define BAIRSTOW_H
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<iostream>
+#include<vector>
+#include<cmath>
+#include<complex>
+#include<utility>
+#include<algorithm>
+#include"horner.h"
+#include"threadPool.h"
+#include"trace.h"
+
+/* --- ---　Bairstow's methodの概要 --- ---
+与えられる関数
+f(x) =  a_0 + a_1*x + a_2*x^2 + ... + a_n*x^n
+     = (b_0 + b_1*x + b_2*x^2 + ... + b_{n-2}*x^{n-2})*(x^2 + px + q) + Ax + B
+とおく。
+f(x) = (b_0q + B) + (b_0p + b_1q + A)x + (b_0 + b_1p + b_2q)x^2 + ... + (b_{n-2} + b_{n-1}p + b_nq)x^n
+但し、b_{n-1} = b_n = 0  とする。
+よって、
+=> [1] a_0 = b_0q + B
+   [2] a_1 = b_0p + b_1q + A
+   [3] a_k = b_{k-2} + b_{k-1}p + b_kq (kはn以下の自然数とし、b_{-1} = b_{-2} = 0とする。(要検証、多分いらない))
+以上三式から
+=> [4] A = b_{-1}
+   [5] B = b_{-2} + b_{-1}p
+AとBはpとqの関数であるからテイラー展開より
+   [6] A(p_0 + ∆p, q_0 + ∆q) = A(p_0, q_0) + ∂A/∂p *∆p + ∂A/∂q *∆q = 0
+   [7] B(p_0 + ∆p, q_0 + ∆q) = B(p_0, q_0) + ∂B/∂p *∆p + ∂B/∂q *∆q = 0
+が得られる。(上二式が0になる時が(x^2 + px + q)で因数分解できた場合である。)
+[3]より、
+   [8]  ∂b_k/∂p = -b_{k+1} - ∂b_{k+1}/∂p *p - ∂b_{k+2}/∂p *q
+   [9]  ∂b_k/∂q = -b_{k+2} - ∂b_{k+1}/∂q *p - ∂b_{k+2}/∂q *q
+   [10] ∂b_k/∂p = ∂b_{k-1}/∂q  が得られるため
+   [11] c_k = -∂b_{k-1}/∂p = ∂b_{k-2}/∂q
+とおく。
+[8]または[9]、加えて[11]より
+   [12] c_k = b_k -p*c_{k+1} -q*c_{k+2}
+が得られる。
+[4][5]、[10][11][12]より[6][7]を連立方程式として∆p,∆qを解くと、
+   [13] ∆p = (c_0*b_{-1} - c_1*b_{-2})               / (c_0^2 + c_1*(b_{-1} - c_{-1}))
+   [14] ∆q = (c_0*b_{-2} + b_{-1}*(b_{-1} - c_{-1})) / (c_0^2 + c_1*(b_{-1} - c_{-1}))
+が得られる。
+(Bairstow's methodでは∆pと∆qが許容誤差(イプシロン)以下になるまで
+p_k = p_{k-1} + ∆p, q_k = q_{k-1} + ∆qを繰り返して漸近していく。
+求め終われば(b_0 + b_1*x + b_2*x^2 + ... + b_{n-2}*x^{n-2})に対して同様に繰り返して
+解の全てを求めていく。)
+--- --- --- --- */
+namespace bairstow{
+    const int ROOT = 0; // 関数の解(X軸の位置)
+    const long double EPSILON = 0.0001; //許容誤差範囲
+    const int POLISH_ITERATION = 3; //求めた解を元の多項式でニュートン法にかけて磨く回数
+    const int MAX_ITERATION = 500; //1つの二次式を求めるときの最大繰り返し回数(初期値1つあたり)
+    const int RESTART = 4; //収束しなかったときに初期値を変えてやり直す回数
+    //磨いた後の解を受け入れる相対残差 |p(z)| / ∑|a_k|max(1,|z|)^k の上限
+    //(EPSILONは割り算で次数を下げた多項式での|∆p|, |∆q|の絶対値なので、それだけでは元の多項式の解とは限らない)
+    inline long double RESIDUAL_TOLERANCE = 1e-10;
+}
+
+/* --- --- 作業領域 --- ---
+割り算の途中の係数 a, 漸化式の b, c を保持する。
+必要な大きさは次数だけで決まるので、一度reserveすれば同じ次数以下の多項式では確保し直さない。
+b, c は添字に2を足して b_{-2} を b[0] に置く(剰余による添字計算をしない)。
+--- --- --- --- */
+struct BairstowWorkspace{
+    std::vector<long double> a; //割り算で次数を下げていく多項式
+    std::vector<long double> b; //b[k+2] = b_k (k = -2, ..., n)
+    std::vector<long double> c; //c[k+2] = c_k
+    long long iterations = 0; //solveの反復回数の合計(0に戻すのは呼び出し側)
+    void reserve(int division);
+};
+
+class Bairstow
+{
+private:
+    int division; //関数の次元
+    std::vector<long double> coefficients; //係数行列(昇べきの順)
+    std::vector<std::pair<long double, long double> > answers; //解の配列(pairは実部と虚部)
+    BairstowWorkspace workspace;
+    std::vector<long double> real, imag; //解の実部と虚部(作業用)
+    bool converged = false;
+public:
+    void set(int division, std::vector<long double> coefficients);
+    void printFunction(); //関数表示用メソッド
+    void calcRoot(long double p, long double q); //answersに直接、解が書き込まれる
+    void run(); //実行結果はanswersに直接、解が書き込まれる(前回の解は消す)
+    void polish(); //answersの各解を元の多項式で磨く(因数を割るたびに溜まる誤差を取り除く)
+    std::vector<std::pair<long double, long double> > getAnswers();
+    bool isConverged(); //全ての二次式が繰り返し回数の上限までに求まり、全ての解の相対残差がRESIDUAL_TOLERANCE以下か
+    long long getIterations(); //直前のrunの反復回数(全ての二次式の合計)
+
+    //x^2 + p*x + q の2つの解を real[0..1], imag[0..1] に書く
+    static void quadratic(long double p, long double q, long double* real, long double* imag);
+    //division次の多項式の解 division 個を real, imag に書く(作業領域以外の確保をしない)
+    static bool solve(const long double* coefficients, int division, BairstowWorkspace& workspace, long double* real, long double* imag);
+    //磨いた後の全ての解の相対残差がRESIDUAL_TOLERANCE以下ならtrue
+    static bool polishRoots(const long double* coefficients, int division, int amount, long double* real, long double* imag);
+};
+
+/* --- --- 多項式をまとめて解く --- ---
+多数の多項式(パラメータを振った特性多項式など)をスレッドに分けて解く。
+・スレッドごとに作業領域を持ち、runを繰り返し呼んでも使い回す
+・解は1つの配列にまとめて書く。多項式iの解は [offsets[i], offsets[i+1]) の位置にある
+  (offsets[i+1] - offsets[i] は多項式iの次数)
+定常状態(同じ大きさのまとまりを繰り返し解く)では多項式ごとのヒープ確保は無い。
+--- --- --- --- */
+class BairstowBatch{
+private:
+    ThreadPool* pool; //NULLなら呼び出したスレッドだけで実行する
+    std::vector<BairstowWorkspace> workspaces; //スレッドごとの作業領域
+    std::vector<size_t> offsets;
+    std::vector<long double> real, imag;
+    std::vector<char> converged; //多項式ごとに収束したか
+public:
+    BairstowBatch(ThreadPool* pool = NULL);//コンストラクター
+    //polynomials[i]: 多項式iの係数(昇べきの順)。最高次の係数は0でないこと
+    void run(const std::vector<std::vector<long double> >& polynomials);
+    const std::vector<size_t>& getOffsets();
+    const std::vector<long double>& getReal();
+    const std::vector<long double>& getImag();
+    bool isConverged(size_t i);
+    size_t countFailures();
+};
+
+
+inline void BairstowWorkspace::reserve(int division){
+    if((int)a.size() < division + 1){
+        a.resize(division + 1);
+        b.resize(division + 3);
+        c.resize(division + 3);
+    }
+}
+
+//コンストラクター
+inline void Bairstow::set(int division, std::vector<long double> coefficients){
+    this->division = division;
+    this->coefficients = coefficients;
+}
+
+//保持している情報から関数の多項式表示
+inline void Bairstow::printFunction(){
+    printf("f(x) = ");
+    for(int d = division; d >= 0; d--){
+        long double c = coefficients.at(d);
+        if(c == 0){
+            continue;
+        }else if(c > 0 && d != division){
+            printf(" + ");
+        }else if(c < 0 && d != division){
+            printf(" - ");
+        }
+
+        if(c == 1){
+            printf("x^%d", d);
+        }else if(d == 0){
+            printf("%Lg", fabsl(c));
+        }else{
+            printf("%Lgx^%d", fabsl(c), d);
+        }
+    }
+    printf("\n");
+}
+
+//二次方程式の解を返す(x^2 + p*x + q)
+inline void Bairstow::quadratic(long double p, long double q, long double* real, long double* imag){
+    long double D = p*p -4 * q;//判定式D
+    if(D >= 0){ //実数解(重解は同じ解が二つでる)
+        long double sqrt_D = std::sqrt(D);
+        real[0] = -(p - sqrt_D)/2.0;
+        real[1] = -(p + sqrt_D)/2.0;
+        imag[0] = 0.0;
+        imag[1] = 0.0;
+    }else{
+        long double sqrt_D = std::sqrt(-D);
+        real[0] = -p/2.0;
+        real[1] = -p/2.0;
+        imag[0] = sqrt_D/2.0;
+        imag[1] = -sqrt_D/2.0;
+    }
+}
+
+inline void Bairstow::calcRoot(long double p, long double q){
+    long double r[2], i[2];
+    Bairstow::quadratic(p, q, r, i);
+    this->answers.push_back(std::make_pair(r[0], i[0]));
+    this->answers.push_back(std::make_pair(r[1], i[1]));
+}
+
+//Bairstow's methodの本体
+inline bool Bairstow::solve(const long double* coefficients, int division, BairstowWorkspace& workspace, long double* real, long double* imag){
+    workspace.reserve(division);
+    long double* a = workspace.a.data();
+    long double* b = workspace.b.data();
+    long double* c = workspace.c.data();
+    std::copy(coefficients, coefficients + division + 1, a);
+    int n = division;
+    int found = 0;
+    bool all_converged = true;
+    while(n > 0){
+        if(n == 1){
+            real[found] = -a[0]/a[1];
+            imag[found] = 0;
+            return all_converged;
+        }else if(n == 2){
+            Bairstow::quadratic(a[1]/a[2], a[0]/a[2], real + found, imag + found);
+            return all_converged;
+        }
+        //aから二次式(x^2 + px + q)を因数として出す
+        long double p = 1; //初期値1
+        long double q = 1; //初期値1
+        bool done = false;
+        for(int restart = 0; restart <= bairstow::RESTART && !done; restart++){
+            if(restart > 0){ //初期値を変える(最高次の2項の比と、円周上を回した値)
+                long double angle = restart * 1.1;
+                p = a[n-1]/a[n] * std::cos(angle) + std::sin(angle);
+                q = a[n-2]/a[n] * std::cos(angle) - std::sin(angle);
+            }
+            b[n+1] = b[n+2] = 0; //b_{n-1} = b_n = 0
+            c[n+1] = c[n+2] = 0;
+            for(int loop = 0; loop < bairstow::MAX_ITERATION; loop++){
+                TRACE_COUNT("bairstow.iterations", 1);
+                workspace.iterations++;
+                TRACE_FLOPS(6LL * (n + 1) + 12);
+                for(int k = n; k >= 0; k--){ //b[k] = b_{k-2}
+                    b[k] = a[k] - p*b[k+1] - q*b[k+2];
+                }
+                for(int k = n; k >= 0; k--){
+                    c[k] = b[k] - p*c[k+1] - q*c[k+2];
+                }
+                //c_0 = c[2], c_1 = c[3], b_{-1} = b[1], c_{-1} = c[1], b_{-2} = b[0]
+                long double denominator = c[2]*c[2] + c[3] * (b[1] - c[1]);
+                long double dp = (c[2] * b[1] - c[3] * b[0]) / denominator;
+                long double dq = (c[2] * b[0] + b[1] * (b[1] - c[1])) / denominator;
+                if(!std::isfinite(dp) || !std::isfinite(dq)){
+                    break;
+                }
+                p += dp;
+                q += dq;
+                if(std::abs(dp) <= bairstow::EPSILON && std::abs(dq) <= bairstow::EPSILON){ //両方が許容誤差以下で終了
+                    done = true;
+                    break;
+                }
+            }
+        }
+        if(!done){
+            all_converged = false;
+        }
+        Bairstow::quadratic(p, q, real + found, imag + found);
+        found += 2;
+        //最後のp, qで商 b_0 ... b_{n-2} を求め直して次の多項式にする
+        for(int k = n-2; k >= 0; k--){
+            b[k+2] = a[k+2] - p*b[k+3] - q*b[k+4];
+        }
+        n -= 2;
+        for(int k = 0; k <= n; k++){
+            a[k] = b[k+2];
+        }
+    }
+    return all_converged;
+}
+
+//元の多項式 f のニュートン法(複素数)で解を磨く。f(z)が小さくならない更新は採用しない
+inline bool Bairstow::polishRoots(const long double* coefficients, int division, int amount, long double* real, long double* imag){
+    TRACE_SCOPE("bairstow.polish");
+    bool accepted = true;
+    for(int r = 0; r < amount; r++){
+        std::complex<long double> z(real[r], imag[r]);
+        for(int i = 0; i < bairstow::POLISH_ITERATION; i++){
+            std::complex<long double> dp;
+            std::complex<long double> p = horner::evaluate(coefficients, division, z, &dp);
+            if(std::abs(dp) == 0){
+                break;
+            }
+            std::complex<long double> next = z - p / dp;
+            if(!(std::abs(horner::evaluate(coefficients, division, next)) < std::abs(p))){
+                break;
+            }
+            z = next;
+        }
+        real[r] = z.real();
+        imag[r] = z.imag();
+        if(!(horner::relativeResidual(coefficients, division, real[r], imag[r]) <= bairstow::RESIDUAL_TOLERANCE)){
+            accepted = false;
+        }
+    }
+    return accepted;
+}
+
+//Bairstow's methodの実行
+inline void Bairstow::run(){
+    TRACE_SOLVE("bairstow");
+    answers.clear();
+    workspace.iterations = 0;
+    real.resize(std::max(division, 0));
+    imag.resize(std::max(division, 0));
+    if(division <= 0){
+        converged = true;
+        return;
+    }
+    converged = Bairstow::solve(coefficients.data(), division, workspace, real.data(), imag.data());
+    bool accepted = Bairstow::polishRoots(coefficients.data(), division, division, real.data(), imag.data());
+    converged = converged && accepted;
+    for(int i = 0; i < division; i++){
+        answers.push_back(std::make_pair(real[i], imag[i]));
+    }
+}
+
+inline void Bairstow::polish(){
+    for(std::pair<long double, long double>& a : answers){
+        Bairstow::polishRoots(coefficients.data(), division, 1, &a.first, &a.second);
+    }
+}
+
+//getter(answers)
+inline std::vector<std::pair<long double, long double> > Bairstow::getAnswers(){
+    return this->answers;
+}
+
+inline bool Bairstow::isConverged(){
+    return converged;
+}
+
+inline long long Bairstow::getIterations(){
+    return workspace.iterations;
+}
+
+
+//コンストラクター
+inline BairstowBatch::BairstowBatch(ThreadPool* pool){
+    this->pool = pool;
+    this->workspaces.resize(pool != NULL ? pool->size() : 1);
+}
+
+inline void BairstowBatch::run(const std::vector<std::vector<long double> >& polynomials){
+    size_t amount = polynomials.size();
+    //出力位置を決めて、出力配列を一度だけ確保する(大きさが同じなら確保し直さない)
+    offsets.resize(amount + 1);
+    offsets[0] = 0;
+    for(size_t i = 0; i < amount; i++){
+        offsets[i+1] = offsets[i] + std::max((int)polynomials[i].size() - 1, 0);
+    }
+    real.resize(offsets[amount]);
+    imag.resize(offsets[amount]);
+    converged.resize(amount);
+
+    //スレッドごとに連続した範囲を受け持つ
+    auto work = [&](size_t thread, size_t from, size_t to){
+        BairstowWorkspace& workspace = workspaces[thread];
+        for(size_t i = from; i < to; i++){
+            const std::vector<long double>& f = polynomials[i];
+            int division = (int)f.size() - 1;
+            if(division <= 0){
+                converged[i] = 1;
+                continue;
+            }
+            bool solved = Bairstow::solve(f.data(), division, workspace, &real[offsets[i]], &imag[offsets[i]]);
+            bool accepted = Bairstow::polishRoots(f.data(), division, division, &real[offsets[i]], &imag[offsets[i]]);
+            converged[i] = solved && accepted;
+        }
+    };
+    size_t threads = workspaces.size();
+    if(pool == NULL || threads <= 1){
+        work(0, 0, amount);
+        return;
+    }
+    //この呼び出しの仕事だけを待つ(pool->waitはプールの他の仕事まで待ってしまう)
+    size_t chunk = (amount + threads - 1) / threads;
+    pool->parallelFor(0, threads, [&](size_t t){
+        size_t from = std::min(amount, t * chunk), to = std::min(amount, from + chunk);
+        if(from < to){
+            work(t, from, to);
+        }
+    });
+}
+
+inline const std::vector<size_t>& BairstowBatch::getOffsets(){
+    return offsets;
+}
+
+inline const std::vector<long double>& BairstowBatch::getReal(){
+    return real;
+}
+
+inline const std::vector<long double>& BairstowBatch::getImag(){
+    return imag;
+}
+
+inline bool BairstowBatch::isConverged(size_t i){
+    return converged.at(i);
+}
+
+inline size_t BairstowBatch::countFailures(){
+    return std::count(converged.begin(), converged.end(), 0);
+}
+
+#endif
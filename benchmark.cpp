@@ -0,0 +1,595 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include "LU.h"
+#include "gaussJordan.h"
+#include "jacobi.h"
+#include "gaussSeidel.h"
+#include "SOR.h"
+#include "nibun.h"
+#include "newton.h"
+#include "bairstow.h"
+#include "expression.h"
+
+/* --- --- ベンチマーク --- ---
+再現できる乱数(種を指定)で問題を作り、各ソルバーを大きさを変えながら測ってJSONで出力する。
+問題:
+    dominant : 狭義対角優位な密行列
+    spd      : 対称で狭義対角優位、対角成分が正(正定値)
+    banded   : 帯幅BANDの対角優位な帯行列(密行列として格納)
+    poisson  : m*m格子の2次元ポアソン方程式の5点差分(次元は m^2 >= n となる最小のm^2)
+    polynomial: 係数が標準正規分布の乱数の多項式(大きさは次数)
+連立方程式の解は[-1, 1]の乱数にして、右辺をそこから決める。
+大きさは3から倍々に増やし、1回の実行がTIME_LIMIT秒を超えるか、必要なメモリがMEMORY_LIMITを超えたら打ち切る。
+出力する項目:
+    time        : REPEAT回の最短の実行時間(秒)
+    gflops      : 浮動小数点演算数の見積もり / time
+    bandwidth   : 行列(多項式では係数)を読み書きする量の見積もり / time (GB/s)
+    iterations  : 反復回数(反復法)、評価回数(二分法)など
+    residual    : 連立方程式は |b - Ax|∞ / (|A|∞ |x|∞ + |b|∞)、多項式は |p(r)| / ∑|a_k||r|^k の最大
+--compare baseline.json で以前の出力と比べ、実行時間がTHRESHOLDより遅くなったもの(TIME_FLOOR秒より短いものは除く)、
+残差が10倍を超えて悪くなったものを回帰として表示し、終了コード1を返す。
+ソルバーが標準出力に書く途中経過は、測定中は/dev/nullへ捨てる(--verboseで表示する)。
+--- --- --- --- */
+namespace benchmark{
+    inline double TIME_LIMIT = 1.0; //これより長くかかったら、その組み合わせの大きさを増やさない
+    inline int REPEAT = 3; //繰り返して最短時間をとる回数(0.1秒を超える実行は1回だけ)
+    inline int MAX_SIZE = 1 << 16; //連立方程式の最大の次元
+    inline int MAX_DEGREE = 1 << 12; //多項式の最大の次数
+    inline double MEMORY_LIMIT = 0; //バイト(0なら物理メモリの1/4)
+    inline double THRESHOLD = 0.10; //比較で回帰とみなす遅くなった割合
+    inline uint64_t SEED = 1;
+    inline bool VERBOSE = false;
+    const int BAND = 5; //帯行列の片側の帯幅
+    const double RESIDUAL_RATIO = 10; //比較で回帰とみなす残差の悪化の倍率
+    const double RESIDUAL_FLOOR = 1e-12; //これより小さい残差は比べない
+    const double TIME_FLOOR = 1e-4; //これより短い実行時間は揺らぎが大きいので比べない
+}
+
+typedef std::vector<std::vector<long double> > Matrix;
+typedef std::chrono::steady_clock Clock;
+
+struct Result{
+    std::string solver;
+    std::string problem;
+    int size = 0;
+    double time = 0;
+    double gflops = 0;
+    double bandwidth = 0;
+    long long iterations = 0;
+    double residual = 0;
+    bool converged = true;
+};
+
+//測定中だけ標準出力を/dev/nullにつなぎ替える
+class Silence{
+private:
+    int saved = -1;
+public:
+    Silence(){//コンストラクター
+        if(benchmark::VERBOSE){
+            return;
+        }
+        fflush(stdout);
+        std::cout.flush();
+        saved = dup(1);
+        int null = open("/dev/null", O_WRONLY);
+        if(saved >= 0 && null >= 0){
+            dup2(null, 1);
+        }
+        if(null >= 0){
+            close(null);
+        }
+    }
+    ~Silence(){
+        if(saved < 0){
+            return;
+        }
+        fflush(stdout);
+        std::cout.flush();
+        dup2(saved, 1);
+        close(saved);
+    }
+};
+
+//問題の種類と大きさから決まる乱数(同じ引数なら同じ問題になる)
+std::mt19937_64 generatorFor(const std::string& problem, int size){
+    uint64_t h = benchmark::SEED * 0x9E3779B97F4A7C15ULL + size;
+    for(char c : problem){
+        h = (h ^ (unsigned char)c) * 0x100000001B3ULL;
+    }
+    return std::mt19937_64(h);
+}
+
+//解を[-1, 1]の乱数に決め、右辺を b = Ax として拡大係数行列にする
+//(反復法は初期値を全て1にしているので、解を全て1にすると最初の反復で止まってしまう)
+void appendRightHandSide(Matrix& a, std::mt19937_64& random){
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<long double> x(a.size());
+    for(long double& v : x){
+        v = distribution(random);
+    }
+    for(std::vector<long double>& row : a){
+        long double b = 0;
+        for(size_t j = 0; j < x.size(); j++){
+            b += row[j] * x[j];
+        }
+        row.push_back(b);
+    }
+}
+
+Matrix makeDominant(int n){
+    std::mt19937_64 random = generatorFor("dominant", n);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    Matrix a(n, std::vector<long double>(n));
+    for(int i = 0; i < n; i++){
+        for(int j = 0; j < n; j++){
+            a[i][j] = i == j ? n : distribution(random);
+        }
+    }
+    appendRightHandSide(a, random);
+    return a;
+}
+
+Matrix makeSPD(int n){
+    std::mt19937_64 random = generatorFor("spd", n);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    Matrix a(n, std::vector<long double>(n));
+    for(int i = 0; i < n; i++){
+        for(int j = 0; j < i; j++){
+            a[i][j] = a[j][i] = distribution(random);
+        }
+        a[i][i] = n;
+    }
+    appendRightHandSide(a, random);
+    return a;
+}
+
+Matrix makeBanded(int n){
+    std::mt19937_64 random = generatorFor("banded", n);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    Matrix a(n, std::vector<long double>(n, 0));
+    for(int i = 0; i < n; i++){
+        for(int j = std::max(0, i - benchmark::BAND); j <= std::min(n - 1, i + benchmark::BAND); j++){
+            a[i][j] = i == j ? 2 * benchmark::BAND + 1 : distribution(random);
+        }
+    }
+    appendRightHandSide(a, random);
+    return a;
+}
+
+//m*m格子の5点差分(4, -1)。次元は m^2 >= n となる最小のm^2
+Matrix makePoisson(int n){
+    std::mt19937_64 random = generatorFor("poisson", n);
+    int m = std::max(2, (int)ceil(sqrt((double)n)));
+    int size = m * m;
+    Matrix a(size, std::vector<long double>(size, 0));
+    for(int y = 0; y < m; y++){
+        for(int x = 0; x < m; x++){
+            int i = y * m + x;
+            a[i][i] = 4;
+            if(x > 0) a[i][i - 1] = -1;
+            if(x + 1 < m) a[i][i + 1] = -1;
+            if(y > 0) a[i][i - m] = -1;
+            if(y + 1 < m) a[i][i + m] = -1;
+        }
+    }
+    appendRightHandSide(a, random);
+    return a;
+}
+
+std::vector<long double> makePolynomial(int degree){
+    std::mt19937_64 random = generatorFor("polynomial", degree);
+    std::normal_distribution<double> distribution(0, 1);
+    std::vector<long double> c(degree + 1);
+    for(long double& v : c){
+        v = distribution(random);
+    }
+    return c;
+}
+
+// |b - Ax|∞ / (|A|∞ |x|∞ + |b|∞)
+double residualOf(const Matrix& a, const std::vector<long double>& x){
+    int n = a.size();
+    if((int)x.size() != n){
+        return INFINITY;
+    }
+    expression::Augmented<long double> matrix = expression::augmented(a, n);
+    expression::ResidualNorms<long double> norms = expression::residualNorms(matrix, matrix.rhs(), expression::vector(x));
+    long double norm_x = expression::normInf(expression::vector(x));
+    return (double)(norms.residual / (norms.matrix * norm_x + norms.rhs));
+}
+
+// |p(z)| / ∑|a_k||z|^k (z = re + i im)
+double polynomialResidual(const std::vector<long double>& c, long double re, long double im){
+    long double pr = 0, pi = 0, scale = 0, modulus = sqrtl(re * re + im * im);
+    for(int k = c.size() - 1; k >= 0; k--){
+        long double t = pr * re - pi * im + c[k];
+        pi = pr * im + pi * re;
+        pr = t;
+        scale = scale * modulus + fabsl(c[k]);
+    }
+    return (double)(sqrtl(pr * pr + pi * pi) / scale);
+}
+
+//f()をREPEAT回(長ければ1回)実行して最短時間を返す
+double measure(const std::function<void()>& f){
+    double best = INFINITY;
+    for(int r = 0; r < benchmark::REPEAT; r++){
+        Clock::time_point start = Clock::now();
+        {
+            Silence silence;
+            f();
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        best = std::min(best, elapsed);
+        if(elapsed > 0.1){
+            break;
+        }
+    }
+    return best;
+}
+
+double memoryLimit(){
+    if(benchmark::MEMORY_LIMIT > 0){
+        return benchmark::MEMORY_LIMIT;
+    }
+    return (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGE_SIZE) / 4;
+}
+
+//1つの連立方程式ソルバーを測る。解と反復回数、収束したかを返す関数を受け取る
+typedef std::function<std::vector<long double>(const Matrix&, long long&, bool&)> LinearSolver;
+
+Result runLinear(const std::string& name, const std::string& problem, const Matrix& a, const LinearSolver& solver, bool direct){
+    Result result;
+    result.solver = name;
+    result.problem = problem;
+    result.size = a.size();
+    std::vector<long double> x;
+    result.time = measure([&](){
+        x = solver(a, result.iterations, result.converged);
+    });
+    double n = result.size;
+    double matrix_bytes = n * n * sizeof(long double);
+    double flops, bytes;
+    if(direct){
+        //分解で後ろの小行列を毎回読み書きする(∑(n-k)^2 ≒ n^3/3 要素)
+        flops = 2 * n * n * n / 3 + 2 * n * n;
+        bytes = 2 * matrix_bytes * n / 3;
+    }else{
+        flops = 2 * n * n * result.iterations;
+        bytes = matrix_bytes * result.iterations;
+    }
+    result.gflops = flops / result.time * 1e-9;
+    result.bandwidth = bytes / result.time * 1e-9;
+    result.residual = residualOf(a, x);
+    if(!std::isfinite(result.residual)){
+        result.converged = false;
+    }
+    return result;
+}
+
+std::vector<Result> runAll(const std::vector<std::string>& only){
+    auto selected = [&](const std::string& name){
+        return only.empty() || std::find(only.begin(), only.end(), name) != only.end();
+    };
+    std::vector<Result> results;
+    auto report = [&](const Result& r){
+        fprintf(stderr, "%-12s %-10s n = %6d  %10.6f 秒  %7.3f GFLOP/s  反復 %lld  残差 %.2e%s\n",
+            r.solver.c_str(), r.problem.c_str(), r.size, r.time, r.gflops, r.iterations, r.residual, r.converged ? "" : "  (未収束)");
+        results.push_back(r);
+    };
+
+    //連立方程式
+    std::map<std::string, LinearSolver> linear;
+    linear["LU"] = [](const Matrix& a, long long& iterations, bool& converged){
+        int n = a.size();
+        LU solver(n, a);
+        Workspace workspace(LU::workspaceSize(n));
+        std::vector<long double> x(n);
+        iterations = 0;
+        converged = solver.runLU(workspace, x.data());
+        return x;
+    };
+    linear["GaussJordan"] = [](const Matrix& a, long long& iterations, bool& converged){
+        GaussJordan solver(a.size(), a);
+        solver.setVerbose(false);
+        iterations = 0;
+        std::vector<long double> x = solver.runGaussJordan();
+        converged = !x.empty();
+        return x;
+    };
+    linear["Jacobi"] = [](const Matrix& a, long long& iterations, bool& converged){
+        Jacobi solver(a.size(), a);
+        std::vector<long double> x = solver.runJacobi();
+        iterations = solver.getLoopCount();
+        converged = solver.isConverged();
+        return x;
+    };
+    linear["GaussSeidel"] = [](const Matrix& a, long long& iterations, bool& converged){
+        GaussSeidel solver(a.size(), a);
+        std::vector<long double> x = solver.runGaussSeidel();
+        iterations = solver.getLoopCount();
+        converged = solver.isConverged();
+        return x;
+    };
+    linear["SOR"] = [](const Matrix& a, long long& iterations, bool& converged){
+        SOR solver(a.size(), a);
+        solver.tuneOmega();
+        std::vector<long double> x = solver.runSOR();
+        iterations = solver.getLoopCount();
+        converged = solver.isConverged();
+        return x;
+    };
+    std::vector<std::pair<std::string, std::function<Matrix(int)> > > problems = {
+        {"dominant", makeDominant}, {"spd", makeSPD}, {"banded", makeBanded}, {"poisson", makePoisson}
+    };
+    const char* order[] = {"LU", "GaussJordan", "Jacobi", "GaussSeidel", "SOR"};
+    double limit = memoryLimit();
+    for(const char* name : order){
+        if(!selected(name)){
+            continue;
+        }
+        bool direct = strcmp(name, "LU") == 0 || strcmp(name, "GaussJordan") == 0;
+        for(auto& problem : problems){
+            for(int n = 3; n <= benchmark::MAX_SIZE; n = n < 8 ? 8 : n * 2){
+                //問題、ソルバー内の複製、L, Uなどで行列5つ分を見込む
+                if(5.0 * n * (n + 1) * sizeof(long double) > limit){
+                    break;
+                }
+                Matrix a = problem.second(n);
+                Result r = runLinear(name, problem.first, a, linear[name], direct);
+                report(r);
+                if(r.time > benchmark::TIME_LIMIT){
+                    break;
+                }
+            }
+        }
+    }
+
+    //多項式
+    ThreadPool pool;
+    for(int degree = 3; degree <= benchmark::MAX_DEGREE; degree = degree < 8 ? 8 : degree * 2){
+        std::vector<long double> c = makePolynomial(degree);
+        bool slow = false;
+        if(selected("Nibun")){
+            Result r;
+            r.solver = "Nibun";
+            r.problem = "polynomial";
+            r.size = degree;
+            std::vector<long double> roots;
+            Nibun solver;
+            r.time = measure([&](){
+                solver.set(degree, c);
+                roots = solver.runAll(&pool);
+            });
+            r.iterations = solver.getEvaluations();
+            r.gflops = 2.0 * degree * r.iterations / r.time * 1e-9;
+            r.bandwidth = (degree + 1.0) * sizeof(long double) * r.iterations / r.time * 1e-9;
+            for(long double root : roots){
+                r.residual = std::max(r.residual, polynomialResidual(c, root, 0));
+            }
+            report(r);
+            slow = slow || r.time > benchmark::TIME_LIMIT;
+        }
+        if(selected("Newton")){
+            Result r;
+            r.solver = "Newton";
+            r.problem = "polynomial";
+            r.size = degree;
+            std::vector<double> coefficients(c.begin(), c.end());
+            std::vector<double> starts;
+            for(int i = 0; i <= 4 * degree; i++){
+                starts.push_back(-2 + 4.0 * i / (4 * degree));
+            }
+            std::vector<std::vector<double> > roots;
+            NewtonBatch solver(&pool);
+            r.time = measure([&](){
+                roots = solver.run({coefficients}, {starts});
+                r.iterations = solver.getIterations();
+            });
+            r.gflops = 4.0 * degree * r.iterations / r.time * 1e-9;
+            r.bandwidth = (degree + 1.0) * sizeof(double) * r.iterations / r.time * 1e-9;
+            for(double root : roots.at(0)){
+                r.residual = std::max(r.residual, polynomialResidual(c, root, 0));
+            }
+            report(r);
+            slow = slow || r.time > benchmark::TIME_LIMIT;
+        }
+        if(selected("Bairstow")){
+            Result r;
+            r.solver = "Bairstow";
+            r.problem = "polynomial";
+            r.size = degree;
+            Bairstow solver;
+            r.time = measure([&](){
+                solver.set(degree, c);
+                solver.run();
+            });
+            r.converged = solver.isConverged();
+            std::vector<std::pair<long double, long double> > answers = solver.getAnswers();
+            r.iterations = solver.getIterations();
+            //因数を出すたびに次数が2つ下がるので、1回の反復は平均して次数の半分ほどの多項式を扱う
+            //(aを読んでbを書き、bを読んでcを書く)
+            double length = degree / 2.0 + 1;
+            r.gflops = (6 * length + 12) * r.iterations / r.time * 1e-9;
+            r.bandwidth = 4 * length * sizeof(long double) * r.iterations / r.time * 1e-9;
+            for(auto& z : answers){
+                r.residual = std::max(r.residual, polynomialResidual(c, z.first, z.second));
+            }
+            report(r);
+            slow = slow || r.time > benchmark::TIME_LIMIT;
+        }
+        if(slow){
+            break;
+        }
+    }
+    return results;
+}
+
+void writeJSON(const std::vector<Result>& results, FILE* fp){
+    fprintf(fp, "{\n  \"seed\": %llu,\n  \"results\": [\n", (unsigned long long)benchmark::SEED);
+    for(size_t i = 0; i < results.size(); i++){
+        const Result& r = results[i];
+        fprintf(fp, "    {\"solver\": \"%s\", \"problem\": \"%s\", \"size\": %d, \"time\": %.9g, \"gflops\": %.6g, "
+            "\"bandwidth\": %.6g, \"iterations\": %lld, \"residual\": %.6g, \"converged\": %s}%s\n",
+            r.solver.c_str(), r.problem.c_str(), r.size, r.time, r.gflops, r.bandwidth, r.iterations,
+            std::isfinite(r.residual) ? r.residual : 1e308, r.converged ? "true" : "false", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+//writeJSONが書いた形式(1行に1つの結果)だけを読む
+std::vector<Result> readJSON(const std::string& path){
+    std::vector<Result> results;
+    std::ifstream in(path);
+    if(!in){
+        std::cerr << "error : " << path << " を開けません" << std::endl;
+        return results;
+    }
+    auto field = [](const std::string& line, const std::string& key) -> std::string{
+        size_t p = line.find("\"" + key + "\":");
+        if(p == std::string::npos){
+            return "";
+        }
+        p += key.size() + 3;
+        while(p < line.size() && line[p] == ' '){
+            p++;
+        }
+        if(p < line.size() && line[p] == '"'){
+            size_t end = line.find('"', p + 1);
+            return line.substr(p + 1, end - p - 1);
+        }
+        size_t end = line.find_first_of(",}", p);
+        return line.substr(p, end - p);
+    };
+    for(std::string line; std::getline(in, line);){
+        if(line.find("\"solver\"") == std::string::npos){
+            continue;
+        }
+        Result r;
+        r.solver = field(line, "solver");
+        r.problem = field(line, "problem");
+        r.size = atoi(field(line, "size").c_str());
+        r.time = atof(field(line, "time").c_str());
+        r.gflops = atof(field(line, "gflops").c_str());
+        r.bandwidth = atof(field(line, "bandwidth").c_str());
+        r.iterations = atoll(field(line, "iterations").c_str());
+        r.residual = atof(field(line, "residual").c_str());
+        r.converged = field(line, "converged") == "true";
+        results.push_back(r);
+    }
+    return results;
+}
+
+//同じ(ソルバー, 問題, 大きさ)の結果を比べて回帰の数を返す
+int compare(const std::vector<Result>& baseline, const std::vector<Result>& current){
+    std::map<std::string, const Result*> index;
+    auto key = [](const Result& r){
+        return r.solver + "/" + r.problem + "/" + std::to_string(r.size);
+    };
+    for(const Result& r : baseline){
+        index[key(r)] = &r;
+    }
+    int regressions = 0;
+    fprintf(stderr, "\n%-12s %-10s %6s %12s %12s %8s  %s\n", "solver", "problem", "n", "baseline", "current", "ratio", "");
+    for(const Result& r : current){
+        auto found = index.find(key(r));
+        if(found == index.end()){
+            continue;
+        }
+        const Result& b = *found->second;
+        double ratio = r.time / b.time;
+        std::string flag;
+        if(ratio > 1 + benchmark::THRESHOLD && r.time > benchmark::TIME_FLOOR){
+            flag += " 遅くなった";
+        }
+        if(r.residual > benchmark::RESIDUAL_FLOOR && r.residual > benchmark::RESIDUAL_RATIO * b.residual){
+            flag += " 残差が悪化";
+        }
+        if(b.converged && !r.converged){
+            flag += " 収束しなくなった";
+        }
+        if(!flag.empty()){
+            regressions++;
+        }
+        fprintf(stderr, "%-12s %-10s %6d %12.6f %12.6f %8.3f %s\n", r.solver.c_str(), r.problem.c_str(), r.size, b.time, r.time, ratio, flag.c_str());
+    }
+    fprintf(stderr, "回帰 %d 件 (閾値 %.0f%%)\n", regressions, benchmark::THRESHOLD * 100);
+    return regressions;
+}
+
+int main(int argc, char* argv[]){
+    std::string output, baseline;
+    std::vector<std::string> only;
+    for(int i = 1; i < argc; i++){
+        std::string option = argv[i];
+        bool has_value = i + 1 < argc;
+        if(option == "--output" && has_value){
+            output = argv[++i];
+        }else if(option == "--compare" && has_value){
+            baseline = argv[++i];
+        }else if(option == "--only" && has_value){
+            std::stringstream list(argv[++i]);
+            for(std::string item; std::getline(list, item, ',');){
+                only.push_back(item);
+            }
+        }else if(option == "--max-size" && has_value){
+            benchmark::MAX_SIZE = atoi(argv[++i]);
+        }else if(option == "--max-degree" && has_value){
+            benchmark::MAX_DEGREE = atoi(argv[++i]);
+        }else if(option == "--time-limit" && has_value){
+            benchmark::TIME_LIMIT = atof(argv[++i]);
+        }else if(option == "--memory" && has_value){
+            benchmark::MEMORY_LIMIT = atof(argv[++i]) * 1024 * 1024;
+        }else if(option == "--repeat" && has_value){
+            benchmark::REPEAT = std::max(1, atoi(argv[++i]));
+        }else if(option == "--threshold" && has_value){
+            benchmark::THRESHOLD = atof(argv[++i]);
+        }else if(option == "--seed" && has_value){
+            benchmark::SEED = strtoull(argv[++i], NULL, 10);
+        }else if(option == "--verbose"){
+            benchmark::VERBOSE = true;
+        }else{
+            fprintf(stderr, "usage: %s [--output file.json] [--compare baseline.json] [--only LU,SOR,...]\n"
+                "          [--max-size n] [--max-degree d] [--time-limit s] [--memory MB] [--repeat r]\n"
+                "          [--threshold 0.10] [--seed s] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Result> results = runAll(only);
+    if(output.empty()){
+        writeJSON(results, stdout);
+    }else{
+        FILE* fp = fopen(output.c_str(), "w");
+        if(fp == NULL){
+            std::cerr << "error : " << output << " に書き込めません" << std::endl;
+            return 1;
+        }
+        writeJSON(results, fp);
+        fclose(fp);
+    }
+    if(!baseline.empty()){
+        std::vector<Result> previous = readJSON(baseline);
+        if(previous.empty()){
+            return 1;
+        }
+        return compare(previous, results) > 0 ? 1 : 0;
+    }
+    return 0;
+}
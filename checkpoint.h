@@ -0,0 +1,340 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include "solverCache.h"
+
+/* --- --- 反復法のチェックポイント --- ---
+ヤコビ法、ガウスザイデル法、SOR法の途中の状態(解、済んだ繰り返しの回数、ω、直近HISTORY回の絶対値誤差の総和の履歴)を
+一定の繰り返しごとにバイナリファイルへ保存し、中断されたらそこから再開できるようにする。
+    Checkpointer checkpointer("sor.ckpt"); //書き出し用のスレッドを1つ起動する
+    solver.setCheckpoint(&checkpointer);
+    solver.resume("sor.ckpt");              //再開するときだけ(失敗すればfalse)
+    solver.runSOR();
+・ソルバーはsubmitで状態を複製して渡すだけで、ファイルへの書き込みは裏のスレッドが行う(反復を止めない)
+・書き込み中に次の状態が来たら最新のものだけを残す(古いものは書かずに捨てる)
+・一時ファイルに書いてfsyncしてから置き換えるので、書き込み中に止まっても前のチェックポイントは壊れない
+・係数行列と右辺の指紋(fingerprint)を保存し、別の連立方程式では再開しない
+・履歴は直近HISTORY回分だけをリングバッファーに持つので、何時間回してもsubmitの手間とファイルの大きさは一定
+ファイルの形式: [0, 128) ヘッダー(checkpoint::Header)、続いて ω、解(variable_amount個)、
+履歴(history_amount個。loop - history_amount + 1 回目から loop 回目までの古い順)。
+値はlong doubleのまま書くので、sizeof(long double)が同じ環境でしか読めない。
+--- --- --- --- */
+namespace checkpoint{
+    inline int INTERVAL = 100; //何回の繰り返しごとに保存するか
+    inline size_t HISTORY = 1024; //保存する履歴の最大数(直近のもの)
+    const char MAGIC[8] = {'N', 'A', 'C', 'K', 'P', 'T', '\0', '\0'};
+    const uint32_t VERSION = 2;
+    const uint32_t JACOBI = 1;
+    const uint32_t GAUSS_SEIDEL = 2;
+    const uint32_t SOR = 3;
+
+    struct Header{
+        char     magic[8];
+        uint32_t version;
+        uint32_t method; //JACOBI, GAUSS_SEIDEL, SOR
+        uint32_t long_double_size;
+        uint32_t reserved0;
+        uint64_t variable_amount;
+        uint64_t loop; //済んだ繰り返しの回数
+        uint64_t history_amount;
+        uint64_t fingerprint;
+        uint64_t history_limit; //書き出したときのHISTORY
+        uint8_t  reserved[64];
+    };
+    static_assert(sizeof(Header) == 128, "header must be 128 bytes");
+
+    inline const char* methodName(uint32_t method){
+        switch(method){
+            case JACOBI: return "ヤコビ法";
+            case GAUSS_SEIDEL: return "ガウスザイデル法";
+            case SOR: return "SOR法";
+        }
+        return "不明";
+    }
+
+    //拡大係数行列(右辺を含む)の指紋
+    inline uint64_t fingerprint(const std::vector<std::vector<long double> >& coefficient_matrix, int variable_amount){
+        const uint64_t PRIME = 0x9E3779B185EBCA87ULL;
+        uint64_t h = SolverCache::hash(coefficient_matrix, variable_amount);
+        for(int i = 0; i < variable_amount; i++){
+            double b = (double)coefficient_matrix.at(i).at(variable_amount);
+            uint64_t bits = 0;
+            memcpy(&bits, &b, sizeof(bits));
+            h = ((h ^ bits) * PRIME) ^ (h >> 29);
+        }
+        return h;
+    }
+}
+
+//1つのチェックポイントの内容
+struct CheckpointState{
+    uint32_t method = 0;
+    int variable_amount = 0;
+    long long loop = 0;
+    long double omega = 1; //SOR法以外は1
+    uint64_t fingerprint = 0;
+    std::vector<long double> answer;
+    size_t history_limit = 0;
+    std::vector<long double> history; //直近の繰り返しの絶対値誤差の総和(古い順)
+    bool write(std::string path) const;
+    bool read(std::string path, int expected_amount = -1); //expected_amount: 変数の数が違えば読まない(-1なら確かめない)
+    bool load(std::string path, uint32_t method, const std::vector<std::vector<long double> >& coefficient_matrix, int variable_amount);
+};
+
+//裏のスレッドでチェックポイントを書き出す
+class Checkpointer{
+private:
+    std::string path;
+    int interval;
+    std::vector<long double> history; //直近limit回分のリングバッファー(ソルバーのスレッドだけが触る)
+    size_t limit;
+    size_t history_start = 0; //最も古い要素の位置
+    size_t history_amount = 0;
+    CheckpointState pending; //書き出し待ち
+    CheckpointState writing; //書き出し中(裏のスレッドだけが触る)
+    bool has_pending = false;
+    bool busy = false;
+    bool stopping = false;
+    size_t written = 0;
+    size_t dropped = 0; //書き出す前に新しい状態で置き換えた回数
+    size_t failed = 0;
+    std::mutex mutex;
+    std::condition_variable wake; //裏のスレッドを起こす
+    std::condition_variable idle; //書き出し待ちが無くなった
+    std::thread writer;
+    void run();
+public:
+    Checkpointer(std::string path, int interval = checkpoint::INTERVAL);//コンストラクター
+    ~Checkpointer(); //残っている状態を書き出してから終わる
+    bool due(long long loop); //loop回目の後に保存するか
+    void record(long double difference);
+    void setHistory(const std::vector<long double>& history);
+    void submit(uint32_t method, int variable_amount, long long loop, long double omega, uint64_t fingerprint, const long double* answer);
+    void flush(); //書き出し待ちが無くなるまで待つ
+    std::string getPath();
+    size_t getWritten();
+    size_t getDropped();
+    size_t getFailed();
+};
+
+
+inline bool CheckpointState::write(std::string path) const{
+    checkpoint::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, checkpoint::MAGIC, sizeof(header.magic));
+    header.version = checkpoint::VERSION;
+    header.method = method;
+    header.long_double_size = sizeof(long double);
+    header.variable_amount = variable_amount;
+    header.loop = loop;
+    header.history_amount = history.size();
+    header.fingerprint = fingerprint;
+    header.history_limit = history_limit;
+
+    std::string temporary = path + ".tmp";
+    FILE* fp = fopen(temporary.c_str(), "wb");
+    if(fp == NULL){
+        std::cerr << "error : ファイルを作成できません: " << temporary << std::endl;
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(&omega, sizeof(long double), 1, fp);
+    fwrite(answer.data(), sizeof(long double), answer.size(), fp);
+    fwrite(history.data(), sizeof(long double), history.size(), fp);
+    bool ok = !ferror(fp) && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    ok = (fclose(fp) == 0) && ok;
+    //書き終えてから置き換える(途中で止まっても前のチェックポイントが残る)
+    if(!ok || rename(temporary.c_str(), path.c_str()) != 0){
+        std::cerr << "error : チェックポイントの書き込みに失敗しました: " << path << std::endl;
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+inline bool CheckpointState::read(std::string path, int expected_amount){
+    FILE* fp = fopen(path.c_str(), "rb");
+    if(fp == NULL){
+        std::cerr << "error : ファイルを開けません: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    checkpoint::Header header;
+    bool ok = fstat(fileno(fp), &st) == 0
+        && fread(&header, sizeof(header), 1, fp) == 1
+        && memcmp(header.magic, checkpoint::MAGIC, sizeof(header.magic)) == 0
+        && header.version == checkpoint::VERSION
+        && header.long_double_size == sizeof(long double);
+    //確保する前に、ヘッダーの個数とファイルの大きさが合うか確かめる(壊れたファイルで巨大な確保をしない)
+    uint64_t values = 0, bytes = 0, total = 0;
+    ok = ok && header.variable_amount <= (uint64_t)INT32_MAX && header.history_amount <= header.history_limit
+        && !__builtin_add_overflow(header.variable_amount + 1, header.history_amount, &values)
+        && !__builtin_mul_overflow(values, (uint64_t)sizeof(long double), &bytes)
+        && !__builtin_add_overflow(bytes, (uint64_t)sizeof(header), &total)
+        && total == (uint64_t)st.st_size;
+    if(ok && expected_amount >= 0 && header.variable_amount != (uint64_t)expected_amount){
+        fclose(fp);
+        std::cerr << "error : 変数の数が違うチェックポイントです(" << header.variable_amount << " 個): " << path << std::endl;
+        return false;
+    }
+    if(ok){
+        method = header.method;
+        variable_amount = header.variable_amount;
+        loop = header.loop;
+        fingerprint = header.fingerprint;
+        history_limit = header.history_limit;
+        answer.resize(header.variable_amount);
+        history.resize(header.history_amount);
+        ok = fread(&omega, sizeof(long double), 1, fp) == 1
+            && fread(answer.data(), sizeof(long double), answer.size(), fp) == answer.size()
+            && fread(history.data(), sizeof(long double), history.size(), fp) == history.size();
+    }
+    fclose(fp);
+    if(!ok){
+        std::cerr << "error : チェックポイントの形式が正しくありません: " << path << std::endl;
+    }
+    return ok;
+}
+
+//読み込んで、同じ解法・同じ連立方程式のものか確かめる(ソルバーのresumeから使う)
+inline bool CheckpointState::load(std::string path, uint32_t method, const std::vector<std::vector<long double> >& coefficient_matrix, int variable_amount){
+    if(!read(path, variable_amount)){
+        return false;
+    }
+    if(this->method != method){
+        std::cerr << "error : " << checkpoint::methodName(this->method) << "のチェックポイントです: " << path << std::endl;
+        return false;
+    }
+    if(this->variable_amount != variable_amount || fingerprint != checkpoint::fingerprint(coefficient_matrix, variable_amount)){
+        std::cerr << "error : 別の連立方程式のチェックポイントです: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//コンストラクター
+inline Checkpointer::Checkpointer(std::string path, int interval){
+    this->path = path;
+    this->interval = interval > 0 ? interval : 1;
+    this->limit = std::max<size_t>(checkpoint::HISTORY, 1);
+    this->history.resize(limit);
+    writer = std::thread(&Checkpointer::run, this);
+}
+
+inline Checkpointer::~Checkpointer(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+inline void Checkpointer::run(){
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true){
+        wake.wait(lock, [this]{ return has_pending || stopping; });
+        if(!has_pending){
+            break;
+        }
+        std::swap(pending, writing); //配列の領域ごと入れ替えるので、次のsubmitでも確保し直さない
+        has_pending = false;
+        busy = true;
+        lock.unlock();
+        bool ok = writing.write(path);
+        lock.lock();
+        busy = false;
+        if(ok){
+            written++;
+        }else{
+            failed++;
+        }
+        idle.notify_all();
+    }
+}
+
+inline bool Checkpointer::due(long long loop){
+    return loop % interval == 0;
+}
+
+//直近limit回分だけを残す(一杯なら最も古いものを上書きする)
+inline void Checkpointer::record(long double difference){
+    if(history_amount < limit){
+        history[(history_start + history_amount) % limit] = difference;
+        history_amount++;
+    }else{
+        history[history_start] = difference;
+        history_start = (history_start + 1) % limit;
+    }
+}
+
+//再開するときは保存されていた履歴に続けて記録する
+inline void Checkpointer::setHistory(const std::vector<long double>& history){
+    history_start = 0;
+    history_amount = 0;
+    size_t from = history.size() > limit ? history.size() - limit : 0;
+    for(size_t i = from; i < history.size(); i++){
+        record(history[i]);
+    }
+}
+
+//状態を複製して裏のスレッドに渡す(書き込みは待たない)
+inline void Checkpointer::submit(uint32_t method, int variable_amount, long long loop, long double omega, uint64_t fingerprint, const long double* answer){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(has_pending){
+            dropped++;
+        }
+        pending.method = method;
+        pending.variable_amount = variable_amount;
+        pending.loop = loop;
+        pending.omega = omega;
+        pending.fingerprint = fingerprint;
+        pending.answer.assign(answer, answer + variable_amount);
+        pending.history_limit = limit;
+        pending.history.resize(history_amount); //limit個までなので、2回目以降は確保し直さない
+        for(size_t i = 0; i < history_amount; i++){
+            pending.history[i] = history[(history_start + i) % limit];
+        }
+        has_pending = true;
+    }
+    wake.notify_one();
+}
+
+inline void Checkpointer::flush(){
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]{ return !has_pending && !busy; });
+}
+
+inline std::string Checkpointer::getPath(){
+    return path;
+}
+
+inline size_t Checkpointer::getWritten(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+inline size_t Checkpointer::getDropped(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+inline size_t Checkpointer::getFailed(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include<vector>
+#include<chrono>
+#include<random>
+#include<complex>
+#include"horner.h"
+#include"companion.h"
+
+//相対誤差 |f(z)| / ∑|a_k||z|^k (|z| > 1 では係数を逆順にして 1/z で求める)
+double relativeResidual(std::vector<double> coefficients, std::complex<double> z){
+    if(std::abs(z) > 1){
+        coefficients = std::vector<double>(coefficients.rbegin(), coefficients.rend());
+        z = 1.0 / z;
+    }
+    std::vector<double> absolute;
+    for(double c : coefficients){
+        absolute.push_back(fabs(c));
+    }
+    return std::abs(horner::evaluate(coefficients, z)) / horner::evaluate(absolute, std::abs(z));
+}
+
+void printAnswers(Companion& fx){
+    for(std::pair<long double, long double> a : fx.getAnswers()){
+        if(a.second >= 0){
+            printf("近似解 = %Lf + i* %Lf\n", a.first, a.second);
+        }else{
+            printf("近似解 = %Lf - i* %Lf\n", a.first, -a.second);
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    //関数の指定
+    int division = 2; //関数の次元
+    std::vector<double> coefficients = {-2, 0, 1}; //係数行列(昇べきの順)
+
+    //関数作成
+    Companion fx;
+    fx.set(division, coefficients);
+    fx.run();
+    printAnswers(fx);
+
+    //近接した解: (x-1)^3 (x-1.001)(x^2+1)
+    std::vector<double> c = {1};
+    auto multiply = [&](std::vector<double> g){
+        std::vector<double> h(c.size() + g.size() - 1, 0);
+        for(size_t i = 0; i < c.size(); i++){
+            for(size_t j = 0; j < g.size(); j++){
+                h.at(i + j) += c.at(i) * g.at(j);
+            }
+        }
+        c = h;
+    };
+    multiply({-1, 1});
+    multiply({-1, 1});
+    multiply({-1, 1});
+    multiply({-1.001, 1});
+    multiply({1, 0, 1});
+    Companion cluster;
+    cluster.set(c.size() - 1, c);
+    cluster.run();
+    printf("近接した解 (掃き出し %d 回):\n", cluster.getSweeps());
+    printAnswers(cluster);
+
+    //係数が乱数の高次多項式
+    int degree = argc > 1 ? atoi(argv[1]) : 500;
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<double> large(degree + 1);
+    for(double& a : large){
+        a = distribution(random);
+    }
+    Companion high;
+    high.set(degree, large);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    high.run();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double worst = 0;
+    for(std::pair<long double, long double> a : high.getAnswers()){
+        worst = fmax(worst, relativeResidual(large, std::complex<double>(a.first, a.second)));
+    }
+    printf("%d次: 収束%s, 解 %zu 個, 掃き出し %d 回, %.3f 秒, 最大相対誤差 %e\n",
+        degree, high.isConverged() ? "した" : "しなかった", high.getAnswers().size(), high.getSweeps(), elapsed, worst);
+    return 0;
+}
@@ -0,0 +1,310 @@
+#ifndef COMPANION_H
+#define COMPANION_H
+
+#include<stdio.h>
+#include<math.h>
+#include<vector>
+#include<utility>
+#include<algorithm>
+
+/* --- --- コンパニオン行列の固有値による解法 --- ---
+f(x) = a_0 + a_1*x + ... + a_n*x^n の解は、次のコンパニオン行列Cの固有値に等しい。
+       | -a_{n-1}/a_n  -a_{n-2}/a_n  ...  -a_1/a_n  -a_0/a_n |
+       |      1             0        ...      0         0    |
+   C = |      0             1        ...      0         0    |
+       |     ...                                             |
+       |      0             0        ...      1         0    |
+Cは初めから上ヘッセンベルグ行列なので、ヘッセンベルグ化(O(n^3))をせずにそのままQR法にかけられる。
+(1) 平衡化: 対角行列による相似変換で各行と各列の大きさを揃える(ヘッセンベルグ形は崩れない)
+(2) Francisのダブルシフト付きQR法: 1回の掃き出しはヘッセンベルグ形を保つのでO(n^2)。
+    右下の小行列が1x1または2x2に分かれる(副対角成分が無視できる)たびに固有値を取り出して次数を下げる
+    10回, 20回, ...目で収束しなければ特別なシフトを使う
+1つの固有値あたりの掃き出し回数をMAX_ITERATIONで打ち切るので、計算量は最大でもO(MAX_ITERATION * n^3)に収まる。
+--- --- --- --- */
+namespace companion{
+    inline int MAX_ITERATION = 60; //1つの固有値を取り出すまでの最大の掃き出し回数
+    const double RADIX = 2; //平衡化で掛ける倍率の底(丸め誤差が出ないように2のべき乗にする)
+}
+
+class Companion{
+private:
+    int division; //関数の次元
+    std::vector<double> coefficients; //係数行列(昇べきの順)
+    std::vector<double> matrix; //コンパニオン行列(行優先)
+    std::vector<std::pair<long double, long double> > answers; //解の配列(pairは実部と虚部)
+    int sweeps = 0; //QR法の掃き出し回数の合計
+    bool converged = false;
+    double& at(int i, int j);
+    void build();
+    void balance();
+    bool hessenbergQR(std::vector<double>& real, std::vector<double>& imag);
+public:
+    void set(int division, std::vector<double> coefficients);
+    void run();
+    std::vector<std::pair<long double, long double> > getAnswers();
+    int getSweeps();
+    bool isConverged();
+};
+
+//コンストラクター
+inline void Companion::set(int division, std::vector<double> coefficients){
+    //最高次の係数が0なら次数を下げる
+    while(division > 0 && coefficients.at(division) == 0){
+        division--;
+    }
+    this->division = division;
+    this->coefficients.assign(coefficients.begin(), coefficients.begin() + division + 1);
+}
+
+inline double& Companion::at(int i, int j){
+    return matrix[(size_t)i * division + j];
+}
+
+inline void Companion::build(){
+    int n = division;
+    matrix.assign((size_t)n * n, 0);
+    for(int j = 0; j < n; j++){
+        at(0, j) = -coefficients.at(n - 1 - j) / coefficients.at(n);
+    }
+    for(int i = 1; i < n; i++){
+        at(i, i - 1) = 1;
+    }
+}
+
+//平衡化(各行と各列の絶対値和が近くなるまで2のべき乗で拡大縮小する)
+inline void Companion::balance(){
+    int n = division;
+    double square_radix = companion::RADIX * companion::RADIX;
+    bool done = false;
+    while(!done){
+        done = true;
+        for(int i = 0; i < n; i++){
+            double row = 0, column = 0;
+            for(int j = 0; j < n; j++){
+                if(j != i){
+                    column += fabs(at(j, i));
+                    row += fabs(at(i, j));
+                }
+            }
+            if(column == 0 || row == 0){
+                continue;
+            }
+            double g = row / companion::RADIX;
+            double f = 1;
+            double s = column + row;
+            while(column < g){
+                f *= companion::RADIX;
+                column *= square_radix;
+            }
+            g = row * companion::RADIX;
+            while(column > g){
+                f /= companion::RADIX;
+                column /= square_radix;
+            }
+            if((column + row) / f < 0.95 * s){
+                done = false;
+                g = 1 / f;
+                for(int j = 0; j < n; j++){
+                    at(i, j) *= g;
+                }
+                for(int j = 0; j < n; j++){
+                    at(j, i) *= f;
+                }
+            }
+        }
+    }
+}
+
+//上ヘッセンベルグ行列の全ての固有値をFrancisのダブルシフト付きQR法で求める
+inline bool Companion::hessenbergQR(std::vector<double>& real, std::vector<double>& imag){
+    int n = division;
+    double norm = 0;
+    for(int i = 0; i < n; i++){
+        for(int j = std::max(i - 1, 0); j < n; j++){
+            norm += fabs(at(i, j));
+        }
+    }
+    int last = n - 1; //未収束の小行列の右下の添字
+    double shift = 0; //特別なシフトの累計
+    int l = 0;
+    while(last >= 0){
+        int iteration = 0;
+        do{
+            //副対角成分が無視できる位置lを探す(小行列[l, last]に分かれる)
+            for(l = last; l >= 1; l--){
+                double s = fabs(at(l - 1, l - 1)) + fabs(at(l, l));
+                if(s == 0){
+                    s = norm;
+                }
+                if(fabs(at(l, l - 1)) + s == s){
+                    at(l, l - 1) = 0;
+                    break;
+                }
+            }
+            double x = at(last, last);
+            if(l == last){ //1x1に分かれた: 実固有値
+                real[last] = x + shift;
+                imag[last] = 0;
+                last--;
+            }else{
+                double y = at(last - 1, last - 1);
+                double w = at(last, last - 1) * at(last - 1, last);
+                if(l == last - 1){ //2x2に分かれた: 2次方程式で2つの固有値
+                    double p = 0.5 * (y - x);
+                    double q = p * p + w;
+                    double z = sqrt(fabs(q));
+                    x += shift;
+                    if(q >= 0){
+                        z = p + (p >= 0 ? z : -z);
+                        real[last - 1] = real[last] = x + z;
+                        if(z != 0){
+                            real[last] = x - w / z;
+                        }
+                        imag[last - 1] = imag[last] = 0;
+                    }else{
+                        real[last - 1] = real[last] = x + p;
+                        imag[last - 1] = z;
+                        imag[last] = -z;
+                    }
+                    last -= 2;
+                }else{ //掃き出し
+                    if(iteration >= companion::MAX_ITERATION){
+                        return false;
+                    }
+                    if(iteration == 10 || iteration == 20 || (iteration > 20 && iteration % 10 == 0)){ //特別なシフト
+                        shift += x;
+                        for(int i = 0; i <= last; i++){
+                            at(i, i) -= x;
+                        }
+                        double s = fabs(at(last, last - 1)) + fabs(at(last - 1, last - 2));
+                        y = x = 0.75 * s;
+                        w = -0.4375 * s * s;
+                    }
+                    iteration++;
+                    sweeps++;
+                    //2つの連続した小さい副対角成分を探して掃き出しの開始位置mを決める
+                    int m;
+                    double p = 0, q = 0, r = 0, z;
+                    for(m = last - 2; m >= l; m--){
+                        z = at(m, m);
+                        r = x - z;
+                        double s = y - z;
+                        p = (r * s - w) / at(m + 1, m) + at(m, m + 1);
+                        q = at(m + 1, m + 1) - z - r - s;
+                        r = at(m + 2, m + 1);
+                        s = fabs(p) + fabs(q) + fabs(r);
+                        p /= s;
+                        q /= s;
+                        r /= s;
+                        if(m == l){
+                            break;
+                        }
+                        double u = fabs(at(m, m - 1)) * (fabs(q) + fabs(r));
+                        double v = fabs(p) * (fabs(at(m - 1, m - 1)) + fabs(z) + fabs(at(m + 1, m + 1)));
+                        if(u + v == v){
+                            break;
+                        }
+                    }
+                    for(int i = m + 2; i <= last; i++){
+                        at(i, i - 2) = 0;
+                        if(i != m + 2){
+                            at(i, i - 3) = 0;
+                        }
+                    }
+                    //ハウスホルダー変換で膨らみを右下へ追い出す(ヘッセンベルグ形に戻す)
+                    for(int k = m; k <= last - 1; k++){
+                        if(k != m){
+                            p = at(k, k - 1);
+                            q = at(k + 1, k - 1);
+                            r = 0;
+                            if(k != last - 1){
+                                r = at(k + 2, k - 1);
+                            }
+                            x = fabs(p) + fabs(q) + fabs(r);
+                            if(x != 0){
+                                p /= x;
+                                q /= x;
+                                r /= x;
+                            }
+                        }
+                        double s = sqrt(p * p + q * q + r * r);
+                        s = p >= 0 ? s : -s;
+                        if(s != 0){
+                            if(k == m){
+                                if(l != m){
+                                    at(k, k - 1) = -at(k, k - 1);
+                                }
+                            }else{
+                                at(k, k - 1) = -s * x;
+                            }
+                            p += s;
+                            x = p / s;
+                            y = q / s;
+                            z = r / s;
+                            q /= p;
+                            r /= p;
+                            for(int j = k; j <= last; j++){ //左から掛ける
+                                p = at(k, j) + q * at(k + 1, j);
+                                if(k != last - 1){
+                                    p += r * at(k + 2, j);
+                                    at(k + 2, j) -= p * z;
+                                }
+                                at(k + 1, j) -= p * y;
+                                at(k, j) -= p * x;
+                            }
+                            int bottom = std::min(last, k + 3);
+                            for(int i = l; i <= bottom; i++){ //右から掛ける
+                                p = x * at(i, k) + y * at(i, k + 1);
+                                if(k != last - 1){
+                                    p += z * at(i, k + 2);
+                                    at(i, k + 2) -= p * r;
+                                }
+                                at(i, k + 1) -= p * q;
+                                at(i, k) -= p;
+                            }
+                        }
+                    }
+                }
+            }
+        }while(l < last - 1);
+    }
+    return true;
+}
+
+//コンパニオン行列を作って固有値を求める
+inline void Companion::run(){
+    answers.clear();
+    sweeps = 0;
+    converged = true;
+    if(division <= 0){
+        return;
+    }
+    if(division == 1){
+        answers.push_back(std::make_pair(-coefficients.at(0) / coefficients.at(1), 0));
+        return;
+    }
+    build();
+    balance();
+    std::vector<double> real(division, NAN), imag(division, NAN);
+    converged = hessenbergQR(real, imag);
+    for(int i = 0; i < division; i++){
+        if(!std::isnan(real[i])){ //打ち切った場合は求まった固有値だけを返す
+            answers.push_back(std::make_pair(real[i], imag[i]));
+        }
+    }
+}
+
+//getter(answers)
+inline std::vector<std::pair<long double, long double> > Companion::getAnswers(){
+    return answers;
+}
+
+inline int Companion::getSweeps(){
+    return sweeps;
+}
+
+inline bool Companion::isConverged(){
+    return converged;
+}
+
+#endif
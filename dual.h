@@ -0,0 +1,116 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include<math.h>
+#include<cmath>
+
+/* --- --- 二重数(前進型の自動微分) --- ---
+x + x'ε (ε^2 = 0) を計算すると、f(x + ε) = f(x) + f'(x)ε になる。
+関数を Dual<T>(x, 1) で1回呼ぶだけで値と導関数が同時に求まるので、差分近似のような追加の関数呼び出しが要らない。
+関数は引数の型を決め打ちせずに書く(例: [](auto x){ return x*x - 2; })。
+Dual<Dual<T> >のように入れ子にすると高階の導関数も求まる(derivativesを参照)。
+そのため初等関数の中では std:: を付けずに呼び、入れ子の内側の型にも同じ関数が選ばれるようにしている。
+--- --- --- --- */
+template<class T> struct Dual{
+    T value; //値
+    T derivative; //微分係数
+    Dual(T value = 0, T derivative = 0) : value(value), derivative(derivative){}//コンストラクター
+};
+
+template<class T> inline Dual<T> operator+(const Dual<T>& a, const Dual<T>& b){ return Dual<T>(a.value + b.value, a.derivative + b.derivative); }
+template<class T> inline Dual<T> operator-(const Dual<T>& a, const Dual<T>& b){ return Dual<T>(a.value - b.value, a.derivative - b.derivative); }
+template<class T> inline Dual<T> operator-(const Dual<T>& a){ return Dual<T>(-a.value, -a.derivative); }
+template<class T> inline Dual<T> operator*(const Dual<T>& a, const Dual<T>& b){ return Dual<T>(a.value * b.value, a.derivative * b.value + a.value * b.derivative); }
+template<class T> inline Dual<T> operator/(const Dual<T>& a, const Dual<T>& b){
+    return Dual<T>(a.value / b.value, (a.derivative * b.value - a.value * b.derivative) / (b.value * b.value));
+}
+//定数との演算(定数の微分係数は0)
+template<class T, class S> inline Dual<T> operator+(const Dual<T>& a, S b){ return Dual<T>(a.value + b, a.derivative); }
+template<class T, class S> inline Dual<T> operator+(S a, const Dual<T>& b){ return Dual<T>(a + b.value, b.derivative); }
+template<class T, class S> inline Dual<T> operator-(const Dual<T>& a, S b){ return Dual<T>(a.value - b, a.derivative); }
+template<class T, class S> inline Dual<T> operator-(S a, const Dual<T>& b){ return Dual<T>(a - b.value, -b.derivative); }
+template<class T, class S> inline Dual<T> operator*(const Dual<T>& a, S b){ return Dual<T>(a.value * b, a.derivative * b); }
+template<class T, class S> inline Dual<T> operator*(S a, const Dual<T>& b){ return Dual<T>(a * b.value, a * b.derivative); }
+template<class T, class S> inline Dual<T> operator/(const Dual<T>& a, S b){ return Dual<T>(a.value / b, a.derivative / b); }
+template<class T, class S> inline Dual<T> operator/(S a, const Dual<T>& b){ return Dual<T>(a / b.value, -a * b.derivative / (b.value * b.value)); }
+
+template<class T> inline Dual<T>& operator+=(Dual<T>& a, const Dual<T>& b){ return a = a + b; }
+template<class T> inline Dual<T>& operator-=(Dual<T>& a, const Dual<T>& b){ return a = a - b; }
+template<class T> inline Dual<T>& operator*=(Dual<T>& a, const Dual<T>& b){ return a = a * b; }
+template<class T> inline Dual<T>& operator/=(Dual<T>& a, const Dual<T>& b){ return a = a / b; }
+
+template<class T> inline bool operator<(const Dual<T>& a, const Dual<T>& b){ return a.value < b.value; }
+template<class T> inline bool operator>(const Dual<T>& a, const Dual<T>& b){ return a.value > b.value; }
+template<class T, class S> inline bool operator<(const Dual<T>& a, S b){ return a.value < b; }
+template<class T, class S> inline bool operator>(const Dual<T>& a, S b){ return a.value > b; }
+
+//初等関数(合成関数の微分 f(g)' = f'(g) g')
+template<class T> inline Dual<T> sin(const Dual<T>& a){ using std::sin; using std::cos; return Dual<T>(sin(a.value), cos(a.value) * a.derivative); }
+template<class T> inline Dual<T> cos(const Dual<T>& a){ using std::sin; using std::cos; return Dual<T>(cos(a.value), -sin(a.value) * a.derivative); }
+template<class T> inline Dual<T> tan(const Dual<T>& a){
+    using std::tan;
+    T t = tan(a.value);
+    return Dual<T>(t, (1 + t * t) * a.derivative);
+}
+template<class T> inline Dual<T> exp(const Dual<T>& a){
+    using std::exp;
+    T e = exp(a.value);
+    return Dual<T>(e, e * a.derivative);
+}
+template<class T> inline Dual<T> log(const Dual<T>& a){ using std::log; return Dual<T>(log(a.value), a.derivative / a.value); }
+template<class T> inline Dual<T> sqrt(const Dual<T>& a){
+    using std::sqrt;
+    T s = sqrt(a.value);
+    return Dual<T>(s, a.derivative / (2 * s));
+}
+template<class T> inline Dual<T> atan(const Dual<T>& a){ using std::atan; return Dual<T>(atan(a.value), a.derivative / (1 + a.value * a.value)); }
+template<class T> inline Dual<T> sinh(const Dual<T>& a){ using std::sinh; using std::cosh; return Dual<T>(sinh(a.value), cosh(a.value) * a.derivative); }
+template<class T> inline Dual<T> cosh(const Dual<T>& a){ using std::sinh; using std::cosh; return Dual<T>(cosh(a.value), sinh(a.value) * a.derivative); }
+template<class T> inline Dual<T> tanh(const Dual<T>& a){
+    using std::tanh;
+    T t = tanh(a.value);
+    return Dual<T>(t, (1 - t * t) * a.derivative);
+}
+template<class T> inline Dual<T> fabs(const Dual<T>& a){ return a.value < 0 ? -a : a; }
+template<class T> inline Dual<T> abs(const Dual<T>& a){ return fabs(a); }
+template<class T, class S> inline Dual<T> pow(const Dual<T>& a, S n){ //指数が定数
+    using std::pow;
+    T p = pow(a.value, n - 1);
+    return Dual<T>(p * a.value, (T)n * p * a.derivative);
+}
+template<class T> inline Dual<T> pow(const Dual<T>& a, const Dual<T>& b){ //a^b = exp(b log a)
+    return exp(b * log(a));
+}
+
+//f(x)とf'(x)を1回の呼び出しで求める
+template<class T, class F> inline Dual<T> differentiate(F& f, T x){
+    return f(Dual<T>(x, 1));
+}
+
+//f(x), f'(x), ..., f^(order)(x) (order <= 3) を1回の呼び出しで d[0..order] に求める
+//x + ε_1 + ... + ε_order (ε_i^2 = 0) を入れ子の二重数で表すと、ε_1...ε_k の係数が f^(k)(x) になる
+template<class T, class F> inline void derivatives(F& f, T x, int order, T* d){
+    typedef Dual<T> D1;
+    typedef Dual<D1> D2;
+    typedef Dual<D2> D3;
+    if(order <= 0){
+        d[0] = f(x);
+    }else if(order == 1){
+        D1 y = f(D1(x, 1));
+        d[0] = y.value;
+        d[1] = y.derivative;
+    }else if(order == 2){
+        D2 y = f(D2(D1(x, 1), D1(1, 0)));
+        d[0] = y.value.value;
+        d[1] = y.value.derivative;
+        d[2] = y.derivative.derivative;
+    }else{
+        D3 y = f(D3(D2(D1(x, 1), D1(1, 0)), D2(D1(1, 0), D1(0, 0))));
+        d[0] = y.value.value.value;
+        d[1] = y.value.value.derivative;
+        d[2] = y.value.derivative.derivative;
+        d[3] = y.derivative.derivative.derivative;
+    }
+}
+
+#endif
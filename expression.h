@@ -0,0 +1,399 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+
+/* --- --- 式テンプレートによるベクトル・行列の演算 --- ---
+r = b - A*x; norm(r) のような式を、途中のベクトルを作らずに1回の走査で計算する。
+演算子は値を計算せず「式の木」を型として返し、assignやnormInfなどが要素ごとに木をたどって評価する。
+    double r = expression::normInf(A.rhs() - A * expression::vector(x)); //bとAを1回ずつ読むだけ
+ベクトル(要素ごとに評価できるもの):
+    Vector<T>       : 連続した配列(T*, 要素数)。vector(std::vector<T>)、vector(T*, n)で作る
+    RightHandSide<T>: 拡大係数行列の最後の列(b)
+    Product<M, V>   : 行列とベクトルの積 A*x。i番目の要素を求めるときにAのi行目とxの内積をとる
+    Binary<L, R, Op>: 要素ごとの和、差、積、商(+, -, hadamard, quotient)
+    Scaled<E, S>    : スカラー倍(s * e)
+    Absolute<E>     : 要素ごとの絶対値(abs(e))
+    Diagonal<M>     : 行列の対角成分(diagonal(A))
+行列(i行目の要素を順に渡すforRowを持つもの。行とベクトルの内積rowDotは基底が作る):
+    Augmented<T>    : ソルバーが持つ拡大係数行列 std::vector<std::vector<T> > (n*(n+1))
+    Dense<T>        : 行優先の連続した配列(solverLibraryやsolverDaemonの形式)
+    Sparse<T>       : CSR(matrixFile.hの row_ptr, col_idx, values の形式)
+    OffDiagonal<M>  : 対角成分を除いた行列(offDiagonal(A))。ヤコビ法の (b - (A - D)x) / D に使う
+residualNormsは |b - Ax|∞、|A|∞、|b|∞ を行列とbを1回ずつ読むだけでまとめて求める。
+式の木の節は値で持つ(葉はポインターと大きさだけなので軽い)。葉が指す配列は評価が終わるまで残しておくこと。
+左辺と右辺で同じ配列を読み書きする式(x = A*x など)は、要素を上書きしながら読むので正しくならない。
+--- --- --- --- */
+namespace expression{
+    //全ての式の基底(CRTP)
+    template<class E> struct Expression{
+        const E& self() const{
+            return static_cast<const E&>(*this);
+        }
+    };
+
+    //全ての行列の基底(CRTP)。派生はforRow(i, f)で i行目の (列, 値) を f に順に渡す
+    template<class M> struct Matrix{
+        const M& self() const{
+            return static_cast<const M&>(*this);
+        }
+        template<class V, class D = M> typename std::common_type<typename D::value_type, typename V::value_type>::type rowDot(size_t i, const V& v) const{
+            typename std::common_type<typename D::value_type, typename V::value_type>::type s = 0;
+            self().forRow(i, [&](size_t j, typename D::value_type a){
+                s += a * v[j];
+            });
+            return s;
+        }
+    };
+
+    template<class T> struct Vector : Expression<Vector<T> >{
+        typedef T value_type;
+        const T* data;
+        size_t length;
+        Vector(const T* data, size_t length) : data(data), length(length){}//コンストラクター
+        T operator[](size_t i) const{
+            return data[i];
+        }
+        size_t size() const{
+            return length;
+        }
+    };
+
+    template<class T> inline Vector<T> vector(const std::vector<T>& v){
+        return Vector<T>(v.data(), v.size());
+    }
+
+    template<class T> inline Vector<T> vector(const T* data, size_t length){
+        return Vector<T>(data, length);
+    }
+
+    template<class T> struct RightHandSide : Expression<RightHandSide<T> >{
+        typedef T value_type;
+        const std::vector<std::vector<T> >* rows;
+        size_t n;
+        RightHandSide(const std::vector<std::vector<T> >* rows, size_t n) : rows(rows), n(n){}//コンストラクター
+        T operator[](size_t i) const{
+            return (*rows)[i][n];
+        }
+        size_t size() const{
+            return n;
+        }
+    };
+
+    struct Add{
+        template<class A, class B> static auto apply(A a, B b){
+            return a + b;
+        }
+    };
+    struct Subtract{
+        template<class A, class B> static auto apply(A a, B b){
+            return a - b;
+        }
+    };
+    struct Multiply{
+        template<class A, class B> static auto apply(A a, B b){
+            return a * b;
+        }
+    };
+    struct Divide{
+        template<class A, class B> static auto apply(A a, B b){
+            return a / b;
+        }
+    };
+
+    template<class L, class R, class Op> struct Binary : Expression<Binary<L, R, Op> >{
+        typedef typename std::common_type<typename L::value_type, typename R::value_type>::type value_type;
+        L left;
+        R right;
+        Binary(const L& left, const R& right) : left(left), right(right){}//コンストラクター
+        value_type operator[](size_t i) const{
+            return Op::apply(left[i], right[i]);
+        }
+        size_t size() const{
+            return left.size();
+        }
+    };
+
+    template<class E, class S> struct Scaled : Expression<Scaled<E, S> >{
+        typedef typename std::common_type<typename E::value_type, S>::type value_type;
+        E inner;
+        S scale;
+        Scaled(const E& inner, S scale) : inner(inner), scale(scale){}//コンストラクター
+        value_type operator[](size_t i) const{
+            return scale * inner[i];
+        }
+        size_t size() const{
+            return inner.size();
+        }
+    };
+
+    template<class E> struct Absolute : Expression<Absolute<E> >{
+        typedef typename E::value_type value_type;
+        E inner;
+        Absolute(const E& inner) : inner(inner){}//コンストラクター
+        value_type operator[](size_t i) const{
+            value_type v = inner[i];
+            return v < 0 ? -v : v;
+        }
+        size_t size() const{
+            return inner.size();
+        }
+    };
+
+    //行列の各行と式vの内積(要素はvの[]で1つずつ読むので、vが式なら積の中で評価される)
+    template<class M, class V> struct Product : Expression<Product<M, V> >{
+        typedef typename std::common_type<typename M::value_type, typename V::value_type>::type value_type;
+        M matrix;
+        V vector;
+        Product(const M& matrix, const V& vector) : matrix(matrix), vector(vector){}//コンストラクター
+        value_type operator[](size_t i) const{
+            return matrix.rowDot(i, vector);
+        }
+        size_t size() const{
+            return matrix.rows();
+        }
+    };
+
+    //拡大係数行列(最後の列は右辺なので積には使わない)
+    template<class T> struct Augmented : Matrix<Augmented<T> >{
+        typedef T value_type;
+        const std::vector<std::vector<T> >* coefficients;
+        size_t n;
+        Augmented(const std::vector<std::vector<T> >& coefficients, size_t n) : coefficients(&coefficients), n(n){}//コンストラクター
+        size_t rows() const{
+            return n;
+        }
+        template<class F> void forRow(size_t i, F f) const{
+            const T* row = (*coefficients)[i].data();
+            for(size_t j = 0; j < n; j++){
+                f(j, row[j]);
+            }
+        }
+        T diagonal(size_t i) const{
+            return (*coefficients)[i][i];
+        }
+        RightHandSide<T> rhs() const{
+            return RightHandSide<T>(coefficients, n);
+        }
+    };
+
+    template<class T> inline Augmented<T> augmented(const std::vector<std::vector<T> >& coefficients, size_t n){
+        return Augmented<T>(coefficients, n);
+    }
+
+    //行優先の rows*cols の配列
+    template<class T> struct Dense : Matrix<Dense<T> >{
+        typedef T value_type;
+        const T* values;
+        size_t row_amount, cols;
+        Dense(const T* values, size_t row_amount, size_t cols) : values(values), row_amount(row_amount), cols(cols){}//コンストラクター
+        size_t rows() const{
+            return row_amount;
+        }
+        template<class F> void forRow(size_t i, F f) const{
+            const T* row = values + i * cols;
+            for(size_t j = 0; j < cols; j++){
+                f(j, row[j]);
+            }
+        }
+        T diagonal(size_t i) const{
+            return values[i * cols + i];
+        }
+    };
+
+    template<class T> inline Dense<T> dense(const T* values, size_t rows, size_t cols){
+        return Dense<T>(values, rows, cols);
+    }
+
+    //CSR(row_ptr[i]からrow_ptr[i+1]の手前までがi行目の非零要素)
+    template<class T> struct Sparse : Matrix<Sparse<T> >{
+        typedef T value_type;
+        const T* values;
+        const uint64_t* row_ptr;
+        const uint32_t* col_idx;
+        size_t row_amount;
+        Sparse(const T* values, const uint64_t* row_ptr, const uint32_t* col_idx, size_t row_amount)
+            : values(values), row_ptr(row_ptr), col_idx(col_idx), row_amount(row_amount){}//コンストラクター
+        size_t rows() const{
+            return row_amount;
+        }
+        template<class F> void forRow(size_t i, F f) const{
+            for(uint64_t k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+                f(col_idx[k], values[k]);
+            }
+        }
+        T diagonal(size_t i) const{ //格納されていなければ0
+            for(uint64_t k = row_ptr[i]; k < row_ptr[i + 1]; k++){
+                if(col_idx[k] == i){
+                    return values[k];
+                }
+            }
+            return 0;
+        }
+    };
+
+    template<class T> inline Sparse<T> sparse(const T* values, const uint64_t* row_ptr, const uint32_t* col_idx, size_t rows){
+        return Sparse<T>(values, row_ptr, col_idx, rows);
+    }
+
+    //対角成分を除いた行列(i行目のi列目を飛ばす)
+    template<class M> struct OffDiagonal : Matrix<OffDiagonal<M> >{
+        typedef typename M::value_type value_type;
+        M inner;
+        OffDiagonal(const M& inner) : inner(inner){}//コンストラクター
+        size_t rows() const{
+            return inner.rows();
+        }
+        template<class F> void forRow(size_t i, F f) const{
+            inner.forRow(i, [&](size_t j, value_type a){
+                if(j != i){
+                    f(j, a);
+                }
+            });
+        }
+        value_type diagonal(size_t) const{
+            return 0;
+        }
+    };
+
+    template<class M> inline OffDiagonal<M> offDiagonal(const Matrix<M>& matrix){
+        return OffDiagonal<M>(matrix.self());
+    }
+
+    //行列の対角成分を並べたベクトル
+    template<class M> struct Diagonal : Expression<Diagonal<M> >{
+        typedef typename M::value_type value_type;
+        M matrix;
+        Diagonal(const M& matrix) : matrix(matrix){}//コンストラクター
+        value_type operator[](size_t i) const{
+            return matrix.diagonal(i);
+        }
+        size_t size() const{
+            return matrix.rows();
+        }
+    };
+
+    template<class M> inline Diagonal<M> diagonal(const Matrix<M>& matrix){
+        return Diagonal<M>(matrix.self());
+    }
+
+    template<class L, class R> inline Binary<L, R, Add> operator+(const Expression<L>& left, const Expression<R>& right){
+        return Binary<L, R, Add>(left.self(), right.self());
+    }
+
+    template<class L, class R> inline Binary<L, R, Subtract> operator-(const Expression<L>& left, const Expression<R>& right){
+        return Binary<L, R, Subtract>(left.self(), right.self());
+    }
+
+    template<class L, class R> inline Binary<L, R, Multiply> hadamard(const Expression<L>& left, const Expression<R>& right){
+        return Binary<L, R, Multiply>(left.self(), right.self());
+    }
+
+    template<class L, class R> inline Binary<L, R, Divide> quotient(const Expression<L>& left, const Expression<R>& right){
+        return Binary<L, R, Divide>(left.self(), right.self());
+    }
+
+    template<class E, class S, class = typename std::enable_if<std::is_arithmetic<S>::value>::type>
+    inline Scaled<E, S> operator*(S scale, const Expression<E>& e){
+        return Scaled<E, S>(e.self(), scale);
+    }
+
+    template<class M, class V> inline Product<M, V> operator*(const Matrix<M>& matrix, const Expression<V>& v){
+        return Product<M, V>(matrix.self(), v.self());
+    }
+
+    template<class E> inline Absolute<E> abs(const Expression<E>& e){
+        return Absolute<E>(e.self());
+    }
+
+    //式を1回の走査で評価してdestinationに書く
+    template<class T, class E> inline void assign(T* destination, const Expression<E>& e){
+        const E& x = e.self();
+        size_t n = x.size();
+        for(size_t i = 0; i < n; i++){
+            destination[i] = x[i];
+        }
+    }
+
+    template<class T, class E> inline void assign(std::vector<T>& destination, const Expression<E>& e){
+        destination.resize(e.self().size());
+        assign(destination.data(), e);
+    }
+
+    template<class E> inline typename E::value_type sum(const Expression<E>& e){
+        const E& x = e.self();
+        typename E::value_type s = 0;
+        for(size_t i = 0; i < x.size(); i++){
+            s += x[i];
+        }
+        return s;
+    }
+
+    // ∑|e_i|
+    template<class E> inline typename E::value_type norm1(const Expression<E>& e){
+        return sum(abs(e));
+    }
+
+    // √∑e_i^2
+    template<class E> inline typename E::value_type norm2(const Expression<E>& e){
+        const E& x = e.self();
+        typename E::value_type s = 0;
+        for(size_t i = 0; i < x.size(); i++){
+            typename E::value_type v = x[i];
+            s += v * v;
+        }
+        return sqrt(s);
+    }
+
+    // max|e_i|
+    template<class E> inline typename E::value_type normInf(const Expression<E>& e){
+        const E& x = e.self();
+        typename E::value_type m = 0;
+        for(size_t i = 0; i < x.size(); i++){
+            typename E::value_type v = x[i];
+            m = std::max(m, v < 0 ? -v : v);
+        }
+        return m;
+    }
+
+    // ∑a_i b_i
+    template<class L, class R> inline auto dot(const Expression<L>& left, const Expression<R>& right){
+        return sum(hadamard(left, right));
+    }
+
+    template<class T> struct ResidualNorms{
+        T residual = 0; // |b - Ax|∞
+        T matrix = 0;   // |A|∞ (行の絶対値の和の最大)
+        T rhs = 0;      // |b|∞
+    };
+
+    // |b - Ax|∞、|A|∞、|b|∞ を1回の走査で求める(Aの各行は内積と絶対値の和に同時に使う)
+    template<class M, class B, class X>
+    inline ResidualNorms<typename std::common_type<typename M::value_type, typename B::value_type, typename X::value_type>::type>
+    residualNorms(const Matrix<M>& a, const Expression<B>& b, const Expression<X>& x){
+        typedef typename std::common_type<typename M::value_type, typename B::value_type, typename X::value_type>::type T;
+        const M& matrix = a.self();
+        const B& rhs = b.self();
+        const X& v = x.self();
+        ResidualNorms<T> norms;
+        for(size_t i = 0; i < matrix.rows(); i++){
+            T s = rhs[i], row = 0;
+            matrix.forRow(i, [&](size_t j, typename M::value_type c){
+                s -= c * v[j];
+                row += c < 0 ? -c : c;
+            });
+            norms.residual = std::max(norms.residual, s < 0 ? -s : s);
+            norms.matrix = std::max(norms.matrix, row);
+            T bi = rhs[i];
+            norms.rhs = std::max(norms.rhs, bi < 0 ? -bi : bi);
+        }
+        return norms;
+    }
+}
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef GAUSS_JORDAN_H
+#define GAUSS_JORDAN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <utility>
+#include <algorithm>
+#include "solverCache.h"
+#include "trace.h"
+#include "workspace.h"
+
+namespace gaussJordan{
+    inline long double EPSILON = 0.0001; //許容誤差範囲
+}
+
+class GaussJordan{
+private:
+    //連立方程式(SimultaneousEquations)の要素
+    int variable_amount; //変数数=方程式数
+    std::vector<std::vector<long double> > coefficient_matrix; //係数行列(方程式数)*(変数数+1)
+    SolverCache* cache; //消去手順のキャッシュ(使わない場合はNULL)
+    SolverCache::Key cache_key;
+    bool verbose; //消去の途中経過を表示する(SOLVER_TRACEを定義したビルドだけ)
+    void replayInPlace(const CachedSetup& setup, long double* b_vec, long double* answer);
+public:
+    GaussJordan(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix);//コンストラクター
+    std::vector<std::vector<long double> > copyCoefficientMatrix();
+    void setCache(SolverCache* cache);
+    void setCache(SolverCache* cache, uint64_t matrix_id);
+    void setRightHandSide(const std::vector<long double>& b_vec);
+    void setVerbose(bool verbose);
+    std::vector<long double> runGaussJordan(); 
+    bool runGaussJordan(Workspace& workspace, long double* result);
+    static size_t workspaceSize(int variable_amount);
+    std::vector<long double> replayElimination(const CachedSetup& setup);
+    void showSimultaneousEquations();
+    void showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix);
+    void printAnswer(std::vector<long double> answer);
+};
+
+//コンストラクター
+inline GaussJordan::GaussJordan(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix){
+    this->variable_amount = variable_amount;
+    this->coefficient_matrix = coefficient_matrix;
+    this->cache = NULL;
+    this->verbose = true;
+}
+
+inline std::vector<std::vector<long double> > GaussJordan::copyCoefficientMatrix(){
+    std::vector<std::vector<long double> > new_coefficient_matrix;
+    for(std::vector<long double> equation : this->coefficient_matrix){
+        std::vector<long double> new_equation;
+        for(long double coefficient : equation){
+            new_equation.push_back(coefficient);
+        }
+        new_coefficient_matrix.push_back(new_equation);
+    }
+    return new_coefficient_matrix;
+}
+
+//消去手順をcacheに保存し、同じ係数行列なら右辺にだけ同じ手順を適用する
+inline void GaussJordan::setCache(SolverCache* cache){
+    this->cache = cache;
+    this->cache_key = SolverCache::keyFor(coefficient_matrix, variable_amount);
+}
+
+//呼び出し側が係数行列に固有のIDを与える場合はハッシュを計算しない
+inline void GaussJordan::setCache(SolverCache* cache, uint64_t matrix_id){
+    this->cache = cache;
+    this->cache_key = SolverCache::keyFor(matrix_id, variable_amount);
+}
+
+//係数行列はそのままで右辺だけを差し替える
+inline void GaussJordan::setRightHandSide(const std::vector<long double>& b_vec){
+    for(int i = 0; i < variable_amount; i++){
+        coefficient_matrix.at(i).at(variable_amount) = b_vec.at(i);
+    }
+}
+
+inline void GaussJordan::setVerbose(bool verbose){
+    this->verbose = verbose;
+}
+
+inline std::vector<long double> GaussJordan::runGaussJordan(){
+    Workspace workspace(GaussJordan::workspaceSize(variable_amount));
+    std::vector<long double> answer(variable_amount);
+    if(!GaussJordan::runGaussJordan(workspace, answer.data())){
+        return std::vector<long double>();
+    }
+    return answer;
+}
+
+//作業領域(拡大係数行列と各行の先頭を指す配列)のバイト数
+inline size_t GaussJordan::workspaceSize(int variable_amount){
+    return Workspace::bytesFor<long double>((size_t)variable_amount * (variable_amount + 1)) + Workspace::bytesFor<long double*>(variable_amount);
+}
+
+//workspaceで消去してresultに書く(キャッシュへ初めて保存するとき以外はヒープ確保をしない)
+//解が一意に定まらないときと作業領域が足りないときはfalse
+inline bool GaussJordan::runGaussJordan(Workspace& workspace, long double* result){
+    TRACE_SOLVE("gaussJordan");
+    WorkspaceScope scope(workspace);
+    //同じ係数行列の消去手順がキャッシュにあれば右辺だけを計算する
+    std::shared_ptr<CachedSetup> setup = cache != NULL ? cache->find(cache_key) : nullptr;
+    if(setup != nullptr && !setup->reduced_matrix.empty()){
+        long double* b_vec = workspace.allocate<long double>(variable_amount);
+        if(b_vec == NULL){
+            return false;
+        }
+        replayInPlace(*setup, b_vec, result);
+        return true;
+    }
+    std::vector<int> pivot_rows; //キャッシュに保存するときだけ記録する
+    std::vector<std::vector<long double> > pivot_scales;
+    if(cache != NULL){
+        pivot_rows.resize(variable_amount);
+        pivot_scales.resize(variable_amount);
+    }
+
+    //行の入れ替えは行の先頭を指すポインターの入れ替えで行う
+    size_t width = variable_amount + 1; //一つの方程式の項数
+    long double* storage = workspace.allocate<long double>((size_t)variable_amount * width);
+    long double** new_coefficient_matrix = workspace.allocate<long double*>(variable_amount);
+    if(storage == NULL || new_coefficient_matrix == NULL){
+        return false;
+    }
+    for(int i = 0; i < variable_amount; i++){
+        new_coefficient_matrix[i] = storage + i * width;
+        std::copy(coefficient_matrix[i].begin(), coefficient_matrix[i].begin() + width, new_coefficient_matrix[i]);
+    }
+    //係数行列の対角要素を1にする
+    for(int i = 0; i < variable_amount; i++){
+        TRACE_SCOPE("gaussJordan.pivot");
+        TRACE_FLOPS(2LL * (variable_amount - i) * (variable_amount - i + 1));
+        int pivot = i; 
+        int p = i; //pivot番目の項が存在する方程式の行
+        for(p = i; p < variable_amount; p++){
+            if(new_coefficient_matrix[p][pivot] != 0){
+                break;
+            }
+        }
+        if(p >= variable_amount){//解が一意に決まらない場合
+                std::cerr << "解が一意に定まりません" << std::endl;
+                return false;
+        }
+        // std::cerr << "(pivot, p) = (" << pivot << ", " << p << ")" << std::endl;
+        std::swap(new_coefficient_matrix[pivot], new_coefficient_matrix[p]);
+        if(cache != NULL){
+            pivot_rows.at(pivot) = p;
+        }
+
+        //pivot番目の項の係数を1にする．
+        for(int j = pivot; j < variable_amount; j++){
+            long double pivot_coefficient = new_coefficient_matrix[j][pivot];
+            if(cache != NULL){
+                pivot_scales.at(pivot).push_back(pivot_coefficient);
+            }
+            //pivot番目の項の係数が既に0で存在しない場合はその方程式を飛ばす
+            if(pivot_coefficient == 0){
+                continue;
+            }
+
+            for(int k = pivot; k < variable_amount + 1/*一つの方程式の項数*/; k++){
+                new_coefficient_matrix[j][k] /= pivot_coefficient;
+            }
+        }
+
+        //pivot行の方程式残して他のpivot番目の係数を0にするように
+        //pivot行の方程式と差をとる．
+        for(int j = pivot+1/**/; j < variable_amount; j++){
+            long double c = new_coefficient_matrix[j][pivot];
+            for(int k = pivot; k < variable_amount + 1/*一つの方程式の項数*/; k++){
+                if(c != 0){
+                    new_coefficient_matrix[j][k] -= new_coefficient_matrix[pivot][k];
+                }
+            }
+        }
+        TRACE_DEBUG(
+            if(verbose){
+                std::vector<std::vector<long double> > shown;
+                for(int r = 0; r < variable_amount; r++){
+                    shown.push_back(std::vector<long double>(new_coefficient_matrix[r], new_coefficient_matrix[r] + width));
+                }
+                showSimultaneousEquations(shown);
+            }
+        );
+    }
+    if(cache != NULL){
+        //他のソルバーの前処理結果と同じ項目に追記する
+        setup = setup != nullptr ? std::make_shared<CachedSetup>(*setup) : std::make_shared<CachedSetup>();
+        setup->pivot_rows = pivot_rows;
+        setup->pivot_scales = pivot_scales;
+        setup->reduced_matrix.clear();
+        for(int r = 0; r < variable_amount; r++){
+            setup->reduced_matrix.push_back(std::vector<long double>(new_coefficient_matrix[r], new_coefficient_matrix[r] + width));
+        }
+        cache->store(cache_key, setup);
+    }
+    //解のベクトルを出力
+    for(int e = variable_amount-1; e >= 0; e--){
+        long double ans = new_coefficient_matrix[e][variable_amount];
+        for(int c = e+1; c < variable_amount; c++){
+            ans -= new_coefficient_matrix[e][c]*result[c];
+        }
+        result[e] = ans;
+    }
+    return true;
+}
+
+//記録した消去手順(行の入れ替え、各行の割り算、pivot行との差)を右辺にだけ適用して解く
+inline std::vector<long double> GaussJordan::replayElimination(const CachedSetup& setup){
+    std::vector<long double> b_vec(variable_amount);
+    std::vector<long double> answer(variable_amount);
+    replayInPlace(setup, b_vec.data(), answer.data());
+    return answer;
+}
+
+//b_vecは作業用(variable_amount個)
+inline void GaussJordan::replayInPlace(const CachedSetup& setup, long double* b_vec, long double* answer){
+    TRACE_SCOPE("gaussJordan.replay");
+    TRACE_FLOPS(2LL * variable_amount * variable_amount);
+    for(int i = 0; i < variable_amount; i++){
+        b_vec[i] = coefficient_matrix.at(i).at(variable_amount);
+    }
+    for(int pivot = 0; pivot < variable_amount; pivot++){
+        std::swap(b_vec[pivot], b_vec[setup.pivot_rows.at(pivot)]);
+        const std::vector<long double>& scales = setup.pivot_scales.at(pivot);
+        for(int j = pivot; j < variable_amount; j++){
+            long double pivot_coefficient = scales.at(j - pivot);
+            if(pivot_coefficient != 0){
+                b_vec[j] /= pivot_coefficient;
+            }
+        }
+        //割った後のpivot番目の係数は1(割らなかった行は0)なので差をとるのは割った行だけ
+        for(int j = pivot+1; j < variable_amount; j++){
+            if(scales.at(j - pivot) != 0){
+                b_vec[j] -= b_vec[pivot];
+            }
+        }
+    }
+    for(int e = variable_amount-1; e >= 0; e--){
+        long double ans = b_vec[e];
+        for(int c = e+1; c < variable_amount; c++){
+            ans -= setup.reduced_matrix.at(e).at(c)*answer[c];
+        }
+        answer[e] = ans;
+    }
+}
+
+inline void GaussJordan::showSimultaneousEquations(){
+    printf("連立方程式:\n");
+    for(std::vector<long double> equation : this->coefficient_matrix){
+        for(int v = 0; v <= variable_amount; v++){
+            long double c = equation.at(v);
+            if(v == variable_amount){
+                printf("\t = ");
+            }else if(c >= 0){
+                printf("\t + ");
+            }else if(c < 0){
+                printf("\t - ");
+            }
+            
+            if(v == variable_amount){
+                printf("%.6Lf", c);
+            }else{
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+inline void GaussJordan::showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix){
+    printf("連立方程式:\n");
+    for(std::vector<long double> equation : coefficient_matrix){
+        for(int v = 0; v <= variable_amount; v++){
+            long double c = equation.at(v);
+            if(v == variable_amount){
+                printf("\t = ");
+            }else if(c >= 0){
+                printf("\t + ");
+            }else if(c < 0){
+                printf("\t - ");
+            }
+            
+            if(v == variable_amount){
+                printf("%.6Lf", c);
+            }else{
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+
+inline void GaussJordan::printAnswer(std::vector<long double> answer){
+    printf("解:\n");
+    for(int i = 0; i < variable_amount; i++){
+        printf("\tx_%02d = %.6Lf\n", i, answer.at(i));
+    }
+}
+
+#endif
@@ -4,146 +4,12 @@
 #include <vector>
 #include <iostream>
 #include <utility>
+#include <string>
+#include <memory>
+#include "matrixFile.h"
+#include "gaussSeidel.h"
 
-namespace gaussSeidel{
-    long double EPSILON = 0.0001; //許容誤差範囲
-    int MAX_LOOP = 30; //最大繰り返し回数
-}
-
-class GaussSeidel{
-private:
-    //連立方程式(SimultaneousEquations)の要素
-    int variable_amount; //変数数=方程式数
-    std::vector<std::vector<long double> > coefficient_matrix; //係数行列(方程式数)*(変数数+1)
-public:
-    GaussSeidel(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix);//コンストラクター
-    std::vector<std::vector<long double> > copyCoefficientMatrix();
-    std::vector<long double> runGaussSeidel();
-    long double runAjustEquation(std::vector<long double> equation, std::vector<long double> equation_parameter, int variable_number);
-    void showSimultaneousEquations();
-    void showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix);
-    void printAnswer(std::vector<long double> answer);
-};
-
-//コンストラクター
-GaussSeidel::GaussSeidel(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix){
-    this->variable_amount = variable_amount;
-    this->coefficient_matrix = coefficient_matrix;
-}
-
-std::vector<std::vector<long double> > GaussSeidel::copyCoefficientMatrix(){
-    std::vector<std::vector<long double> > new_coefficient_matrix;
-    for(std::vector<long double> equation : this->coefficient_matrix){
-        std::vector<long double> new_equation;
-        for(long double coefficient : equation){
-            new_equation.push_back(coefficient);
-        }
-        new_coefficient_matrix.push_back(new_equation);
-    }
-    return new_coefficient_matrix;
-}
-
-std::vector<long double> GaussSeidel::runGaussSeidel(){
-    std::vector<std::vector<long double> > new_coefficient_matrix = GaussSeidel::copyCoefficientMatrix();
-    std::vector<long double>               answer                 = {1, 1, 1}; //解の初期値 
-
-    // 修正式を用いて解の計算
-    for(int loop = 0; loop < gaussSeidel::MAX_LOOP; loop++){
-        std::vector<long double> next_answer(answer);
-        for(int i = 0; i < variable_amount; i++){
-            std::vector<long double> equation = new_coefficient_matrix.at(i);
-
-            next_answer.at(i) = runAjustEquation(equation, next_answer, i);//修正式
-        }
-        std::cout << loop+1 << "回目" << std::endl;
-        GaussSeidel::printAnswer(next_answer);
-
-        // 絶対値誤差の総和
-        long double difference = 0;
-        for(int i = 0; i < variable_amount; i++){
-            difference += fabsl(next_answer.at(i) - answer.at(i));
-        }
-        
-        // 許容誤差範囲なら終了
-        if(difference < gaussSeidel::EPSILON){
-            return next_answer;
-        }
-
-        answer = next_answer;
-    }
-    printf("最大繰り返し回数を超過しました\n");
-    //解の出力
-    return answer;
-}
-
-//修正式の計算
-long double GaussSeidel::runAjustEquation(std::vector<long double> equation, std::vector<long double> equation_parameter, int variable_number){
-    long double answer = equation.at(variable_amount);
-    for(int i = 0; i < variable_amount; i++){
-        if(i == variable_number){
-            continue;
-        }
-        answer -= equation.at(i)*equation_parameter.at(i);
-    }
-    answer /= equation.at(variable_number);
-    return answer;
-}
-
-void GaussSeidel::showSimultaneousEquations(){
-    printf("連立方程式:\n");
-    for(std::vector<long double> equation : this->coefficient_matrix){
-        for(int v = 0; v <= variable_amount; v++){
-            long double c = equation.at(v);
-            if(v == variable_amount){
-                printf("\t = ");
-            }else if(c >= 0){
-                printf("\t + ");
-            }else if(c < 0){
-                printf("\t - ");
-            }
-            
-            if(v == variable_amount){
-                printf("%.6Lf", c);
-            }else{
-                printf("%.6Lfx_%02d", fabsl(c), v);
-            }
-        }
-        printf("\n");
-    }
-}
-void GaussSeidel::showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix){
-    printf("連立方程式:\n");
-    for(std::vector<long double> equation : coefficient_matrix){
-        for(int v = 0; v <= variable_amount; v++){
-            long double c = equation.at(v);
-            if(v == variable_amount){
-                printf("\t = ");
-            }else if(c >= 0){
-                printf("\t + ");
-            }else if(c < 0){
-                printf("\t - ");
-            }
-            
-            if(v == variable_amount){
-                printf("%.6Lf", c);
-            }else{
-                printf("%.6Lfx_%02d", fabsl(c), v);
-            }
-        }
-        printf("\n");
-    }
-}
-
-void GaussSeidel::printAnswer(std::vector<long double> answer){
-    printf("解: ");
-    for(int i = 0; i < variable_amount; i++){
-        printf("\tx_%02d = %.6Lf", i, answer.at(i));
-    }
-    printf("\n");
-}
-
-
-int main(void){
+int main(int argc, char* argv[]){
     //連立方程式の定義
     int variable_amount = 3;
     std::vector<std::vector<long double> > coefficient_matrix = {//連立方程式の拡大係数行列
@@ -151,12 +17,45 @@ int main(void){
         { 1,  4,  1,  12},
         { 2,  2,  5,  21}
     };
+    //オプション: --checkpoint ファイル(途中の状態を保存する), --resume(そのファイルから再開する), --interval 回数, --max-loop 回数
+    std::string matrix_path, checkpoint_path;
+    bool resume = false;
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--checkpoint" && i + 1 < argc){
+            checkpoint_path = argv[++i];
+        }else if(arg == "--resume"){
+            resume = true;
+        }else if(arg == "--interval" && i + 1 < argc){
+            checkpoint::INTERVAL = atoi(argv[++i]);
+        }else if(arg == "--max-loop" && i + 1 < argc){
+            gaussSeidel::MAX_LOOP = atoi(argv[++i]);
+        }else{
+            matrix_path = arg;
+        }
+    }
+    //ファイルが指定されればそこから読み込む(Matrix Market/CSV/バイナリ形式)
+    if(!matrix_path.empty() && !loadAugmentedMatrix(matrix_path, variable_amount, coefficient_matrix)){
+        return 1;
+    }
 
     //関数作成
     GaussSeidel simultaneous_equations(variable_amount, coefficient_matrix);
     simultaneous_equations.showSimultaneousEquations();
+    std::unique_ptr<Checkpointer> checkpointer;
+    if(!checkpoint_path.empty()){
+        checkpointer.reset(new Checkpointer(checkpoint_path));
+        simultaneous_equations.setCheckpoint(checkpointer.get());
+        if(resume && !simultaneous_equations.resume(checkpoint_path)){
+            return 1;
+        }
+    }
     //ガウスザイデル法の実行
     std::vector<long double> answer = simultaneous_equations.runGaussSeidel();
     simultaneous_equations.printAnswer(answer);
+    if(checkpointer != nullptr){
+        checkpointer->flush();
+        printf("繰り返し %d 回, チェックポイント %zu 回書き出し: %s\n", simultaneous_equations.getLoopCount(), checkpointer->getWritten(), checkpoint_path.c_str());
+    }
     return 0;
 }
\ No newline at end of file
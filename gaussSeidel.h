@@ -0,0 +1,232 @@
+#ifndef GAUSS_SEIDEL_H
+#define GAUSS_SEIDEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <utility>
+#include <algorithm>
+#include "trace.h"
+#include "workspace.h"
+#include "checkpoint.h"
+
+namespace gaussSeidel{
+    inline long double EPSILON = 0.0001; //許容誤差範囲
+    inline int MAX_LOOP = 30; //最大繰り返し回数
+}
+
+class GaussSeidel{
+private:
+    //連立方程式(SimultaneousEquations)の要素
+    int variable_amount; //変数数=方程式数
+    std::vector<std::vector<long double> > coefficient_matrix; //係数行列(方程式数)*(変数数+1)
+    bool converged; //直前の実行が許容誤差内に収まったか
+    int loop_count; //直前の実行の繰り返し回数
+    Checkpointer* checkpointer; //チェックポイントの書き出し(使わない場合はNULL)
+    CheckpointState restart; //resumeで読み込んだ状態
+    bool resuming; //次の実行をrestartから始めるか
+    long double adjust(const long double* equation, const long double* equation_parameter, int variable_number);
+public:
+    GaussSeidel(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix);//コンストラクター
+    std::vector<std::vector<long double> > copyCoefficientMatrix();
+    void setCheckpoint(Checkpointer* checkpointer);
+    bool resume(std::string path);
+    std::vector<long double> runGaussSeidel();
+    bool runGaussSeidel(Workspace& workspace, long double* result);
+    static size_t workspaceSize(int variable_amount);
+    bool isConverged();
+    int getLoopCount();
+    long double runAjustEquation(std::vector<long double> equation, std::vector<long double> equation_parameter, int variable_number);
+    void showSimultaneousEquations();
+    void showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix);
+    void printAnswer(std::vector<long double> answer);
+};
+
+//コンストラクター
+inline GaussSeidel::GaussSeidel(int variable_amount, std::vector<std::vector<long double> > coefficient_matrix){
+    this->variable_amount = variable_amount;
+    this->coefficient_matrix = coefficient_matrix;
+    this->checkpointer = NULL;
+    this->resuming = false;
+    this->converged = false;
+    this->loop_count = 0;
+}
+
+inline std::vector<std::vector<long double> > GaussSeidel::copyCoefficientMatrix(){
+    std::vector<std::vector<long double> > new_coefficient_matrix;
+    for(std::vector<long double> equation : this->coefficient_matrix){
+        std::vector<long double> new_equation;
+        for(long double coefficient : equation){
+            new_equation.push_back(coefficient);
+        }
+        new_coefficient_matrix.push_back(new_equation);
+    }
+    return new_coefficient_matrix;
+}
+
+//runGaussSeidel()の途中の状態をcheckpointerに渡す(checkpoint::INTERVAL回ごとと最後)
+inline void GaussSeidel::setCheckpoint(Checkpointer* checkpointer){
+    this->checkpointer = checkpointer;
+}
+
+//チェックポイントを読み込み、次のrunGaussSeidel()をその解と繰り返し回数から続ける
+inline bool GaussSeidel::resume(std::string path){
+    if(!restart.load(path, checkpoint::GAUSS_SEIDEL, coefficient_matrix, variable_amount)){
+        return false;
+    }
+    resuming = true;
+    return true;
+}
+
+//作業領域(解の1本分)のバイト数
+inline size_t GaussSeidel::workspaceSize(int variable_amount){
+    return Workspace::bytesFor<long double>(variable_amount);
+}
+
+inline std::vector<long double> GaussSeidel::runGaussSeidel(){
+    Workspace workspace(GaussSeidel::workspaceSize(variable_amount));
+    std::vector<long double> answer(variable_amount);
+    GaussSeidel::runGaussSeidel(workspace, answer.data());
+    return answer;
+}
+
+//workspaceから解の配列を切り出して解き、resultに書く(ヒープ確保をしない)。作業領域が足りなければfalse
+inline bool GaussSeidel::runGaussSeidel(Workspace& workspace, long double* result){
+    TRACE_SOLVE("gaussSeidel");
+    WorkspaceScope scope(workspace);
+    converged = false;
+    long double* answer = workspace.allocate<long double>(variable_amount);
+    if(answer == NULL){
+        return false;
+    }
+    int first = 0;
+    if(resuming){
+        std::copy(restart.answer.begin(), restart.answer.end(), answer);
+        first = restart.loop;
+        resuming = false;
+    }else{
+        std::fill(answer, answer + variable_amount, 1); //解の初期値
+    }
+    uint64_t fingerprint = 0;
+    if(checkpointer != NULL){
+        checkpointer->setHistory(first > 0 ? restart.history : std::vector<long double>());
+        fingerprint = checkpoint::fingerprint(coefficient_matrix, variable_amount);
+    }
+
+    // 修正式を用いて解の計算
+    for(int loop = first; loop < gaussSeidel::MAX_LOOP; loop++){
+        TRACE_SCOPE("gaussSeidel.sweep");
+        TRACE_COUNT("gaussSeidel.iterations", 1);
+        TRACE_FLOPS(2LL * variable_amount * variable_amount);
+        loop_count = loop+1;
+        //解をその場で更新し、絶対値誤差の総和も同じ走査で足す(更新済みのi番目より前と、まだのi番目以降を読むので1本で足りる)
+        long double difference = 0;
+        for(int i = 0; i < variable_amount; i++){
+            long double n_ans = adjust(coefficient_matrix[i].data(), answer, i);//修正式
+            difference += fabsl(n_ans - answer[i]);
+            answer[i] = n_ans;
+        }
+        TRACE_DEBUG(std::cout << loop+1 << "回目" << std::endl; GaussSeidel::printAnswer(std::vector<long double>(answer, answer + variable_amount)));
+
+        if(checkpointer != NULL){
+            checkpointer->record(difference);
+            if(checkpointer->due(loop+1) || difference < gaussSeidel::EPSILON || loop+1 == gaussSeidel::MAX_LOOP){
+                checkpointer->submit(checkpoint::GAUSS_SEIDEL, variable_amount, loop+1, 1, fingerprint, answer);
+            }
+        }
+
+        // 許容誤差範囲なら終了
+        if(difference < gaussSeidel::EPSILON){
+            converged = true;
+            std::copy(answer, answer + variable_amount, result);
+            return true;
+        }
+    }
+    printf("最大繰り返し回数を超過しました\n");
+    //解の出力
+    std::copy(answer, answer + variable_amount, result);
+    return true;
+}
+
+inline bool GaussSeidel::isConverged(){
+    return converged;
+}
+
+inline int GaussSeidel::getLoopCount(){
+    return loop_count;
+}
+
+//修正式の計算
+inline long double GaussSeidel::runAjustEquation(std::vector<long double> equation, std::vector<long double> equation_parameter, int variable_number){
+    return adjust(equation.data(), equation_parameter.data(), variable_number);
+}
+
+//修正式の計算(行をコピーせずに読む)
+inline long double GaussSeidel::adjust(const long double* equation, const long double* equation_parameter, int variable_number){
+    long double answer = equation[variable_amount];
+    for(int i = 0; i < variable_amount; i++){
+        if(i == variable_number){
+            continue;
+        }
+        answer -= equation[i]*equation_parameter[i];
+    }
+    answer /= equation[variable_number];
+    return answer;
+}
+
+inline void GaussSeidel::showSimultaneousEquations(){
+    printf("連立方程式:\n");
+    for(std::vector<long double> equation : this->coefficient_matrix){
+        for(int v = 0; v <= variable_amount; v++){
+            long double c = equation.at(v);
+            if(v == variable_amount){
+                printf("\t = ");
+            }else if(c >= 0){
+                printf("\t + ");
+            }else if(c < 0){
+                printf("\t - ");
+            }
+            
+            if(v == variable_amount){
+                printf("%.6Lf", c);
+            }else{
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+inline void GaussSeidel::showSimultaneousEquations(std::vector<std::vector<long double> > coefficient_matrix){
+    printf("連立方程式:\n");
+    for(std::vector<long double> equation : coefficient_matrix){
+        for(int v = 0; v <= variable_amount; v++){
+            long double c = equation.at(v);
+            if(v == variable_amount){
+                printf("\t = ");
+            }else if(c >= 0){
+                printf("\t + ");
+            }else if(c < 0){
+                printf("\t - ");
+            }
+            
+            if(v == variable_amount){
+                printf("%.6Lf", c);
+            }else{
+                printf("%.6Lfx_%02d", fabsl(c), v);
+            }
+        }
+        printf("\n");
+    }
+}
+
+inline void GaussSeidel::printAnswer(std::vector<long double> answer){
+    printf("解: ");
+    for(int i = 0; i < variable_amount; i++){
+        printf("\tx_%02d = %.6Lf", i, answer.at(i));
+    }
+    printf("\n");
+}
+
+#endif
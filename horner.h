@@ -0,0 +1,244 @@
+#ifndef HORNER_H
+#define HORNER_H
+
+#include <math.h>
+#include <cmath>
+#include <stddef.h>
+#include <vector>
+#include <type_traits>
+
+/* --- --- 多項式の評価(ホーナー法) --- ---
+係数は昇べきの順 c_0 + c_1*x + ... + c_n*x^n で与える。
+p(x), p'(x), p''(x) を1回のホーナー法でまとめて求める。
+   p''の途中値 dd = dd*x + d
+   p'の途中値  d  = d*x + p
+   pの途中値   p  = p*x + c_k
+(ddは p''/2 になるので最後に2倍する)
+・evaluate      : 1点での値
+・taylor        : 1点での p^(k)(x)/k! (k = 0, ..., order)。同じ漸化式を order 段に広げたもの
+・evaluateLanes : LANES個の点をまとめて計算する。最も内側のループが点(レーン)なので、コンパイラがSIMD命令にできる
+・evaluateMany  : 任意個数の点。次数がFIXED_DEGREE_MAX以下なら次数を定数にした版を使い、係数のループを展開する
+・evaluateComplex : 実係数の多項式の複素数点での p(z), p'(z)(std::complexを使わず実部と虚部で計算する)
+・relativeResidual : |p(z)| / ∑|c_k|max(1,|z|)^k。求めた解を受け入れるかの判定に使う(係数の大きさによらない)
+積和はFMA命令が使える環境(__FP_FAST_FMA)ではstd::fmaで1回の丸めにまとめる。
+--- --- --- --- */
+namespace horner{
+    const int LANES = 8; //まとめて計算する点の数
+    const int FIXED_DEGREE_MAX = 8; //この次数以下は次数を定数にした版を使う
+
+    //a*b + c
+    template<class T> inline T fmadd(T a, T b, T c){
+#ifdef __FP_FAST_FMA
+        if constexpr(std::is_same<T, double>::value){
+            return std::fma(a, b, c);
+        }
+#endif
+        return a * b + c;
+    }
+
+    //1点での p(x), p'(x), p''(x)。dp, ddpがNULLなら求めない
+    template<class T, class C> inline T evaluate(const C* c, int degree, T x, T* dp = NULL, T* ddp = NULL){
+        T p = c[degree];
+        T d = 0;
+        T dd = 0;
+        if(ddp != NULL){
+            for(int k = degree-1; k >= 0; k--){
+                dd = fmadd(dd, x, d);
+                d = fmadd(d, x, p);
+                p = fmadd(p, x, (T)c[k]);
+            }
+            *ddp = dd + dd;
+        }else if(dp != NULL){
+            for(int k = degree-1; k >= 0; k--){
+                d = fmadd(d, x, p);
+                p = fmadd(p, x, (T)c[k]);
+            }
+        }else{
+            for(int k = degree-1; k >= 0; k--){
+                p = fmadd(p, x, (T)c[k]);
+            }
+        }
+        if(dp != NULL){
+            *dp = d;
+        }
+        return p;
+    }
+
+    template<class T, class C> inline T evaluate(const std::vector<C>& c, T x, T* dp = NULL, T* ddp = NULL){
+        return evaluate<T, C>(c.data(), (int)c.size() - 1, x, dp, ddp);
+    }
+
+    //1点でのテイラー係数 t[k] = p^(k)(x)/k! (k = 0, ..., order)
+    template<class T, class C> inline void taylor(const C* c, int degree, T x, T* t, int order){
+        t[0] = c[degree];
+        for(int j = 1; j <= order; j++){
+            t[j] = 0;
+        }
+        for(int k = degree-1; k >= 0; k--){
+            for(int j = order; j >= 1; j--){
+                t[j] = fmadd(t[j], x, t[j - 1]);
+            }
+            t[0] = fmadd(t[0], x, (T)c[k]);
+        }
+    }
+
+    //LANES個の点 x[0..LANES) をまとめて計算する。dp, ddpがNULLなら求めない
+    inline void evaluateLanes(const double* c, int degree, const double* x, double* p, double* dp, double* ddp){
+        double lp[LANES], ld[LANES], ldd[LANES];
+        for(int l = 0; l < LANES; l++){
+            lp[l] = c[degree];
+            ld[l] = 0;
+            ldd[l] = 0;
+        }
+        if(ddp != NULL){
+            for(int k = degree-1; k >= 0; k--){
+                for(int l = 0; l < LANES; l++){
+                    ldd[l] = fmadd(ldd[l], x[l], ld[l]);
+                    ld[l] = fmadd(ld[l], x[l], lp[l]);
+                    lp[l] = fmadd(lp[l], x[l], c[k]);
+                }
+            }
+        }else if(dp != NULL){
+            for(int k = degree-1; k >= 0; k--){
+                for(int l = 0; l < LANES; l++){
+                    ld[l] = fmadd(ld[l], x[l], lp[l]);
+                    lp[l] = fmadd(lp[l], x[l], c[k]);
+                }
+            }
+        }else{
+            for(int k = degree-1; k >= 0; k--){
+                for(int l = 0; l < LANES; l++){
+                    lp[l] = fmadd(lp[l], x[l], c[k]);
+                }
+            }
+        }
+        for(int l = 0; l < LANES; l++){
+            p[l] = lp[l];
+        }
+        if(dp != NULL){
+            for(int l = 0; l < LANES; l++){
+                dp[l] = ld[l];
+            }
+        }
+        if(ddp != NULL){
+            for(int l = 0; l < LANES; l++){
+                ddp[l] = 2 * ldd[l];
+            }
+        }
+    }
+
+    //次数を定数にした版(係数のループが展開される)
+    template<int DEGREE> inline void evaluateLanesFixed(const double* c, const double* x, double* p, double* dp, double* ddp){
+        double lp[LANES], ld[LANES], ldd[LANES];
+        for(int l = 0; l < LANES; l++){
+            lp[l] = c[DEGREE];
+            ld[l] = 0;
+            ldd[l] = 0;
+        }
+        for(int k = DEGREE-1; k >= 0; k--){
+            for(int l = 0; l < LANES; l++){
+                ldd[l] = fmadd(ldd[l], x[l], ld[l]);
+                ld[l] = fmadd(ld[l], x[l], lp[l]);
+                lp[l] = fmadd(lp[l], x[l], c[k]);
+            }
+        }
+        for(int l = 0; l < LANES; l++){
+            p[l] = lp[l];
+            if(dp != NULL){
+                dp[l] = ld[l];
+            }
+            if(ddp != NULL){
+                ddp[l] = 2 * ldd[l];
+            }
+        }
+    }
+
+    //count個の点をLANES個ずつ計算する(端数は0で埋めて計算し、結果を捨てる)
+    template<class Kernel> inline void forEachLanes(size_t count, const double* x, double* p, double* dp, double* ddp, Kernel kernel){
+        size_t i = 0;
+        for(; i + LANES <= count; i += LANES){
+            kernel(x + i, p + i, dp != NULL ? dp + i : NULL, ddp != NULL ? ddp + i : NULL);
+        }
+        if(i < count){
+            double tx[LANES] = {0}, tp[LANES], td[LANES], tdd[LANES];
+            size_t rest = count - i;
+            for(size_t l = 0; l < rest; l++){
+                tx[l] = x[i + l];
+            }
+            kernel(tx, tp, dp != NULL ? td : NULL, ddp != NULL ? tdd : NULL);
+            for(size_t l = 0; l < rest; l++){
+                p[i + l] = tp[l];
+                if(dp != NULL){
+                    dp[i + l] = td[l];
+                }
+                if(ddp != NULL){
+                    ddp[i + l] = tdd[l];
+                }
+            }
+        }
+    }
+
+    template<int DEGREE> inline void evaluateManyFixed(const double* c, size_t count, const double* x, double* p, double* dp, double* ddp){
+        forEachLanes(count, x, p, dp, ddp, [c](const double* lx, double* lp, double* ld, double* ldd){
+            evaluateLanesFixed<DEGREE>(c, lx, lp, ld, ldd);
+        });
+    }
+
+    //count個の点 x についての p, p', p''(dp, ddpがNULLなら求めない)
+    inline void evaluateMany(const double* c, int degree, size_t count, const double* x, double* p, double* dp = NULL, double* ddp = NULL){
+        switch(degree){
+            case 1: evaluateManyFixed<1>(c, count, x, p, dp, ddp); return;
+            case 2: evaluateManyFixed<2>(c, count, x, p, dp, ddp); return;
+            case 3: evaluateManyFixed<3>(c, count, x, p, dp, ddp); return;
+            case 4: evaluateManyFixed<4>(c, count, x, p, dp, ddp); return;
+            case 5: evaluateManyFixed<5>(c, count, x, p, dp, ddp); return;
+            case 6: evaluateManyFixed<6>(c, count, x, p, dp, ddp); return;
+            case 7: evaluateManyFixed<7>(c, count, x, p, dp, ddp); return;
+            case 8: evaluateManyFixed<8>(c, count, x, p, dp, ddp); return;
+        }
+        forEachLanes(count, x, p, dp, ddp, [c, degree](const double* lx, double* lp, double* ld, double* ldd){
+            evaluateLanes(c, degree, lx, lp, ld, ldd);
+        });
+    }
+
+    inline void evaluateMany(const std::vector<double>& c, size_t count, const double* x, double* p, double* dp = NULL, double* ddp = NULL){
+        evaluateMany(c.data(), (int)c.size() - 1, count, x, p, dp, ddp);
+    }
+
+    //z = (xr, xi) での p(z) = (pr, pi), p'(z) = (dr, di)
+    inline void evaluateComplex(const double* c, int degree, double xr, double xi, double& pr, double& pi, double& dr, double& di){
+        pr = c[degree];
+        pi = 0;
+        dr = 0;
+        di = 0;
+        for(int k = degree-1; k >= 0; k--){
+            //d = d*z + p
+            double tr = fmadd(dr, xr, fmadd(-di, xi, pr));
+            double ti = fmadd(dr, xi, fmadd(di, xr, pi));
+            dr = tr;
+            di = ti;
+            //p = p*z + c_k
+            tr = fmadd(pr, xr, fmadd(-pi, xi, c[k]));
+            ti = fmadd(pr, xi, pi * xr);
+            pr = tr;
+            pi = ti;
+        }
+    }
+
+    //z = (xr, xi) での |p(z)| / ∑|c_k|max(1,|z|)^k(丸め誤差だけなら係数の桁数程度の値になる)
+    //(|z|^kで割ると、0の重解の近くでは解がわずかにずれただけで1近くになるので、|z| < 1では1で割る)
+    template<class T, class C> inline T relativeResidual(const C* c, int degree, T xr, T xi = 0){
+        T pr = 0, pi = 0, scale = 0;
+        T modulus = std::sqrt(xr * xr + xi * xi);
+        T bound = modulus > 1 ? modulus : 1;
+        for(int k = degree; k >= 0; k--){
+            T t = pr * xr - pi * xi + (T)c[k];
+            pi = pr * xi + pi * xr;
+            pr = t;
+            scale = scale * bound + std::fabs((T)c[k]);
+        }
+        return scale > 0 ? std::sqrt(pr * pr + pi * pi) / scale : 0;
+    }
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include<string.h>
+#include<vector>
+#include<chrono>
+#include<random>
+#include"leastSquare.h"
+
+int main(int argc, char* argv[]){
+    //引数: [次数] [点のファイル("-"なら標準入力)] [binary]
+    int degree = argc > 1 ? atoi(argv[1]) : 2;
+    ThreadPool pool;
+
+    if(argc > 2){
+        bool binary = argc > 3 && strcmp(argv[3], "binary") == 0;
+        FILE* fp = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], binary ? "rb" : "r");
+        if(fp == NULL){
+            std::cerr << "error : " << argv[2] << " を開けません" << std::endl;
+            return 1;
+        }
+        LeastSquare fitter(degree, &pool);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool ok = binary ? fitter.addBinary(fp) : fitter.addStream(fp);
+        std::vector<long double> coefficients = fitter.fit();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if(fp != stdin){
+            fclose(fp);
+        }
+        if(coefficients.empty()){
+            return 1;
+        }
+        printf("%d次式 (%.0Lf 点, %.3f 秒): ", degree, fitter.getCount(), elapsed);
+        LeastSquare::printPolynomial(coefficients);
+        return ok ? 0 : 1;
+    }
+
+    //入力の点集合
+    double xs[] = {0.5, 1.0, 1.5, 2.0, 2.5};
+    double ys[] = {10.01, 8.71, 7.41, 6.92, 5.94};
+    for(int d = 1; d <= 2; d++){
+        LeastSquare fitter(d);
+        fitter.add(xs, ys, 5);
+        printf("%d次式: ", d);
+        LeastSquare::printPolynomial(fitter.fit());
+    }
+
+    //高い次数: e^x を[0, 2]の点から14次式で近似し、正規方程式とQR分解の誤差を比べる
+    {
+        const int high = 14;
+        std::vector<double> hx(2001), hy(2001);
+        for(size_t k = 0; k < hx.size(); k++){
+            hx[k] = 2.0 * k / (hx.size() - 1);
+            hy[k] = exp(hx[k]);
+        }
+        LeastSquare normal(high);
+        normal.add(hx.data(), hy.data(), hx.size());
+        std::vector<long double> a = normal.fit();
+        QRLeastSquare qr(high + 1, &pool);
+        qr.addPolynomial(hx.data(), hy.data(), hx.size());
+        std::vector<double> b = qr.solve();
+        double normal_error = 0, qr_error = 0;
+        for(size_t k = 0; k < hx.size() && !a.empty() && !b.empty(); k++){
+            long double pa = 0;
+            double pb = 0;
+            for(int j = high; j >= 0; j--){
+                pa = pa * hx[k] + a[j];
+                pb = pb * hx[k] + b[j];
+            }
+            normal_error = std::max(normal_error, (double)fabsl(pa - hy[k]));
+            qr_error = std::max(qr_error, fabs(pb - hy[k]));
+        }
+        printf("e^x の%d次式: 最大誤差 正規方程式(long double) %.3e, QR(double) %.3e\n", high, normal_error, qr_error);
+    }
+
+    //多変数: z = 1 + 2u - 3v + 0.5uv + 雑音 を (1, u, v, uv) の列で当てはめる
+    {
+        size_t rows = 1000000;
+        std::mt19937_64 random(3);
+        std::uniform_real_distribution<double> position(-1, 1);
+        std::normal_distribution<double> noise(0, 0.01);
+        std::vector<double> design(rows * 4), z(rows);
+        for(size_t k = 0; k < rows; k++){
+            double u = position(random), v = position(random);
+            double* row = design.data() + k * 4;
+            row[0] = 1;
+            row[1] = u;
+            row[2] = v;
+            row[3] = u * v;
+            z[k] = 1 + 2 * u - 3 * v + 0.5 * u * v + noise(random);
+        }
+        QRLeastSquare qr(4, &pool);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        qr.addRows(design.data(), z.data(), rows);
+        std::vector<double> c = qr.solve();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if(!c.empty()){
+            printf("z(u, v) = %+g %+gu %+gv %+guv (%zu 点, 残差 %.3f, %.3f 秒)\n", c[0], c[1], c[2], c[3], rows, qr.getResidual(), elapsed);
+        }
+    }
+
+    //スライド窓: 係数がゆっくり変わる y = (1 + 0.5 sin(t/5000)) + 2x - x^2 + 雑音 を直近256点で当てはめ続ける
+    {
+        const int degree = 2;
+        const size_t window = 256;
+        long long samples = 1000000;
+        std::mt19937_64 random(4);
+        std::uniform_real_distribution<double> position(-1, 1);
+        std::normal_distribution<double> noise(0, 0.01);
+        SlidingLeastSquare sliding(degree, window);
+        std::vector<double> last_x, last_y;
+        double c[degree + 1], offset_error = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(long long t = 0; t < samples; t++){
+            double x = position(random);
+            double offset = 1 + 0.5 * sin(t / 5000.0);
+            double y = offset + 2 * x - x * x + noise(random);
+            sliding.add(x, y);
+            if(sliding.solve(c) && t >= (long long)window){
+                offset_error = std::max(offset_error, fabs(c[0] - offset));
+            }
+            if(t >= samples - (long long)window){
+                last_x.push_back(x);
+                last_y.push_back(y);
+            }
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        //最後の窓を一括のQR分解で解いたものと比べる
+        QRLeastSquare batch(degree + 1);
+        batch.addPolynomial(last_x.data(), last_y.data(), last_x.size());
+        std::vector<double> expected = batch.solve();
+        double difference = 0;
+        for(int j = 0; j <= degree && !expected.empty(); j++){
+            difference = std::max(difference, fabs(c[j] - expected[j]));
+        }
+        printf("スライド窓 (%zu 点, %lld 回): 1点あたり %.3f マイクロ秒, 定数項の最大誤差 %.3e, 一括QRとの差 %.3e, 作り直し %lld 回\n",
+            window, samples, elapsed / samples * 1e6, offset_error, difference, sliding.getRebuilds());
+    }
+
+    //y = 1 - 2x + 0.5x^2 + 雑音 をCHUNK点ずつ作っては集計する(点は保持しない)
+    long long amount = argc > 1 ? 0 : 10000000;
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> position(-3, 3);
+    std::normal_distribution<double> noise(0, 0.1);
+    std::vector<double> x(leastSquare::CHUNK), y(leastSquare::CHUNK);
+    LeastSquare fitter(2, &pool);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double generating = 0;
+    for(long long done = 0; done < amount; done += x.size()){
+        std::chrono::steady_clock::time_point generate = std::chrono::steady_clock::now();
+        size_t chunk = std::min<long long>(x.size(), amount - done);
+        for(size_t k = 0; k < chunk; k++){
+            x[k] = position(random);
+            y[k] = 1 - 2 * x[k] + 0.5 * x[k] * x[k] + noise(random);
+        }
+        generating += std::chrono::duration<double>(std::chrono::steady_clock::now() - generate).count();
+        fitter.add(x.data(), y.data(), chunk);
+    }
+    if(amount > 0){
+        std::vector<long double> coefficients = fitter.fit();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - generating;
+        printf("%lld 点 (集計 %.3f 秒, %d スレッド): ", amount, elapsed, pool.size());
+        LeastSquare::printPolynomial(coefficients);
+    }
+
+    return 0;
+}
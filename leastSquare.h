@@ -0,0 +1,750 @@
+#ifndef LEAST_SQUARE_H
+#define LEAST_SQUARE_H
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <charconv>
+#include "threadPool.h"
+
+/* --- --- 最小二乗法(逐次集計) --- ---
+点 (x_k, y_k) に d 次多項式 y = a_0 + a_1 x + ... + a_d x^d を当てはめる正規方程式
+   ∑_j (∑_k x_k^{i+j}) a_j = ∑_k y_k x_k^i   (i = 0, ..., d)
+に必要なのは、べき和 S_m = ∑ x^m (m = 0, ..., 2d) と T_i = ∑ y x^i (i = 0, ..., d) だけである。
+・1点ごとに p ← p*x と掛けていくので、pow を呼ばずに3d+2回の積和で全てのべき和に足し込める
+・点は保持しないので、点の数Nによらずメモリは O(d) (正規方程式を作ってもO(d^2))
+・点の塊をスレッド数に分けて各スレッドが部分和を作り、最後に足し合わせる(足し算なので順序によらない)
+・ストリーム(ファイル、標準入力)からはCHUNK点ずつ読んでは集計するので、何十億点でも1回の読み込みで済む
+・正規方程式は対称正定値なので、コレスキー分解 LL^T で解く
+正規方程式は条件数が設計行列の2乗になるので、次数が高い場合や多変数の場合はQRLeastSquareを使う。
+--- --- --- --- */
+namespace leastSquare{
+    inline size_t CHUNK = 1 << 16; //1回に読み込んで集計する点の数
+    inline size_t PARALLEL_MIN = 1 << 14; //これより少ない点はスレッドに分けない
+    const size_t READ_BUFFER = 1 << 20; //テキストを読むバッファの大きさ(バイト)
+    inline size_t PANEL_BYTES = 256 * 1024; //QRで1回に分解する行の塊(パネル)の大きさの目安(バイト)
+    inline double RANK_TOLERANCE = 1e-13; //|r_jj| <= RANK_TOLERANCE*max|r_ii| なら階数落ちとみなす
+    inline long long REBUILD_INTERVAL = 100000; //スライド窓でこの回数だけ取り除いたら窓の点からRを作り直す(誤差の蓄積を断つ)
+}
+
+//べき和(正規方程式の材料)
+class PowerSums{
+private:
+    int degree; //近似曲線の次数
+    std::vector<long double> x_sums; //S_m = ∑ x^m (m = 0, ..., 2*degree)
+    std::vector<long double> xy_sums; //T_i = ∑ y x^i (i = 0, ..., degree)
+public:
+    PowerSums(int degree = 1);//コンストラクター
+    void clear();
+    void add(double x, double y);
+    void add(const double* x, const double* y, size_t amount);
+    void merge(const PowerSums& other);
+    int getDegree();
+    long double getCount();
+    std::vector<std::vector<long double> > normalEquations(); //拡大係数行列 (degree+1)*(degree+2)
+};
+
+class LeastSquare{
+private:
+    int degree; //近似曲線の次数
+    ThreadPool* pool; //NULLなら呼び出したスレッドだけで集計する
+    PowerSums sums;
+    std::vector<PowerSums> partial; //スレッドごとの部分和
+public:
+    LeastSquare(int degree, ThreadPool* pool = NULL);//コンストラクター
+    void clear();
+    void add(double x, double y);
+    void add(const double* x, const double* y, size_t amount);
+    bool addStream(FILE* fp); //1行に "x y"(区切りは空白、タブ、カンマ)のテキストを最後まで読む
+    bool addBinary(FILE* fp); //doubleの組 (x, y) を並べたバイナリを最後まで読む
+    std::vector<long double> fit(); //係数(昇べきの順)。解けなければ空
+    PowerSums& getSums();
+    long double getCount();
+    static void printPolynomial(const std::vector<long double>& coefficients);
+};
+
+/* --- --- 最小二乗法(ハウスホルダーQR, TSQR) --- ---
+縦長の設計行列 A (N行n列) と右辺 b について |Ax - b| を最小にする x を、正規方程式を作らずに求める。
+A = QR なら |Ax - b|^2 = |Rx - Q^T b|^2 + (残差) なので、R(n*n上三角)と Q^T b だけを持てばよい。
+・行はPANEL_BYTESに収まる数ずつの塊(パネル)にまとめ、[今のR | Q^T b; パネル | b] をハウスホルダー変換で
+  上三角にし直す。作業領域は列優先なので、変換の内側のループは連続したメモリを走るSIMD命令になる
+・点が多ければ行をスレッド数に分け、各スレッドが自分のRを作る。solveでそれらのRを縦に並べて
+  もう1回QR分解すれば全体のRになる(TSQR)
+・条件数が正規方程式の平方根で済むので、doubleのままで高い次数や多変数のモデルを当てはめられる
+--- --- --- --- */
+class QRLeastSquare{
+private:
+    struct State{
+        std::vector<double> R; //上三角(行優先 n*n)
+        std::vector<double> qtb; //Q^T b
+        double residual = 0; //|Ax - b|^2 のうちRで表せない分
+        bool empty = true;
+        std::vector<double> work; //作業領域(列優先)
+    };
+    int columns; //未知数の数 n
+    ThreadPool* pool; //NULLなら呼び出したスレッドだけで分解する
+    std::vector<State> states; //スレッドごとのR
+    size_t panelRows();
+    void absorb(State& state, const double* rows, const double* b, size_t amount);
+    void absorbRows(State& state, const double* rows, const double* b, size_t amount);
+public:
+    QRLeastSquare(int columns, ThreadPool* pool = NULL);//コンストラクター
+    void clear();
+    void addRows(const double* rows, const double* b, size_t amount); //rowsは行優先 amount*columns
+    void addPolynomial(const double* x, const double* y, size_t amount); //行 (1, x, ..., x^{columns-1})
+    std::vector<double> solve(); //解けなければ空
+    double getResidual(); //solveの後の |Ax - b|
+};
+
+/* --- --- 最小二乗法(スライド窓, 逐次QR) --- ---
+直近window点だけに d 次多項式を当てはめ直すことを、点が1つ来るたびに O(d^2) で行う。
+QRLeastSquareと同じく R と Q^T b を持ち、
+・入る点: 行 (1, x, ..., x^d | y) をギブンス回転で R に消し込む(R^T R に a a^T を足す)
+・出る点: 双曲線回転 [c -s; -s c] (c^2 - s^2 = 1) で R^T R から a a^T を引く(ダウンデート)
+・忘却係数λ(< 1)を与えると、点が来るたびに R と Q^T b に√λを掛けて古い点ほど軽くする
+  (窓から出る点の重みはλ^windowになっているので、その重みでダウンデートする)
+係数は後退代入 Rc = Q^T b の O(d^2) で求まる。
+ダウンデートは R^T R - a a^T が正定値でなくなると続けられず、繰り返すと誤差も溜まるので、
+失敗したときとREBUILD_INTERVAL回ごとに、持っている窓の点から R を作り直す。
+xの大きさが揃っていないと(例えば時刻そのもの)条件が悪くなるので、窓の幅で[-1, 1]程度に縮めて与える。
+--- --- --- --- */
+class SlidingLeastSquare{
+private:
+    int columns; //係数の数 d + 1
+    size_t window; //窓の点数(0なら窓なしで忘却係数だけを使う)
+    double forgetting; //忘却係数λ
+    double leaving_weight; //窓から出る点の重みの平方根 √λ^window
+    std::vector<double> R; //上三角(行優先 n*n)
+    std::vector<double> qtb; //Q^T b
+    std::vector<double> xs, ys; //窓の点(リングバッファ)
+    size_t head = 0; //最も古い点の位置
+    size_t amount = 0; //窓の中の点の数
+    long long downdates = 0; //前回作り直してからのダウンデートの回数
+    long long rebuilds = 0; //作り直した回数
+    std::vector<double> row; //作業領域
+    void makeRow(double x, double weight);
+    void update(double y);
+    bool downdate(double y);
+    void scale(double factor);
+    void rebuild();
+public:
+    SlidingLeastSquare(int degree, size_t window = 0, double forgetting = 1);//コンストラクター
+    void clear();
+    void add(double x, double y);
+    bool solve(double* coefficients); //coefficientsに d + 1 個書く。点が足りなければfalse
+    std::vector<double> solve();
+    size_t size();
+    long long getRebuilds();
+};
+
+
+//コンストラクター
+inline PowerSums::PowerSums(int degree){
+    this->degree = degree;
+    clear();
+}
+
+inline void PowerSums::clear(){
+    x_sums.assign(2 * degree + 1, 0);
+    xy_sums.assign(degree + 1, 0);
+}
+
+//1点を足し込む(x^mは前のべきにxを掛けて作る)
+inline void PowerSums::add(double x, double y){
+    long double p = 1;
+    int m = 0;
+    for(; m <= degree; m++){
+        x_sums[m] += p;
+        xy_sums[m] += y * p;
+        p *= x;
+    }
+    for(; m <= 2 * degree; m++){
+        x_sums[m] += p;
+        p *= x;
+    }
+}
+
+inline void PowerSums::add(const double* x, const double* y, size_t amount){
+    for(size_t k = 0; k < amount; k++){
+        add(x[k], y[k]);
+    }
+}
+
+inline void PowerSums::merge(const PowerSums& other){
+    for(size_t m = 0; m < x_sums.size(); m++){
+        x_sums[m] += other.x_sums[m];
+    }
+    for(size_t i = 0; i < xy_sums.size(); i++){
+        xy_sums[i] += other.xy_sums[i];
+    }
+}
+
+inline int PowerSums::getDegree(){
+    return degree;
+}
+
+inline long double PowerSums::getCount(){
+    return x_sums[0];
+}
+
+inline std::vector<std::vector<long double> > PowerSums::normalEquations(){
+    int terms = degree + 1;
+    std::vector<std::vector<long double> > matrix(terms, std::vector<long double>(terms + 1));
+    for(int i = 0; i < terms; i++){
+        for(int j = 0; j < terms; j++){
+            matrix[i][j] = x_sums[i + j];
+        }
+        matrix[i][terms] = xy_sums[i];
+    }
+    return matrix;
+}
+
+
+//コンストラクター
+inline LeastSquare::LeastSquare(int degree, ThreadPool* pool) : sums(degree){
+    this->degree = degree;
+    this->pool = pool;
+    if(pool != NULL){
+        partial.assign(pool->size(), PowerSums(degree));
+    }
+}
+
+inline void LeastSquare::clear(){
+    sums.clear();
+}
+
+inline void LeastSquare::add(double x, double y){
+    sums.add(x, y);
+}
+
+//点の塊を足し込む(十分に多ければスレッドごとに部分和を作ってから足し合わせる)
+inline void LeastSquare::add(const double* x, const double* y, size_t amount){
+    if(pool == NULL || pool->size() <= 1 || amount < leastSquare::PARALLEL_MIN){
+        sums.add(x, y, amount);
+        return;
+    }
+    size_t parts = partial.size();
+    size_t width = (amount + parts - 1) / parts;
+    pool->parallelFor(0, parts, [&](size_t t){
+        PowerSums& local = partial[t];
+        local.clear();
+        size_t from = std::min(amount, t * width);
+        size_t to = std::min(amount, from + width);
+        local.add(x + from, y + from, to - from);
+    });
+    for(PowerSums& local : partial){
+        sums.merge(local);
+    }
+}
+
+//テキストをREAD_BUFFERずつ読み、CHUNK点たまるごとに集計する(行の途中で切れた分は次のバッファへ持ち越す)
+inline bool LeastSquare::addStream(FILE* fp){
+    std::vector<char> buffer(leastSquare::READ_BUFFER + 1);
+    std::vector<double> xs, ys;
+    xs.reserve(leastSquare::CHUNK);
+    ys.reserve(leastSquare::CHUNK);
+    size_t carry = 0; //前回のバッファの末尾に残った行の途中
+    bool ok = true;
+    while(true){
+        size_t read = fread(buffer.data() + carry, 1, leastSquare::READ_BUFFER - carry, fp);
+        size_t length = carry + read;
+        bool last = read == 0;
+        if(length == 0){
+            break;
+        }
+        //最後の改行までを読む(ファイルの終わりなら全部)
+        size_t end = length;
+        if(!last){
+            while(end > 0 && buffer[end - 1] != '\n'){
+                end--;
+            }
+            if(end == 0){
+                std::cerr << "error : 1行が長すぎます" << std::endl;
+                return false;
+            }
+        }
+        const char* p = buffer.data();
+        const char* limit = buffer.data() + end;
+        while(p < limit){
+            const char* line_end = (const char*)memchr(p, '\n', limit - p);
+            if(line_end == NULL){
+                line_end = limit;
+            }
+            //先頭の空白を飛ばし、空行と#で始まる行は読まない
+            while(p < line_end && (*p == ' ' || *p == '\t' || *p == '\r')){
+                p++;
+            }
+            if(p < line_end && *p != '#'){
+                double x, y;
+                std::from_chars_result rx = std::from_chars(p, line_end, x);
+                const char* q = rx.ptr;
+                while(q < line_end && (*q == ' ' || *q == '\t' || *q == ',')){
+                    q++;
+                }
+                std::from_chars_result ry = std::from_chars(q, line_end, y);
+                if(rx.ec != std::errc() || ry.ec != std::errc()){
+                    std::cerr << "error : 数値として読めない行があります" << std::endl;
+                    ok = false;
+                }else{
+                    xs.push_back(x);
+                    ys.push_back(y);
+                    if(xs.size() >= leastSquare::CHUNK){
+                        add(xs.data(), ys.data(), xs.size());
+                        xs.clear();
+                        ys.clear();
+                    }
+                }
+            }
+            p = line_end + 1;
+        }
+        if(last){
+            break;
+        }
+        carry = length - end;
+        memmove(buffer.data(), buffer.data() + end, carry);
+    }
+    add(xs.data(), ys.data(), xs.size());
+    return ok;
+}
+
+inline bool LeastSquare::addBinary(FILE* fp){
+    std::vector<double> pairs(2 * leastSquare::CHUNK), xs(leastSquare::CHUNK), ys(leastSquare::CHUNK);
+    size_t amount;
+    while((amount = fread(pairs.data(), 2 * sizeof(double), leastSquare::CHUNK, fp)) > 0){
+        for(size_t k = 0; k < amount; k++){
+            xs[k] = pairs[2 * k];
+            ys[k] = pairs[2 * k + 1];
+        }
+        add(xs.data(), ys.data(), amount);
+    }
+    return !ferror(fp);
+}
+
+//正規方程式をコレスキー分解 A = LL^T で解く
+inline std::vector<long double> LeastSquare::fit(){
+    int terms = degree + 1;
+    std::vector<std::vector<long double> > matrix = sums.normalEquations();
+    std::vector<std::vector<long double> > L(terms, std::vector<long double>(terms, 0));
+    for(int j = 0; j < terms; j++){
+        long double diagonal = matrix[j][j];
+        for(int k = 0; k < j; k++){
+            diagonal -= L[j][k] * L[j][k];
+        }
+        if(!(diagonal > 0)){
+            std::cerr << "error : 正規方程式が正定値ではありません(異なるxの点が次数+1個以上必要です)" << std::endl;
+            return std::vector<long double>();
+        }
+        L[j][j] = sqrtl(diagonal);
+        for(int i = j + 1; i < terms; i++){
+            long double s = matrix[i][j];
+            for(int k = 0; k < j; k++){
+                s -= L[i][k] * L[j][k];
+            }
+            L[i][j] = s / L[j][j];
+        }
+    }
+    //前進代入 Lz = b、後退代入 L^T a = z
+    std::vector<long double> answer(terms);
+    for(int i = 0; i < terms; i++){
+        long double s = matrix[i][terms];
+        for(int k = 0; k < i; k++){
+            s -= L[i][k] * answer[k];
+        }
+        answer[i] = s / L[i][i];
+    }
+    for(int i = terms - 1; i >= 0; i--){
+        long double s = answer[i];
+        for(int k = i + 1; k < terms; k++){
+            s -= L[k][i] * answer[k];
+        }
+        answer[i] = s / L[i][i];
+    }
+    return answer;
+}
+
+inline PowerSums& LeastSquare::getSums(){
+    return sums;
+}
+
+inline long double LeastSquare::getCount(){
+    return sums.getCount();
+}
+
+//コンストラクター
+inline QRLeastSquare::QRLeastSquare(int columns, ThreadPool* pool){
+    this->columns = columns;
+    this->pool = pool;
+    states.resize(pool != NULL ? pool->size() : 1);
+}
+
+inline void QRLeastSquare::clear(){
+    for(State& state : states){
+        state.R.clear();
+        state.qtb.clear();
+        state.residual = 0;
+        state.empty = true;
+    }
+}
+
+//作業領域 (n + パネル行) * (n + 1) がPANEL_BYTESに収まる行数
+inline size_t QRLeastSquare::panelRows(){
+    size_t n = columns;
+    size_t rows = leastSquare::PANEL_BYTES / (sizeof(double) * (n + 1));
+    return std::max(rows > n ? rows - n : 0, n + 1);
+}
+
+//パネル(amount行)を[R | Q^T b]の下に並べてハウスホルダー変換で上三角に戻す
+inline void QRLeastSquare::absorb(State& state, const double* rows, const double* b, size_t amount){
+    const int n = columns;
+    size_t top = state.empty ? 0 : n; //上に積むRの行数
+    size_t m = top + amount;
+    std::vector<double>& W = state.work;
+    W.resize(m * (n + 1));
+    //列優先に並べる(最後の列が右辺)
+    for(int j = 0; j <= n; j++){
+        double* column = W.data() + j * m;
+        for(size_t i = 0; i < top; i++){
+            column[i] = j < n ? state.R[i * n + j] : state.qtb[i];
+        }
+        for(size_t i = 0; i < amount; i++){
+            column[top + i] = j < n ? rows[i * n + j] : b[i];
+        }
+    }
+    //j列目の対角より下を消すハウスホルダー変換 H = I - v v^T / (v^T v/2) を右の列に掛ける
+    for(int j = 0; j < n && (size_t)j < m; j++){
+        double* a = W.data() + j * m;
+        double norm = 0;
+        for(size_t i = j; i < m; i++){
+            norm += a[i] * a[i];
+        }
+        norm = sqrt(norm);
+        if(norm == 0){
+            continue;
+        }
+        double alpha = a[j] > 0 ? -norm : norm; //桁落ちしない向き
+        a[j] -= alpha; //v = a - alpha e_j
+        double vv = -alpha * a[j]; //v^T v / 2
+        for(int k = j + 1; k <= n; k++){
+            double* c = W.data() + k * m;
+            double dot = 0;
+            for(size_t i = j; i < m; i++){
+                dot += a[i] * c[i];
+            }
+            double f = dot / vv;
+            for(size_t i = j; i < m; i++){
+                c[i] -= f * a[i];
+            }
+        }
+        a[j] = alpha;
+        for(size_t i = j + 1; i < m; i++){
+            a[i] = 0;
+        }
+    }
+    //新しいRとQ^T bを取り出し、残りの右辺は残差へ
+    state.R.assign((size_t)n * n, 0);
+    state.qtb.assign(n, 0);
+    for(int i = 0; i < n && (size_t)i < m; i++){
+        for(int j = i; j < n; j++){
+            state.R[i * n + j] = W[j * m + i];
+        }
+        state.qtb[i] = W[(size_t)n * m + i];
+    }
+    for(size_t i = n; i < m; i++){
+        double r = W[(size_t)n * m + i];
+        state.residual += r * r;
+    }
+    state.empty = false;
+}
+
+inline void QRLeastSquare::absorbRows(State& state, const double* rows, const double* b, size_t amount){
+    size_t panel = panelRows();
+    for(size_t from = 0; from < amount; from += panel){
+        size_t chunk = std::min(panel, amount - from);
+        absorb(state, rows + from * columns, b + from, chunk);
+    }
+}
+
+inline void QRLeastSquare::addRows(const double* rows, const double* b, size_t amount){
+    if(pool == NULL || pool->size() <= 1 || amount < leastSquare::PARALLEL_MIN){
+        absorbRows(states[0], rows, b, amount);
+        return;
+    }
+    size_t parts = states.size();
+    size_t width = (amount + parts - 1) / parts;
+    pool->parallelFor(0, parts, [&](size_t t){
+        size_t from = std::min(amount, t * width);
+        size_t to = std::min(amount, from + width);
+        absorbRows(states[t], rows + from * columns, b + from, to - from);
+    });
+}
+
+//多項式の設計行列をパネルごとに作って分解する(x^kは前のべきにxを掛けて作る)
+inline void QRLeastSquare::addPolynomial(const double* x, const double* y, size_t amount){
+    size_t panel = panelRows();
+    size_t parts = (pool == NULL || amount < leastSquare::PARALLEL_MIN) ? 1 : states.size();
+    size_t width = (amount + parts - 1) / parts;
+    auto part = [&](size_t t){
+        std::vector<double> rows(panel * columns);
+        size_t begin = std::min(amount, t * width);
+        size_t end = std::min(amount, begin + width);
+        for(size_t from = begin; from < end; from += panel){
+            size_t chunk = std::min(panel, end - from);
+            for(size_t i = 0; i < chunk; i++){
+                double p = 1;
+                for(int j = 0; j < columns; j++){
+                    rows[i * columns + j] = p;
+                    p *= x[from + i];
+                }
+            }
+            absorb(states[t], rows.data(), y + from, chunk);
+        }
+    };
+    if(parts == 1){
+        part(0);
+    }else{
+        pool->parallelFor(0, parts, part);
+    }
+}
+
+//スレッドごとのRを縦に並べてQR分解し直し(TSQR)、後退代入 Rx = Q^T b で解く
+inline std::vector<double> QRLeastSquare::solve(){
+    const int n = columns;
+    State total;
+    for(State& state : states){
+        if(!state.empty){
+            absorb(total, state.R.data(), state.qtb.data(), n);
+            total.residual += state.residual;
+        }
+    }
+    if(total.empty){
+        std::cerr << "error : 点がありません" << std::endl;
+        return std::vector<double>();
+    }
+    double largest = 0;
+    for(int i = 0; i < n; i++){
+        largest = std::max(largest, fabs(total.R[i * n + i]));
+    }
+    std::vector<double> answer(n);
+    for(int i = n - 1; i >= 0; i--){
+        double r = total.R[i * n + i];
+        if(fabs(r) <= leastSquare::RANK_TOLERANCE * largest){
+            std::cerr << "error : 設計行列が階数落ちしています" << std::endl;
+            return std::vector<double>();
+        }
+        double s = total.qtb[i];
+        for(int k = i + 1; k < n; k++){
+            s -= total.R[i * n + k] * answer[k];
+        }
+        answer[i] = s / r;
+    }
+    //solveを何度呼んでもよいように、まとめたRを0番目に残す
+    for(State& state : states){
+        state.R.clear();
+        state.qtb.clear();
+        state.residual = 0;
+        state.empty = true;
+    }
+    states[0].R = total.R;
+    states[0].qtb = total.qtb;
+    states[0].residual = total.residual;
+    states[0].empty = false;
+    return answer;
+}
+
+inline double QRLeastSquare::getResidual(){
+    double residual = 0;
+    for(State& state : states){
+        residual += state.residual;
+    }
+    return sqrt(residual);
+}
+
+//コンストラクター
+inline SlidingLeastSquare::SlidingLeastSquare(int degree, size_t window, double forgetting){
+    this->columns = degree + 1;
+    this->window = window;
+    this->forgetting = forgetting;
+    this->leaving_weight = sqrt(pow(forgetting, (double)window));
+    R.assign((size_t)columns * columns, 0);
+    qtb.assign(columns, 0);
+    xs.assign(window, 0);
+    ys.assign(window, 0);
+    row.assign(columns, 0);
+}
+
+inline void SlidingLeastSquare::clear(){
+    std::fill(R.begin(), R.end(), 0);
+    std::fill(qtb.begin(), qtb.end(), 0);
+    head = 0;
+    amount = 0;
+    downdates = 0;
+}
+
+//row = weight * (1, x, ..., x^d)
+inline void SlidingLeastSquare::makeRow(double x, double weight){
+    double p = weight;
+    for(int j = 0; j < columns; j++){
+        row[j] = p;
+        p *= x;
+    }
+}
+
+//[R | Q^T b; row | y] の row をギブンス回転で消す
+inline void SlidingLeastSquare::update(double y){
+    const int n = columns;
+    for(int j = 0; j < n; j++){
+        double r = R[j * n + j], t = row[j];
+        if(t == 0){
+            continue;
+        }
+        double h = hypot(r, t);
+        double c = r / h, s = t / h;
+        R[j * n + j] = h;
+        for(int k = j + 1; k < n; k++){
+            double u = R[j * n + k];
+            R[j * n + k] = c * u + s * row[k];
+            row[k] = c * row[k] - s * u;
+        }
+        double u = qtb[j];
+        qtb[j] = c * u + s * y;
+        y = c * y - s * u;
+    }
+}
+
+//[R | Q^T b] から row | y を双曲線回転で取り除く(正定値でなくなればfalse)
+inline bool SlidingLeastSquare::downdate(double y){
+    const int n = columns;
+    for(int j = 0; j < n; j++){
+        double r = R[j * n + j], t = row[j];
+        if(t == 0){
+            continue;
+        }
+        double rho = t / r;
+        if(!(fabs(rho) < 1)){
+            return false;
+        }
+        double c = 1 / sqrt((1 - rho) * (1 + rho)), s = rho * c;
+        R[j * n + j] = r * sqrt((1 - rho) * (1 + rho));
+        for(int k = j + 1; k < n; k++){
+            double u = R[j * n + k];
+            R[j * n + k] = c * u - s * row[k];
+            row[k] = c * row[k] - s * u;
+        }
+        double u = qtb[j];
+        qtb[j] = c * u - s * y;
+        y = c * y - s * u;
+    }
+    return true;
+}
+
+inline void SlidingLeastSquare::scale(double factor){
+    for(double& r : R){
+        r *= factor;
+    }
+    for(double& q : qtb){
+        q *= factor;
+    }
+}
+
+//窓の点を古い順に入れ直して R を作る
+inline void SlidingLeastSquare::rebuild(){
+    std::fill(R.begin(), R.end(), 0);
+    std::fill(qtb.begin(), qtb.end(), 0);
+    double root = sqrt(forgetting);
+    for(size_t k = 0; k < amount; k++){
+        size_t i = (head + k) % window;
+        if(forgetting != 1){
+            scale(root);
+        }
+        makeRow(xs[i], 1);
+        update(ys[i]);
+    }
+    downdates = 0;
+    rebuilds++;
+}
+
+//1点を加える(窓が満ちていれば最も古い点を取り除く)
+inline void SlidingLeastSquare::add(double x, double y){
+    if(forgetting != 1){
+        scale(sqrt(forgetting));
+    }
+    if(window == 0){
+        makeRow(x, 1);
+        update(y);
+        return;
+    }
+    bool broken = false;
+    if(amount == window){
+        makeRow(xs[head], leaving_weight);
+        broken = !downdate(leaving_weight * ys[head]);
+        head = (head + 1) % window;
+        amount--;
+        downdates++;
+    }
+    size_t tail = (head + amount) % window;
+    xs[tail] = x;
+    ys[tail] = y;
+    amount++;
+    if(broken || downdates >= leastSquare::REBUILD_INTERVAL){
+        rebuild();
+    }else{
+        makeRow(x, 1);
+        update(y);
+    }
+}
+
+//後退代入 Rc = Q^T b
+inline bool SlidingLeastSquare::solve(double* coefficients){
+    const int n = columns;
+    double largest = 0;
+    for(int i = 0; i < n; i++){
+        largest = std::max(largest, fabs(R[i * n + i]));
+    }
+    for(int i = n - 1; i >= 0; i--){
+        double r = R[i * n + i];
+        if(!(fabs(r) > leastSquare::RANK_TOLERANCE * largest)){
+            return false;
+        }
+        double s = qtb[i];
+        for(int k = i + 1; k < n; k++){
+            s -= R[i * n + k] * coefficients[k];
+        }
+        coefficients[i] = s / r;
+    }
+    return true;
+}
+
+inline std::vector<double> SlidingLeastSquare::solve(){
+    std::vector<double> coefficients(columns);
+    if(!solve(coefficients.data())){
+        coefficients.clear();
+    }
+    return coefficients;
+}
+
+inline size_t SlidingLeastSquare::size(){
+    return amount;
+}
+
+inline long long SlidingLeastSquare::getRebuilds(){
+    return rebuilds;
+}
+
+//y(x) = a_0 + a_1x + a_2x^{2} ... の形で表示する
+inline void LeastSquare::printPolynomial(const std::vector<long double>& coefficients){
+    printf("y(x) =");
+    for(size_t i = 0; i < coefficients.size(); i++){
+        printf(" %+Lg", coefficients[i]);
+        if(i == 1){
+            printf("x");
+        }else if(i > 1){
+            printf("x^{%zu}", i);
+        }
+    }
+    printf("\n");
+}
+
+#endif
@@ -1,7 +1,64 @@
-from matplotlib import pyplot as plt
-import numpy as np
+import ctypes
+import os
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+# C++のソルバー(solverLibrary.cppから作るlibsolver.so)をctypesで呼ぶ
+# 見つからなければ下の純粋なPythonの実装を使う
+# 作り方: g++ -std=c++17 -O2 -shared -fPIC -pthread solverLibrary.cpp -o libsolver.so
+SOLVER_ABI_VERSION = 1
+SOLVER_OK = 0
+SOLVER_FIT_QR = 0
+
+def load_solver_library():
+    path = os.environ.get("SOLVER_LIBRARY", os.path.join(os.path.dirname(os.path.abspath(__file__)), "libsolver.so"))
+    try:
+        library = ctypes.CDLL(path)
+    except OSError:
+        return None
+    if library.solver_abi_version() != SOLVER_ABI_VERSION:
+        return None
+    double_p = ctypes.POINTER(ctypes.c_double)
+    library.solver_lu.argtypes = [ctypes.c_int, double_p, double_p, double_p]
+    library.solver_lu.restype = ctypes.c_int
+    library.solver_gauss_jordan.argtypes = [ctypes.c_int, double_p, double_p, double_p]
+    library.solver_gauss_jordan.restype = ctypes.c_int
+    library.solver_polyval.argtypes = [double_p, ctypes.c_int, ctypes.c_size_t, double_p, double_p]
+    library.solver_polyval.restype = None
+    library.solver_polyfit.argtypes = [ctypes.c_int, ctypes.c_size_t, double_p, double_p, double_p, ctypes.c_int]
+    library.solver_polyfit.restype = ctypes.c_int
+    return library
+
+solver_library = load_solver_library()
+
+def as_double_buffer(values):
+    """doubleの連続した領域にする(NumPyのfloat64の連続配列ならコピーせずにそのまま渡す)
+    戻り値は(ポインタ, 領域を保持するオブジェクト, 要素数)"""
+    if np is not None and isinstance(values, np.ndarray):
+        array = np.ascontiguousarray(values, dtype=np.float64)
+        return array.ctypes.data_as(ctypes.POINTER(ctypes.c_double)), array, array.size
+    values = [float(v) for v in values]
+    array = (ctypes.c_double * len(values))(*values)
+    return ctypes.cast(array, ctypes.POINTER(ctypes.c_double)), array, len(values)
 
 def least_square_method(regression_division, pair_list):
+    if solver_library is not None:
+        if np is not None and isinstance(pair_list, np.ndarray):
+            xs, ys = pair_list[:, 0], pair_list[:, 1]
+        else:
+            xs, ys = [p[0] for p in pair_list], [p[1] for p in pair_list]
+        x_p, x_keep, count = as_double_buffer(xs)
+        y_p, y_keep, _ = as_double_buffer(ys)
+        coefficients = (ctypes.c_double * (regression_division + 1))()
+        status = solver_library.solver_polyfit(regression_division, count, x_p, y_p, coefficients, SOLVER_FIT_QR)
+        if status == SOLVER_OK:
+            return list(coefficients)
+    return least_square_method_python(regression_division, pair_list)
+
+def least_square_method_python(regression_division, pair_list):
     terms = (regression_division + 1)
     formula = [0 for _ in range(terms)] # 近似曲線(出力)
     matrix = [[] for _ in range(terms)] # 正規方程式
@@ -27,10 +84,20 @@ def least_square_method(regression_division, pair_list):
     for i in range(terms):
         matrix[i].append(sum_list[i])
 
-    formula = gauss_jordan_method(matrix, terms)
+    formula = gauss_jordan_method_python(matrix, terms)
     return formula
 
 def gauss_jordan_method(augmented_matrix, variable_amount):
+    if solver_library is not None:
+        n = variable_amount
+        a_p, a_keep, _ = as_double_buffer([augmented_matrix[i][j] for i in range(n) for j in range(n)])
+        b_p, b_keep, _ = as_double_buffer([augmented_matrix[i][n] for i in range(n)])
+        answer = (ctypes.c_double * n)()
+        if solver_library.solver_gauss_jordan(n, a_p, b_p, answer) == SOLVER_OK:
+            return list(answer)
+    return gauss_jordan_method_python(augmented_matrix, variable_amount)
+
+def gauss_jordan_method_python(augmented_matrix, variable_amount):
     for i in range(variable_amount):
         # 係数を1に揃える
         for j in range(i, variable_amount):
@@ -49,6 +116,13 @@ def gauss_jordan_method(augmented_matrix, variable_amount):
     return answer
 
 def calc_polynomial(ascending_order, x):
+    # NumPyの配列はまとめてC++のホーナー法で評価する
+    if solver_library is not None and np is not None and isinstance(x, np.ndarray) and len(ascending_order) > 0:
+        c_p, c_keep, _ = as_double_buffer(np.asarray(ascending_order, dtype=np.float64))
+        x_p, x_keep, count = as_double_buffer(x)
+        y = np.empty(x_keep.shape, dtype=np.float64)
+        solver_library.solver_polyval(c_p, len(ascending_order) - 1, count, x_p, y.ctypes.data_as(ctypes.POINTER(ctypes.c_double)))
+        return y
     ans = 0
     for i in range(len(ascending_order)):
         ans += ascending_order[i]*(x**i)
@@ -66,6 +140,8 @@ def print_polynomial(ascending_order, x, func="y(x)", variable="x"):
     print()
 
 def main():
+    from matplotlib import pyplot as plt
+
     # 入力の点集合
     points = tuple((
         (0.5, 10.01),
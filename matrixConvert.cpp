@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include "matrixFile.h"
+
+//Matrix Market/CSVの行列をバイナリ形式(.namx)に変換する
+//右辺ベクトルを別ファイル(1列のMatrix Market array形式またはCSV)で渡すこともできる
+int main(int argc, char* argv[]){
+    if(argc < 3){
+        fprintf(stderr, "usage: %s <input.mtx|input.csv> <output.namx> [rhs.mtx|rhs.csv]\n", argv[0]);
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+
+    //行列の解析
+    auto start = std::chrono::steady_clock::now();
+    MatrixData data;
+    MatrixParser parser;
+    if(!parser.parse(input, data)){
+        return 1;
+    }
+    if(argc > 3){
+        MatrixData rhs;
+        if(!parser.parse(argv[3], rhs)){
+            return 1;
+        }
+        //1列の密行列、または1行のCSVを右辺として受け付ける
+        if(rhs.format != matrixFile::DENSE || rhs.values.size() != data.rows){
+            std::cerr << "error : 右辺ベクトルの要素数が行数と一致しません" << std::endl;
+            return 1;
+        }
+        data.rhs = rhs.values;
+    }
+    auto parsed = std::chrono::steady_clock::now();
+
+    //バイナリ形式で書き出し
+    if(!data.write(output)){
+        return 1;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("%s: %llu x %llu (%s, 非零要素 %zu, 右辺%s)\n", output.c_str(),
+        (unsigned long long)data.rows, (unsigned long long)data.cols,
+        data.format == matrixFile::DENSE ? "密行列" : "CSR", data.values.size(),
+        data.rhs.empty() ? "なし" : "あり");
+    printf("解析 %.3f 秒 (%d スレッド), 書き出し %.3f 秒\n",
+        std::chrono::duration<double>(parsed - start).count(), matrixFile::THREADS,
+        std::chrono::duration<double>(end - parsed).count());
+    return 0;
+}
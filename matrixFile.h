@@ -0,0 +1,761 @@
+#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <thread>
+#include <algorithm>
+#include <charconv>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* --- --- 行列ファイルの読み込み --- ---
+連立方程式をmain()に直書きせず、ファイルから読み込むための仕組み。
+
+(1) バイナリ形式(拡張子 .namx)
+    mmapしてそのまま(コピーせずに)参照できる形式。数値は全てリトルエンディアン。
+    [0, 128)          ヘッダー(matrixFile::Header)
+    values_offset     値の配列 double
+                        密行列: rows*cols個(行優先)
+                        CSR   : nnz個
+    row_ptr_offset    CSRのみ: 各行の先頭位置 uint64_t (rows+1個)
+    col_idx_offset    CSRのみ: 列番号 uint32_t (nnz個、各行内で昇順)
+    rhs_offset        右辺ベクトル double (rows個)。無い場合は0
+    各領域の開始位置はmatrixFile::ALIGNMENT(64バイト)の倍数に揃える。
+
+(2) テキスト形式
+    Matrix Market(.mtx)の coordinate/array、real/integer/pattern、general/symmetric と
+    CSV(.csv、1行が1つの方程式)を読み込める。CSVの列数が行数+1なら最後の列を右辺とする。
+    ファイルをmmapして行の切れ目でスレッド数に分割し、各スレッドが並列に数値を読む。
+    読み込んだ結果はMatrixData::writeでバイナリ形式に変換できる(matrixConvert.cpp)。
+--- --- --- --- */
+namespace matrixFile{
+    const char MAGIC[8] = {'N', 'A', 'M', 'A', 'T', 'R', 'X', '\0'};
+    const uint32_t VERSION = 1;
+    const uint32_t DENSE = 0; //密行列
+    const uint32_t CSR = 1; //圧縮行格納(疎行列)
+    const uint64_t ALIGNMENT = 64; //各領域の境界
+    inline int THREADS = std::max(1u, std::thread::hardware_concurrency()); //テキスト解析のスレッド数
+
+    struct Header{
+        char     magic[8];
+        uint32_t version;
+        uint32_t format; //DENSE or CSR
+        uint64_t rows;
+        uint64_t cols;
+        uint64_t nnz; //密行列ではrows*cols
+        uint64_t values_offset;
+        uint64_t row_ptr_offset;
+        uint64_t col_idx_offset;
+        uint64_t rhs_offset;
+        uint8_t  reserved[56];
+    };
+    static_assert(sizeof(Header) == 128, "header must be 128 bytes");
+
+    inline uint64_t align(uint64_t offset){
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    inline bool endsWith(const std::string& s, const std::string& suffix){
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+//メモリ上に展開した行列(テキスト解析の結果、バイナリ形式の書き出し元)
+class MatrixData{
+public:
+    uint32_t format = matrixFile::DENSE;
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+    std::vector<double>   values;
+    std::vector<uint64_t> row_ptr;
+    std::vector<uint32_t> col_idx;
+    std::vector<double>   rhs;
+    bool write(std::string path);
+};
+
+//バイナリ形式をmmapした読み込み専用の行列(値はコピーしない)
+class MatrixFile{
+private:
+    int fd = -1;
+    void* base = NULL;
+    size_t length = 0;
+    matrixFile::Header header;
+public:
+    ~MatrixFile();
+    bool open(std::string path);
+    uint64_t rows();
+    uint64_t cols();
+    uint64_t nnz();
+    bool isDense();
+    bool hasRhs();
+    const double* values();
+    const uint64_t* rowPointers();
+    const uint32_t* columnIndices();
+    const double* rhs();
+    void getRow(uint64_t i, double* row); //i行目を密な配列(cols個)に展開する
+    std::vector<std::vector<long double> > toAugmentedMatrix();
+};
+
+//Matrix Market、CSVの並列解析
+class MatrixParser{
+private:
+    const char* text = NULL;
+    size_t length = 0;
+    int threads;
+    std::vector<std::pair<size_t, size_t> > splitLines(size_t begin);
+    static const char* skipSpace(const char* p, const char* end);
+    static const char* nextLine(const char* p, const char* end);
+    static const char* parseNumber(const char* p, const char* end, double& value);
+public:
+    MatrixParser(int threads = matrixFile::THREADS);
+    bool parseMatrixMarket(std::string path, MatrixData& data);
+    bool parseCSV(std::string path, MatrixData& data);
+    bool parse(std::string path, MatrixData& data); //拡張子で形式を判定する
+};
+
+
+inline bool MatrixData::write(std::string path){
+    matrixFile::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, matrixFile::MAGIC, sizeof(header.magic));
+    header.version = matrixFile::VERSION;
+    header.format = format;
+    header.rows = rows;
+    header.cols = cols;
+    header.nnz = values.size();
+    uint64_t offset = matrixFile::align(sizeof(header));
+    header.values_offset = offset;
+    offset = matrixFile::align(offset + values.size() * sizeof(double));
+    if(format == matrixFile::CSR){
+        header.row_ptr_offset = offset;
+        offset = matrixFile::align(offset + row_ptr.size() * sizeof(uint64_t));
+        header.col_idx_offset = offset;
+        offset = matrixFile::align(offset + col_idx.size() * sizeof(uint32_t));
+    }
+    if(!rhs.empty()){
+        header.rhs_offset = offset;
+        offset = matrixFile::align(offset + rhs.size() * sizeof(double));
+    }
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if(fp == NULL){
+        std::cerr << "error : ファイルを作成できません: " << path << std::endl;
+        return false;
+    }
+    //各領域を書き込み、次の領域の開始位置まで0で埋める
+    uint64_t written = 0;
+    auto put = [&](const void* data, uint64_t bytes, uint64_t at){
+        static const char zeros[matrixFile::ALIGNMENT] = {0};
+        while(written < at){
+            uint64_t pad = std::min<uint64_t>(at - written, sizeof(zeros));
+            written += fwrite(zeros, 1, pad, fp);
+        }
+        written += fwrite(data, 1, bytes, fp);
+    };
+    put(&header, sizeof(header), 0);
+    put(values.data(), values.size() * sizeof(double), header.values_offset);
+    if(format == matrixFile::CSR){
+        put(row_ptr.data(), row_ptr.size() * sizeof(uint64_t), header.row_ptr_offset);
+        put(col_idx.data(), col_idx.size() * sizeof(uint32_t), header.col_idx_offset);
+    }
+    if(!rhs.empty()){
+        put(rhs.data(), rhs.size() * sizeof(double), header.rhs_offset);
+    }
+    bool ok = !ferror(fp);
+    ok = (fclose(fp) == 0) && ok;
+    if(!ok){
+        std::cerr << "error : 書き込みに失敗しました: " << path << std::endl;
+    }
+    return ok;
+}
+
+
+inline MatrixFile::~MatrixFile(){
+    if(base != NULL){
+        munmap(base, length);
+    }
+    if(fd >= 0){
+        close(fd);
+    }
+}
+
+inline bool MatrixFile::open(std::string path){
+    fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(matrixFile::Header)){
+        std::cerr << "error : 行列ファイルを開けません: " << path << std::endl;
+        return false;
+    }
+    length = st.st_size;
+    base = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    if(base == MAP_FAILED){
+        base = NULL;
+        std::cerr << "error : mmapに失敗しました: " << path << std::endl;
+        return false;
+    }
+    memcpy(&header, base, sizeof(header));
+    if(memcmp(header.magic, matrixFile::MAGIC, sizeof(header.magic)) != 0 || header.version != matrixFile::VERSION){
+        std::cerr << "error : 行列ファイルの形式が違います: " << path << std::endl;
+        return false;
+    }
+    //各領域(count個のsizeバイト)がファイル内に収まっているか確認する(大きさの計算が桁あふれする場合も不正とする)
+    auto inside = [&](uint64_t offset, uint64_t count, uint64_t size){
+        uint64_t bytes = 0, end = 0;
+        return offset % matrixFile::ALIGNMENT == 0
+            && !__builtin_mul_overflow(count, size, &bytes)
+            && !__builtin_add_overflow(offset, bytes, &end)
+            && end <= length;
+    };
+    bool ok = header.rows < UINT64_MAX && inside(header.values_offset, header.nnz, sizeof(double));
+    if(header.format == matrixFile::CSR){
+        ok = ok && inside(header.row_ptr_offset, header.rows + 1, sizeof(uint64_t))
+                && inside(header.col_idx_offset, header.nnz, sizeof(uint32_t));
+    }else{
+        uint64_t elements = 0;
+        ok = ok && header.format == matrixFile::DENSE
+                && !__builtin_mul_overflow(header.rows, header.cols, &elements) && header.nnz == elements;
+    }
+    if(header.rhs_offset != 0){
+        ok = ok && inside(header.rhs_offset, header.rows, sizeof(double));
+    }
+    madvise(base, length, MADV_SEQUENTIAL);
+    //CSRの構造: row_ptrは0から始まって減らずにnnzで終わり、列番号は全てcols未満
+    if(ok && header.format == matrixFile::CSR){
+        const uint64_t* row_ptr = rowPointers();
+        const uint32_t* col_idx = columnIndices();
+        ok = row_ptr[0] == 0 && row_ptr[header.rows] == header.nnz;
+        for(uint64_t i = 0; ok && i < header.rows; i++){
+            ok = row_ptr[i] <= row_ptr[i+1];
+        }
+        for(uint64_t k = 0; ok && k < header.nnz; k++){
+            ok = col_idx[k] < header.cols;
+        }
+    }
+    if(!ok){
+        std::cerr << "error : 行列ファイルが壊れています: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+inline uint64_t MatrixFile::rows(){
+    return header.rows;
+}
+
+inline uint64_t MatrixFile::cols(){
+    return header.cols;
+}
+
+inline uint64_t MatrixFile::nnz(){
+    return header.nnz;
+}
+
+inline bool MatrixFile::isDense(){
+    return header.format == matrixFile::DENSE;
+}
+
+inline bool MatrixFile::hasRhs(){
+    return header.rhs_offset != 0;
+}
+
+inline const double* MatrixFile::values(){
+    return (const double*)((const char*)base + header.values_offset);
+}
+
+inline const uint64_t* MatrixFile::rowPointers(){
+    return header.format == matrixFile::CSR ? (const uint64_t*)((const char*)base + header.row_ptr_offset) : NULL;
+}
+
+inline const uint32_t* MatrixFile::columnIndices(){
+    return header.format == matrixFile::CSR ? (const uint32_t*)((const char*)base + header.col_idx_offset) : NULL;
+}
+
+inline const double* MatrixFile::rhs(){
+    return hasRhs() ? (const double*)((const char*)base + header.rhs_offset) : NULL;
+}
+
+inline void MatrixFile::getRow(uint64_t i, double* row){
+    if(isDense()){
+        memcpy(row, values() + i * header.cols, header.cols * sizeof(double));
+        return;
+    }
+    std::fill(row, row + header.cols, 0.0);
+    const uint64_t* row_ptr = rowPointers();
+    const uint32_t* col_idx = columnIndices();
+    const double* v = values();
+    for(uint64_t k = row_ptr[i]; k < row_ptr[i+1]; k++){
+        row[col_idx[k]] += v[k];
+    }
+}
+
+//既存のソルバーが受け取る拡大係数行列(方程式数)*(変数数+1)に変換する
+inline std::vector<std::vector<long double> > MatrixFile::toAugmentedMatrix(){
+    std::vector<std::vector<long double> > matrix(header.rows, std::vector<long double>(header.cols + 1, 0));
+    std::vector<double> row(header.cols);
+    for(uint64_t i = 0; i < header.rows; i++){
+        getRow(i, row.data());
+        for(uint64_t j = 0; j < header.cols; j++){
+            matrix.at(i).at(j) = row.at(j);
+        }
+        matrix.at(i).at(header.cols) = hasRhs() ? rhs()[i] : 0;
+    }
+    return matrix;
+}
+
+
+//コンストラクター
+inline MatrixParser::MatrixParser(int threads){
+    this->threads = std::max(1, threads);
+}
+
+inline const char* MatrixParser::skipSpace(const char* p, const char* end){
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == ',')){
+        p++;
+    }
+    return p;
+}
+
+inline const char* MatrixParser::nextLine(const char* p, const char* end){
+    const char* nl = (const char*)memchr(p, '\n', end - p);
+    return nl == NULL ? end : nl + 1;
+}
+
+//数値を1つ読む。読めなければNULLを返す
+inline const char* MatrixParser::parseNumber(const char* p, const char* end, double& value){
+    p = skipSpace(p, end);
+    if(p < end && *p == '+'){
+        p++;
+    }
+    std::from_chars_result r = std::from_chars(p, end, value);
+    return r.ec == std::errc() ? r.ptr : NULL;
+}
+
+//[begin, length)を行の切れ目でスレッド数に分割する
+inline std::vector<std::pair<size_t, size_t> > MatrixParser::splitLines(size_t begin){
+    std::vector<std::pair<size_t, size_t> > chunks;
+    size_t chunk = (length - begin) / threads + 1;
+    size_t start = begin;
+    for(int t = 0; t < threads && start < length; t++){
+        size_t stop = std::min(length, start + chunk);
+        stop = nextLine(text + stop - (stop > start ? 1 : 0), text + length) - text;
+        chunks.push_back(std::make_pair(start, stop));
+        start = stop;
+    }
+    return chunks;
+}
+
+inline bool MatrixParser::parse(std::string path, MatrixData& data){
+    if(matrixFile::endsWith(path, ".csv")){
+        return parseCSV(path, data);
+    }
+    return parseMatrixMarket(path, data);
+}
+
+namespace matrixFile{
+    //テキストファイルをmmapしてから関数fを呼ぶ
+    template<class F>
+    inline bool withMappedText(std::string path, F f){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if(fd < 0 || fstat(fd, &st) != 0){
+            std::cerr << "error : ファイルを開けません: " << path << std::endl;
+            if(fd >= 0){
+                close(fd);
+            }
+            return false;
+        }
+        if(st.st_size == 0){
+            close(fd);
+            std::cerr << "error : ファイルが空です: " << path << std::endl;
+            return false;
+        }
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED){
+            close(fd);
+            std::cerr << "error : mmapに失敗しました: " << path << std::endl;
+            return false;
+        }
+        madvise(p, st.st_size, MADV_SEQUENTIAL);
+        bool ok = f((const char*)p, (size_t)st.st_size);
+        munmap(p, st.st_size);
+        close(fd);
+        return ok;
+    }
+}
+
+inline bool MatrixParser::parseMatrixMarket(std::string path, MatrixData& data){
+    return matrixFile::withMappedText(path, [&](const char* t, size_t len){
+        text = t;
+        length = len;
+        const char* end = text + length;
+
+        //ヘッダー行 %%MatrixMarket matrix <coordinate|array> <real|integer|pattern> <general|symmetric|skew-symmetric>
+        const char* p = text;
+        const char* eol = nextLine(p, end);
+        std::string banner(p, eol);
+        std::transform(banner.begin(), banner.end(), banner.begin(), ::tolower);
+        if(banner.compare(0, 14, "%%matrixmarket") != 0){
+            std::cerr << "error : Matrix Market形式ではありません: " << path << std::endl;
+            return false;
+        }
+        std::vector<std::string> fields;
+        std::istringstream words(banner);
+        for(std::string w; words >> w;){
+            fields.push_back(w);
+        }
+        if(fields.size() < 5 || fields.at(1) != "matrix" || (fields.at(2) != "coordinate" && fields.at(2) != "array")){
+            std::cerr << "error : Matrix Marketのヘッダー行を読めません: " << path << std::endl;
+            return false;
+        }
+        if(fields.at(3) == "complex"){
+            std::cerr << "error : 複素数の行列には対応していません" << std::endl;
+            return false;
+        }
+        if(fields.at(3) != "real" && fields.at(3) != "integer" && fields.at(3) != "pattern"){
+            std::cerr << "error : 対応していない数値の種類です: " << fields.at(3) << std::endl;
+            return false;
+        }
+        if(fields.at(4) != "general" && fields.at(4) != "symmetric" && fields.at(4) != "skew-symmetric"){
+            std::cerr << "error : 対応していない対称性です: " << fields.at(4) << std::endl;
+            return false;
+        }
+        bool coordinate = fields.at(2) == "coordinate";
+        bool pattern    = fields.at(3) == "pattern";
+        bool symmetric  = fields.at(4) != "general"; //下三角だけが格納されている
+        double mirror   = fields.at(4) == "skew-symmetric" ? -1 : 1; //上三角に写すときの符号
+        if(pattern && mirror < 0){
+            std::cerr << "error : patternのskew-symmetricは値を決められません" << std::endl;
+            return false;
+        }
+
+        //コメントを飛ばしてサイズ行を読む
+        p = eol;
+        while(p < end && (*p == '%' || skipSpace(p, end) == end || *skipSpace(p, end) == '\n')){
+            p = nextLine(p, end);
+        }
+        double size[3] = {0, 0, 0};
+        const char* q = p;
+        for(int k = 0; k < (coordinate ? 3 : 2); k++){
+            q = q == NULL ? NULL : parseNumber(q, end, size[k]);
+        }
+        if(q == NULL){
+            std::cerr << "error : サイズ行を読めません" << std::endl;
+            return false;
+        }
+        data.rows = (uint64_t)size[0];
+        data.cols = (uint64_t)size[1];
+        size_t body = nextLine(p, end) - text;
+
+        //各スレッドが担当範囲の数値を読む
+        std::vector<std::pair<size_t, size_t> > chunks = splitLines(body);
+        int T = chunks.size();
+        std::vector<std::vector<uint32_t> > local_rows(T), local_cols(T);
+        std::vector<std::vector<double> > local_values(T);
+        std::vector<uint64_t> entries(T, 0); //ファイルに書かれていた要素の数(写した分を除く)
+        std::vector<char> failed(T, 0);
+        std::vector<std::thread> workers;
+        for(int t = 0; t < T; t++){
+            workers.push_back(std::thread([&, t](){
+                const char* p = text + chunks.at(t).first;
+                const char* stop = text + chunks.at(t).second;
+                while(p < stop){
+                    const char* s = skipSpace(p, stop);
+                    if(s >= stop || *s == '\n' || *s == '%'){
+                        p = nextLine(s, stop);
+                        continue;
+                    }
+                    if(coordinate){
+                        double i, j, v = 1;
+                        s = parseNumber(s, stop, i);
+                        s = s == NULL ? NULL : parseNumber(s, stop, j);
+                        if(s != NULL && !pattern){
+                            s = parseNumber(s, stop, v);
+                        }
+                        if(s == NULL || i < 1 || j < 1 || i > data.rows || j > data.cols){
+                            failed.at(t) = 1;
+                            return;
+                        }
+                        local_rows.at(t).push_back((uint32_t)i - 1);
+                        local_cols.at(t).push_back((uint32_t)j - 1);
+                        local_values.at(t).push_back(v);
+                        if(symmetric && i != j){
+                            local_rows.at(t).push_back((uint32_t)j - 1);
+                            local_cols.at(t).push_back((uint32_t)i - 1);
+                            local_values.at(t).push_back(mirror * v);
+                        }
+                        entries.at(t)++;
+                    }else{
+                        double v;
+                        s = parseNumber(s, stop, v);
+                        if(s == NULL){
+                            failed.at(t) = 1;
+                            return;
+                        }
+                        local_values.at(t).push_back(v);
+                        entries.at(t)++;
+                    }
+                    p = nextLine(s, stop);
+                }
+            }));
+        }
+        for(std::thread& w : workers){
+            w.join();
+        }
+        if(std::find(failed.begin(), failed.end(), 1) != failed.end()){
+            std::cerr << "error : 数値を読めない行があります: " << path << std::endl;
+            return false;
+        }
+        //サイズ行の要素数(array形式は格納される三角部分の大きさ)と実際の数を比べる
+        uint64_t expected = (uint64_t)size[2];
+        if(!coordinate){
+            uint64_t n = data.cols;
+            expected = !symmetric ? data.rows * data.cols : mirror > 0 ? n * (n + 1) / 2 : n * (n - 1) / 2;
+        }
+        uint64_t amount = 0;
+        for(uint64_t e : entries){
+            amount += e;
+        }
+        if(amount != expected){
+            std::cerr << "error : 要素数が合いません(" << expected << " 個のはずが " << amount << " 個): " << path << std::endl;
+            return false;
+        }
+        if(symmetric && data.rows != data.cols){
+            std::cerr << "error : 対称な行列が正方行列ではありません: " << path << std::endl;
+            return false;
+        }
+
+        if(!coordinate){
+            //array形式は列優先なので行優先に並べ替える(symmetricは対角を含む下三角、skew-symmetricは対角を除く下三角のみ格納)
+            std::vector<double> column_major;
+            for(std::vector<double>& v : local_values){
+                column_major.insert(column_major.end(), v.begin(), v.end());
+            }
+            data.format = matrixFile::DENSE;
+            data.values.assign(data.rows * data.cols, 0);
+            size_t k = 0;
+            for(uint64_t j = 0; j < data.cols; j++){
+                for(uint64_t i = !symmetric ? 0 : mirror > 0 ? j : j + 1; i < data.rows; i++){
+                    if(k >= column_major.size()){
+                        std::cerr << "error : 要素数が足りません: " << path << std::endl;
+                        return false;
+                    }
+                    data.values.at(i * data.cols + j) = column_major.at(k);
+                    if(symmetric){
+                        data.values.at(j * data.cols + i) = mirror * column_major.at(k);
+                    }
+                    k++;
+                }
+            }
+            return true;
+        }
+
+        //coordinate形式はCSRにする。スレッドごとの各行の要素数から書き込み位置を決める
+        data.format = matrixFile::CSR;
+        std::vector<std::vector<uint64_t> > counts(T, std::vector<uint64_t>(data.rows + 1, 0));
+        workers.clear();
+        for(int t = 0; t < T; t++){
+            workers.push_back(std::thread([&, t](){
+                for(uint32_t r : local_rows.at(t)){
+                    counts.at(t).at(r)++;
+                }
+            }));
+        }
+        for(std::thread& w : workers){
+            w.join();
+        }
+        data.row_ptr.assign(data.rows + 1, 0);
+        uint64_t position = 0;
+        for(uint64_t r = 0; r < data.rows; r++){
+            data.row_ptr.at(r) = position;
+            for(int t = 0; t < T; t++){
+                uint64_t c = counts.at(t).at(r);
+                counts.at(t).at(r) = position; //スレッドtが行rを書き始める位置
+                position += c;
+            }
+        }
+        data.row_ptr.at(data.rows) = position;
+        data.values.resize(position);
+        data.col_idx.resize(position);
+        workers.clear();
+        for(int t = 0; t < T; t++){
+            workers.push_back(std::thread([&, t](){
+                for(size_t k = 0; k < local_rows.at(t).size(); k++){
+                    uint64_t at = counts.at(t).at(local_rows.at(t).at(k))++;
+                    data.col_idx.at(at) = local_cols.at(t).at(k);
+                    data.values.at(at) = local_values.at(t).at(k);
+                }
+            }));
+        }
+        for(std::thread& w : workers){
+            w.join();
+        }
+
+        //各行の中を列番号順に整列する
+        workers.clear();
+        for(int t = 0; t < T; t++){
+            workers.push_back(std::thread([&, t](){
+                std::vector<std::pair<uint32_t, double> > row;
+                for(uint64_t r = t; r < data.rows; r += T){
+                    row.clear();
+                    for(uint64_t k = data.row_ptr.at(r); k < data.row_ptr.at(r+1); k++){
+                        row.push_back(std::make_pair(data.col_idx.at(k), data.values.at(k)));
+                    }
+                    std::sort(row.begin(), row.end());
+                    for(size_t k = 0; k < row.size(); k++){
+                        data.col_idx.at(data.row_ptr.at(r) + k) = row.at(k).first;
+                        data.values.at(data.row_ptr.at(r) + k) = row.at(k).second;
+                    }
+                }
+            }));
+        }
+        for(std::thread& w : workers){
+            w.join();
+        }
+        return true;
+    });
+}
+
+inline bool MatrixParser::parseCSV(std::string path, MatrixData& data){
+    return matrixFile::withMappedText(path, [&](const char* t, size_t len){
+        text = t;
+        length = len;
+        std::vector<std::pair<size_t, size_t> > chunks = splitLines(0);
+        int T = chunks.size();
+        std::vector<std::vector<double> > local_values(T);
+        std::vector<std::vector<uint32_t> > local_widths(T); //各行の要素数
+        std::vector<char> failed(T, 0);
+        std::vector<std::thread> workers;
+        for(int t = 0; t < T; t++){
+            workers.push_back(std::thread([&, t](){
+                const char* p = text + chunks.at(t).first;
+                const char* stop = text + chunks.at(t).second;
+                while(p < stop){
+                    const char* eol = nextLine(p, stop);
+                    const char* s = skipSpace(p, eol);
+                    if(s >= eol || *s == '\n' || *s == '#'){
+                        p = eol;
+                        continue;
+                    }
+                    uint32_t width = 0;
+                    while(true){
+                        s = skipSpace(s, eol);
+                        if(s >= eol || *s == '\n'){
+                            break;
+                        }
+                        double v;
+                        s = parseNumber(s, eol, v);
+                        if(s == NULL){
+                            failed.at(t) = 1;
+                            return;
+                        }
+                        local_values.at(t).push_back(v);
+                        width++;
+                    }
+                    local_widths.at(t).push_back(width);
+                    p = eol;
+                }
+            }));
+        }
+        for(std::thread& w : workers){
+            w.join();
+        }
+        if(std::find(failed.begin(), failed.end(), 1) != failed.end()){
+            std::cerr << "error : 数値を読めない行があります: " << path << std::endl;
+            return false;
+        }
+
+        uint64_t rows = 0;
+        uint32_t width = 0;
+        for(int t = 0; t < T; t++){
+            for(uint32_t w : local_widths.at(t)){
+                if(width == 0){
+                    width = w;
+                }else if(w != width){
+                    std::cerr << "error : 行ごとの列数が揃っていません: " << path << std::endl;
+                    return false;
+                }
+                rows++;
+            }
+        }
+        bool augmented = (width == rows + 1);
+        data.format = matrixFile::DENSE;
+        data.rows = rows;
+        data.cols = augmented ? rows : width;
+        data.values.clear();
+        data.values.reserve(data.rows * data.cols);
+        data.rhs.clear();
+        for(int t = 0; t < T; t++){
+            std::vector<double>& v = local_values.at(t);
+            for(size_t k = 0; k < v.size(); k += width){
+                data.values.insert(data.values.end(), v.begin() + k, v.begin() + k + data.cols);
+                if(augmented){
+                    data.rhs.push_back(v.at(k + width - 1));
+                }
+            }
+        }
+        return true;
+    });
+}
+
+
+//拡張子に関わらずバイナリ形式ならmmap、そうでなければテキストとして解析し、
+//既存ソルバー用の拡大係数行列を返す
+inline bool loadAugmentedMatrix(std::string path, int& variable_amount, std::vector<std::vector<long double> >& coefficient_matrix){
+    char magic[8] = {0};
+    FILE* fp = fopen(path.c_str(), "rb");
+    if(fp == NULL){
+        std::cerr << "error : ファイルを開けません: " << path << std::endl;
+        return false;
+    }
+    size_t got = fread(magic, 1, sizeof(magic), fp);
+    fclose(fp);
+
+    if(got == sizeof(magic) && memcmp(magic, matrixFile::MAGIC, sizeof(magic)) == 0){
+        MatrixFile file;
+        if(!file.open(path)){
+            return false;
+        }
+        if(file.rows() != file.cols()){
+            std::cerr << "error : 正方行列ではありません" << std::endl;
+            return false;
+        }
+        variable_amount = file.rows();
+        coefficient_matrix = file.toAugmentedMatrix();
+        return true;
+    }
+
+    MatrixData data;
+    MatrixParser parser;
+    if(!parser.parse(path, data)){
+        return false;
+    }
+    if(data.rows != data.cols){
+        std::cerr << "error : 正方行列ではありません" << std::endl;
+        return false;
+    }
+    variable_amount = data.rows;
+    coefficient_matrix.assign(data.rows, std::vector<long double>(data.cols + 1, 0));
+    for(uint64_t i = 0; i < data.rows; i++){
+        if(data.format == matrixFile::DENSE){
+            for(uint64_t j = 0; j < data.cols; j++){
+                coefficient_matrix.at(i).at(j) = data.values.at(i * data.cols + j);
+            }
+        }else{
+            for(uint64_t k = data.row_ptr.at(i); k < data.row_ptr.at(i+1); k++){
+                coefficient_matrix.at(i).at(data.col_idx.at(k)) += data.values.at(k);
+            }
+        }
+        coefficient_matrix.at(i).at(data.cols) = data.rhs.empty() ? 0 : data.rhs.at(i);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include<vector>
+#include<chrono>
+#include"multiNewton.h"
+
+int main(int argc, char* argv[]){
+    const char* names[] = {"NEWTON", "SHAMANSKII", "BROYDEN"};
+    multiNewton::Method methods[] = {multiNewton::NEWTON, multiNewton::SHAMANSKII, multiNewton::BROYDEN};
+
+    //円と直線の交点: x^2 + y^2 = 4, x = y
+    auto circle = [](const auto& x){
+        return std::vector{x[0] * x[0] + x[1] * x[1] - 4, x[0] - x[1]};
+    };
+    MultiNewton solver(2, circle, multiNewton::NEWTON);
+    std::vector<long double> x = solver.run({1, 0.5});
+    printf("x^2 + y^2 = 4, x = y の解 = (%.15Lf, %.15Lf) (%d回)\n", x.at(0), x.at(1), solver.getLoopCount());
+
+    //Broydenの三重対角問題: (3 - 2x_i)x_i - x_{i-1} - 2x_{i+1} + 1 = 0 (x_0 = x_{n+1} = 0)
+    int variable_amount = argc > 1 ? atoi(argv[1]) : 100;
+    auto tridiagonal = [variable_amount](const auto& x){
+        auto f = x;
+        for(int i = 0; i < variable_amount; i++){
+            f[i] = (3 - 2 * x[i]) * x[i] + 1;
+            if(i > 0){
+                f[i] = f[i] - x[i - 1];
+            }
+            if(i + 1 < variable_amount){
+                f[i] = f[i] - 2 * x[i + 1];
+            }
+        }
+        return f;
+    };
+    //ヤコビ行列は三重対角なので手で与える(自動微分だとFをn回評価する)
+    auto jacobian = [variable_amount](const std::vector<long double>& x){
+        std::vector<std::vector<long double> > J(variable_amount, std::vector<long double>(variable_amount, 0));
+        for(int i = 0; i < variable_amount; i++){
+            J[i][i] = 3 - 4 * x[i];
+            if(i > 0){
+                J[i][i - 1] = -1;
+            }
+            if(i + 1 < variable_amount){
+                J[i][i + 1] = -2;
+            }
+        }
+        return J;
+    };
+    printf("Broydenの三重対角問題 (n = %d)\n", variable_amount);
+    for(int m = 0; m < 3; m++){
+        for(int automatic = 0; automatic < 2; automatic++){
+            MultiNewton problem(variable_amount, tridiagonal, methods[m]);
+            if(!automatic){
+                problem.setJacobian(jacobian);
+            }
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            std::vector<long double> answer = problem.run(std::vector<long double>(variable_amount, -1));
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::vector<long double> residual = tridiagonal(answer);
+            printf("%-10s (%s): 反復 %3d 回, F評価 %5d 回, LU分解 %2d 回, |F| = %.3Le, %s, %.4f 秒\n",
+                names[m], automatic ? "自動微分" : "ヤコビ行列", problem.getLoopCount(), problem.getEvaluations(),
+                problem.getFactorizations(), multiNewton::norm(residual), problem.isConverged() ? "収束" : "未収束", elapsed);
+        }
+    }
+
+    return 0;
+}
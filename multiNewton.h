@@ -0,0 +1,282 @@
+#ifndef MULTI_NEWTON_H
+#define MULTI_NEWTON_H
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <functional>
+#include <utility>
+#include "dual.h"
+
+/* --- --- 多変数のニュートン法 --- ---
+連立非線形方程式 F(x) = 0 を J(x_k) s_k = -F(x_k), x_{k+1} = x_k + s_k で解く。
+ヤコビ行列Jの分解(部分ピボット選択付きのLU分解, O(n^3))が1回の更新で最も重いので、分解を使い回す方法を選べる。
+(方程式の並べ方でJの対角が0になっても解けるように、各列で絶対値が最大の行をピボットにする)
+・NEWTON     : 毎回ヤコビ行列を作り直して分解する(2次収束)
+・SHAMANSKII : 分解をREUSE回まで使い回す(REUSE = ∞ なら簡易ニュートン法(chord法))
+・BROYDEN    : 分解したJ_0のまま、ステップsからBroydenのランク1更新を積み重ねる(超一次収束)
+                 z = -J_0^{-1} F(x_{k+1})
+                 z ← z + s_{j+1} (s_j・z)/|s_j|^2  (j = 0, ..., k-1)
+                 s_{k+1} = z / (1 - (s_k・z)/|s_k|^2)
+               (更新はO(n k)で済み、行列を持たない)
+SHAMANSKIIとBROYDENでは |F(x_{k+1})| > RATE*|F(x_k)| となり収束が鈍ったときだけ、その点で分解し直す。
+ヤコビ行列は setJacobian で与えた関数で求め、与えなければ二重数(dual.h)で1列ずつ自動微分する。
+Fは引数の型を決め打ちせずに書く。例: [](const auto& x){ return std::vector{x[0]*x[0] + x[1]*x[1] - 4, x[0] - x[1]}; }
+--- --- --- --- */
+namespace multiNewton{
+    enum Method{
+        NEWTON,
+        SHAMANSKII,
+        BROYDEN
+    };
+    inline long double EPSILON = 1e-12; //|F(x)| <= EPSILON または |s| <= EPSILON*|x| で終了
+    inline int MAX_ITERATION = 100; //最大繰り返し回数
+    inline int REUSE = 4; //SHAMANSKIIで1つの分解を使う回数
+    inline int BROYDEN_LIMIT = 20; //BROYDENで積み重ねる更新の最大数(超えたら分解し直す)
+    inline long double RATE = 0.5; //|F|の減り方がこれより悪ければ分解し直す
+
+    inline long double norm(const std::vector<long double>& v){
+        long double s = 0;
+        for(long double x : v){
+            s += x * x;
+        }
+        return sqrtl(s);
+    }
+
+    inline long double dot(const std::vector<long double>& a, const std::vector<long double>& b){
+        long double s = 0;
+        for(size_t i = 0; i < a.size(); i++){
+            s += a[i] * b[i];
+        }
+        return s;
+    }
+}
+
+template<class F> class MultiNewton{
+private:
+    int variable_amount; //変数数=方程式数
+    F function;
+    std::function<std::vector<std::vector<long double> >(const std::vector<long double>&)> jacobian; //空なら自動微分
+    multiNewton::Method method;
+    std::vector<long double> factor; //PJ = LU を1つの n*n 配列(行優先)に詰めたもの(Lの対角は1で持たない)
+    std::vector<int> permutation; //分解後のi行目が元のJの何行目か
+    int loop_count = 0;
+    int evaluations = 0; //Fの評価回数(自動微分の列ごとの評価も含む)
+    int factorizations = 0; //LU分解の回数
+    bool converged = false;
+    std::vector<long double> evaluate(const std::vector<long double>& x);
+    std::vector<std::vector<long double> > jacobianAt(const std::vector<long double>& x);
+    bool factorize(const std::vector<long double>& x);
+    std::vector<long double> solveFactor(const std::vector<long double>& f); //-J^{-1} f
+public:
+    MultiNewton(int variable_amount, F function, multiNewton::Method method = multiNewton::SHAMANSKII);//コンストラクター
+    void setJacobian(std::function<std::vector<std::vector<long double> >(const std::vector<long double>&)> jacobian);
+    std::vector<long double> run(std::vector<long double> x);
+    int getLoopCount();
+    int getEvaluations();
+    int getFactorizations();
+    bool isConverged();
+};
+
+
+//コンストラクター
+template<class F> inline MultiNewton<F>::MultiNewton(int variable_amount, F function, multiNewton::Method method) : function(function){
+    this->variable_amount = variable_amount;
+    this->method = method;
+}
+
+template<class F> inline void MultiNewton<F>::setJacobian(std::function<std::vector<std::vector<long double> >(const std::vector<long double>&)> jacobian){
+    this->jacobian = jacobian;
+}
+
+template<class F> inline std::vector<long double> MultiNewton<F>::evaluate(const std::vector<long double>& x){
+    evaluations++;
+    return function(x);
+}
+
+//ヤコビ行列 J_ij = ∂F_i/∂x_j
+template<class F> inline std::vector<std::vector<long double> > MultiNewton<F>::jacobianAt(const std::vector<long double>& x){
+    if(jacobian){
+        return jacobian(x);
+    }
+    //x_jの微分係数を1にして1回評価するとj列目が求まる
+    std::vector<std::vector<long double> > J(variable_amount, std::vector<long double>(variable_amount, 0));
+    std::vector<Dual<long double> > dx(variable_amount);
+    for(int j = 0; j < variable_amount; j++){
+        for(int k = 0; k < variable_amount; k++){
+            dx[k] = Dual<long double>(x[k], k == j ? 1 : 0);
+        }
+        std::vector<Dual<long double> > df = function(dx);
+        evaluations++;
+        for(int i = 0; i < variable_amount; i++){
+            J[i][j] = df.at(i).derivative;
+        }
+    }
+    return J;
+}
+
+//xでのヤコビ行列を部分ピボット選択付きでLU分解する(配列は2回目以降確保し直さない)
+template<class F> inline bool MultiNewton<F>::factorize(const std::vector<long double>& x){
+    std::vector<std::vector<long double> > J = jacobianAt(x);
+    int n = variable_amount;
+    factor.resize((size_t)n * n);
+    permutation.resize(n);
+    for(int i = 0; i < n; i++){
+        std::copy(J.at(i).begin(), J.at(i).begin() + n, factor.begin() + (size_t)i * n);
+        permutation[i] = i;
+    }
+    factorizations++;
+    for(int k = 0; k < n; k++){
+        int pivot = k;
+        for(int i = k + 1; i < n; i++){
+            if(fabsl(factor[(size_t)i * n + k]) > fabsl(factor[(size_t)pivot * n + k])){
+                pivot = i;
+            }
+        }
+        long double diagonal = factor[(size_t)pivot * n + k];
+        if(diagonal == 0 || !std::isfinite(diagonal)){
+            std::cerr << "error : ヤコビ行列が特異です(ピボットが0)" << std::endl;
+            return false;
+        }
+        if(pivot != k){
+            std::swap_ranges(factor.begin() + (size_t)k * n, factor.begin() + (size_t)(k + 1) * n, factor.begin() + (size_t)pivot * n);
+            std::swap(permutation[k], permutation[pivot]);
+        }
+        for(int i = k + 1; i < n; i++){
+            long double* row = &factor[(size_t)i * n];
+            const long double* pivot_row = &factor[(size_t)k * n];
+            long double l = row[k] / diagonal;
+            row[k] = l;
+            for(int j = k + 1; j < n; j++){
+                row[j] -= l * pivot_row[j];
+            }
+        }
+    }
+    return true;
+}
+
+// -J^{-1} f (Ly = Pf, Us = y)
+template<class F> inline std::vector<long double> MultiNewton<F>::solveFactor(const std::vector<long double>& f){
+    int n = variable_amount;
+    std::vector<long double> s(n);
+    for(int i = 0; i < n; i++){
+        long double v = f.at(permutation[i]);
+        const long double* row = &factor[(size_t)i * n];
+        for(int j = 0; j < i; j++){
+            v -= row[j] * s[j];
+        }
+        s[i] = v;
+    }
+    for(int i = n - 1; i >= 0; i--){
+        long double v = s[i];
+        const long double* row = &factor[(size_t)i * n];
+        for(int j = i + 1; j < n; j++){
+            v -= row[j] * s[j];
+        }
+        s[i] = v / row[i];
+    }
+    for(long double& v : s){
+        v = -v;
+    }
+    return s;
+}
+
+//ニュートン法の実行(xは初期値)
+template<class F> inline std::vector<long double> MultiNewton<F>::run(std::vector<long double> x){
+    loop_count = 0;
+    evaluations = 0;
+    factorizations = 0;
+    converged = false;
+    std::vector<long double> f = evaluate(x);
+    long double f_norm = multiNewton::norm(f);
+    bool refresh = true; //次の更新の前に分解し直す
+    int uses = 0; //今の分解を使った回数
+    std::vector<std::vector<long double> > steps; //BROYDEN: 今の分解からのステップ s_0, s_1, ...
+    std::vector<long double> s;
+
+    for(loop_count = 0; loop_count < multiNewton::MAX_ITERATION; loop_count++){
+        if(f_norm <= multiNewton::EPSILON){
+            converged = true;
+            return x;
+        }
+        if(method == multiNewton::NEWTON || (method == multiNewton::SHAMANSKII && uses >= multiNewton::REUSE)
+            || (method == multiNewton::BROYDEN && (int)steps.size() >= multiNewton::BROYDEN_LIMIT)){
+            refresh = true;
+        }
+        if(refresh){
+            if(!factorize(x)){
+                return x;
+            }
+            refresh = false;
+            uses = 0;
+            steps.clear();
+        }
+        uses++;
+
+        //ステップを求める
+        s = solveFactor(f);
+        if(method == multiNewton::BROYDEN && !steps.empty()){
+            std::vector<long double>& z = s;
+            size_t k = steps.size() - 1;
+            for(size_t j = 0; j < k; j++){
+                long double c = multiNewton::dot(steps[j], z) / multiNewton::dot(steps[j], steps[j]);
+                for(int i = 0; i < variable_amount; i++){
+                    z[i] += c * steps[j + 1][i];
+                }
+            }
+            long double denominator = 1 - multiNewton::dot(steps[k], z) / multiNewton::dot(steps[k], steps[k]);
+            if(fabsl(denominator) < 1e-12L){ //更新が退化した: 分解し直してやり直す
+                refresh = true;
+                loop_count--;
+                continue;
+            }
+            for(long double& v : z){
+                v /= denominator;
+            }
+        }
+        for(int i = 0; i < variable_amount; i++){
+            x[i] += s[i];
+        }
+        if(method == multiNewton::BROYDEN){
+            steps.push_back(s);
+        }
+
+        std::vector<long double> next_f = evaluate(x);
+        long double next_norm = multiNewton::norm(next_f);
+        if(next_norm > multiNewton::RATE * f_norm){ //収束が鈍った: 次は今の点で分解し直す
+            refresh = true;
+        }
+        f = next_f;
+        f_norm = next_norm;
+        if(multiNewton::norm(s) <= multiNewton::EPSILON * fmaxl(1, multiNewton::norm(x))){
+            converged = f_norm <= sqrtl(multiNewton::EPSILON);
+            loop_count++;
+            return x;
+        }
+    }
+    converged = f_norm <= multiNewton::EPSILON;
+    if(!converged){
+        std::cerr << "error : 繰り返し回数が上限に達しました" << std::endl;
+    }
+    return x;
+}
+
+template<class F> inline int MultiNewton<F>::getLoopCount(){
+    return loop_count;
+}
+
+template<class F> inline int MultiNewton<F>::getEvaluations(){
+    return evaluations;
+}
+
+template<class F> inline int MultiNewton<F>::getFactorizations(){
+    return factorizations;
+}
+
+template<class F> inline bool MultiNewton<F>::isConverged(){
+    return converged;
+}
+
+#endif
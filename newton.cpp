@@ -1,101 +1,12 @@
 #include<stdio.h>
+#include<stdlib.h>
 #include<iostream>
 #include<vector>
+#include<chrono>
+#include<random>
+#include"newton.h"
 
-namespace newton{
-    const int ROOT = 0; // 関数の解(X軸の位置)
-    const long double EPSILON = 0.0001; //許容誤差範囲
-    const int ETERNAL_ROOP_LIMIT = 100000000; //再帰還数(ニュートン法の実行メソッド)の最大ループ回数
-}
-
-
-class Newton{
-private:
-    int division; //関数の次元
-    std::vector<int> coefficients; //係数行列(昇べきの順)
-public:
-    void set(int division, std::vector<int> coefficients);
-    void printFunction(); //関数表示用メソッド
-    long double function(long double x);
-    long double differentiatedFunction(long double x);
-    long double run(long double a, int roop_counter);
-};
-
-//コンストラクター
-void Newton::set(int division, std::vector<int> coefficients){
-    this->division = division;
-    this->coefficients = coefficients;
-}
-
-//保持している情報から関数の多項式表示
-void Newton::printFunction(){
-    printf("f(x) = ");
-    for(int d = division; d >= 0; d--){
-        int c = coefficients.at(d);
-        if(c == 0){
-            continue;
-        }else if(c > 0 && d != division){
-            printf(" + ");
-        }else if(c < 0 && d != division){
-            printf(" - ");
-        }
-        
-        if(c == 1){
-            printf("x^%d", d);
-        }else if(d == 0){
-            printf("%d", abs(c));
-        }else{
-            printf("%dx^%d", abs(c), d);
-        }
-    }
-    printf("\n");
-}
-
-//関数から値を返す
-long double Newton::function(long double x){
-    long double result = 0;
-    long double weight = 1.0;
-    for(int c : coefficients){
-        result += c * weight;
-        weight *= x;
-    }
-    return result;
-}
-
-//導関数の値を返す
-long double Newton::differentiatedFunction(long double x){
-    long double result = 0;
-    long double weight = 1.0;
-    int dc = 1; //微分で増える各項の係数値
-    for(int i = 1; i <= division; i++){
-        dc = i;
-        result += coefficients.at(i) * dc * weight;
-        weight *= x;
-    }
-    return result;
-}
-
-//Newton法の実行
-long double Newton::run(long double a, int roop_counter){
-    if(roop_counter > newton::ETERNAL_ROOP_LIMIT){ // 再帰上限
-        std::cerr << "error : 再帰回数が上限に達しました" << std::endl;
-        return 0;
-    }
-
-    long double b = a - Newton::function(a)/Newton::differentiatedFunction(a); //aの接線とx軸との交点
-    long double r = a - b; //区間の差
-    r = r > 0 ? r : -r; //絶対値
-    // debug log(begin) ----
-    std::cerr << "(a, b) = " << "(" << a << ", " << b << ")" << std::endl;
-    // ---- debug log(end)
-    if(r < newton::EPSILON){ //誤差EPSILON以下は終了
-        return b;
-    }else{
-        return Newton::run(b, roop_counter+1);
-    }
-}
-
-int main(){
+int main(int argc, char* argv[]){
     //関数の指定
     int division = 2; //関数の次元
     int org_data[] = {-2, 0, 1}; //初期値用係数行列(昇べきの順)
@@ -106,13 +17,70 @@ int main(){
 
     // 始点の指定
     long double a = 1000; //区間の下限
-    
+
     //関数作成
-    Newton fx; 
+    Newton fx;
     fx.set(division, coefficients);
 
     fx.printFunction();
     printf("近似解 = %Lf\n", fx.run(a, 0));
 
+    //更新式ごとの反復回数と評価回数(関数と導関数の値の数)
+    const char* names[] = {"Newton", "Halley", "Householder"};
+    newton::Method methods[] = {newton::NEWTON, newton::HALLEY, newton::HOUSEHOLDER};
+    for(int m = 0; m < 3; m++){
+        fx.setMethod(methods[m]);
+        long double root = fx.run(a, 0);
+        printf("%-11s: 近似解 = %.12Lf, 反復 %2d 回, 評価 %3lld 回\n", names[m], root, fx.getLoopCount(), fx.getEvaluations());
+    }
+
+    //任意の関数: cos(x) = x (導関数は二重数で自動的に求まる)
+    NewtonSolver cosine([](auto x){ return cos(x) - x; });
+    long double x = cosine.run(1, 1e-15L);
+    printf("cos(x) = x の近似解 = %.15Lf (%d回)\n", x, cosine.getLoopCount());
+    for(int m = 0; m < 3; m++){
+        NewtonSolver tangent([](auto x){ return exp(x) - 10 * x - 3; }, methods[m]);
+        x = tangent.run(20, 1e-15L);
+        printf("e^x = 10x + 3 (%-11s): 近似解 = %.15Lf, 反復 %2d 回, 評価 %3lld 回\n", names[m], x, tangent.getLoopCount(), tangent.getEvaluations());
+    }
+
+    //一括実行: (x-1)(x-2)(x-3)(x+4) を[-10, 10]の等間隔の始点から解く
+    ThreadPool pool;
+    NewtonBatch batch(&pool);
+    std::vector<double> starts;
+    for(int i = 0; i <= 200; i++){
+        starts.push_back(-10 + 0.1 * i);
+    }
+    std::vector<std::vector<double> > roots = batch.run({{-24, 38, -13, -2, 1}, {-2, 0, 1}}, {starts});
+    for(size_t i = 0; i < roots.size(); i++){
+        printf("多項式%zu の解:", i);
+        for(double r : roots.at(i)){
+            printf(" %.12f", r);
+        }
+        printf("\n");
+    }
+
+    //多数のパラメータ x^3 + p x + q (p, qは乱数) を解いて速度を測る
+    int polynomial_amount = argc > 1 ? atoi(argv[1]) : 100000;
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> distribution(-5, 5);
+    std::vector<std::vector<double> > polynomials(polynomial_amount);
+    for(std::vector<double>& p : polynomials){
+        p = {distribution(random), distribution(random), 0, 1};
+    }
+    for(int m = 0; m < 2; m++){
+        NewtonBatch many(&pool);
+        many.setMethod(methods[m]);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        roots = many.run(polynomials, {{-4, -1, 0, 1, 4}});
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t found = 0;
+        for(std::vector<double>& r : roots){
+            found += r.size();
+        }
+        printf("%s: 多項式 %d 個, 解 %zu 個, 収束 %lld, 失敗 %lld, 反復 %lld 回, %.3f 秒 (%d スレッド)\n", names[m],
+            polynomial_amount, found, many.getConverged(), many.getFailed(), many.getIterations(), elapsed, pool.size());
+    }
+
     return 0;
 }
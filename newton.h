@@ -0,0 +1,434 @@
+#ifndef NEWTON_H
+#define NEWTON_H
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include<iostream>
+#include<vector>
+#include<algorithm>
+#include<atomic>
+#include"threadPool.h"
+#include"horner.h"
+#include"dual.h"
+#include"trace.h"
+
+namespace newton{
+    const int ROOT = 0; // 関数の解(X軸の位置)
+    const long double EPSILON = 0.0001; //許容誤差範囲
+    const int ETERNAL_ROOP_LIMIT = 100000000; //ニュートン法の実行メソッドの最大ループ回数
+
+    //更新式(値は使う導関数の階数。収束の次数はこれに1を足したもの)
+    enum Method{
+        NEWTON = 1,     //x - f/f'                                          (2次収束)
+        HALLEY = 2,     //x - 2ff'/(2f'^2 - ff'')                            (3次収束)
+        HOUSEHOLDER = 3 //x - 6f(f'^2 - ff''/2)/(6f'^3 - 6ff'f'' + f^2f''') (4次収束)
+    };
+
+    const int BATCH_CHUNK = 1024; //1つの仕事で扱う始点の数
+    inline double BATCH_EPSILON = 1e-12; //一括実行での収束判定(|Δx| <= BATCH_EPSILON*max(1,|x|))
+    inline int BATCH_MAX_ITERATION = 200; //一括実行での1始点あたりの最大反復回数
+    inline double ROOT_TOLERANCE = 1e-8; //この相対距離より近い解は同じ解とみなす
+    //収束とみなす残差の上限。多項式は |p(x)| / ∑|a_k|max(1,|x|)^k、任意の関数は |f(x)| / max(1, |f(始点)|)
+    //(停留点の近くでは補正量が小さくなるので、補正量だけでは解でない点を収束とみなしてしまう)
+    inline long double RESIDUAL_TOLERANCE = 1e-6;
+
+    //テイラー係数 t[k] = f^(k)(x)/k! からの補正量(x_{k+1} = x_k - correction)
+    //Householder法の x - d (1/f)^(d-1)/(1/f)^(d) を d = 1, 2, 3 について展開したもの
+    inline long double correction(const long double* t, Method method){
+        switch(method){
+            case HALLEY:
+                return t[0] * t[1] / (t[1] * t[1] - t[0] * t[2]);
+            case HOUSEHOLDER:
+                return t[0] * (t[1] * t[1] - t[0] * t[2]) / (t[1] * t[1] * t[1] - 2 * t[0] * t[1] * t[2] + t[0] * t[0] * t[3]);
+            default:
+                return t[0] / t[1];
+        }
+    }
+}
+
+
+class Newton{
+private:
+    int division; //関数の次元
+    std::vector<long double> coefficients; //係数行列(昇べきの順)
+    newton::Method method = newton::NEWTON;
+    int loop_count = 0;
+    long long evaluations = 0; //関数と導関数の値を求めた回数の合計(1回の反復で method + 1 個)
+public:
+    void set(int division, std::vector<int> coefficients);
+    void set(int division, std::vector<long double> coefficients);
+    void setMethod(newton::Method method);
+    void printFunction(); //関数表示用メソッド
+    long double function(long double x);
+    long double differentiatedFunction(long double x);
+    long double run(long double a, int roop_counter);
+    int getLoopCount();
+    long long getEvaluations();
+};
+
+/* --- --- 任意の関数のニュートン法 --- ---
+多項式に限らず、呼び出せる物(ラムダ式など) f の解を求める。
+・関数の型をテンプレート引数にするので、呼び出しはインライン展開され仮想関数の呼び出しも無い
+・導関数は二重数(dual.h)で f(Dual(x, 1)) を1回呼ぶだけで値と同時に求まる(差分近似の余分な呼び出しが無い)
+・HALLEY, HOUSEHOLDERでは入れ子の二重数で f'', f''' まで1回の呼び出しで求める
+fは引数の型を決め打ちせずに書く。例: NewtonSolver solver([](auto x){ return cos(x) - x; });
+--- --- --- --- */
+template<class F> class NewtonSolver{
+private:
+    F function;
+    newton::Method method;
+    int loop_count = 0;
+    long long evaluations = 0; //関数と導関数の値を求めた回数の合計
+    bool converged = false;
+public:
+    NewtonSolver(F function, newton::Method method = newton::NEWTON);//コンストラクター
+    void setMethod(newton::Method method);
+    long double run(long double a, long double epsilon = newton::EPSILON, int max_iteration = newton::ETERNAL_ROOP_LIMIT);
+    int getLoopCount();
+    long long getEvaluations();
+    bool isConverged();
+};
+
+/* --- --- ニュートン法の一括実行 --- ---
+多数の多項式と多数の始点の組に対してニュートン法を行い、見つかった解を多項式ごとに重複を除いて返す。
+・同じ多項式の始点をhorner::LANES個ずつ並べ、p(x)とp'(x)をhorner::evaluateLanesでまとめて計算する
+・収束した(または失敗した)レーンはすぐに次の始点を詰めるので、レーンが空かない
+・setMethod(newton::HALLEY)でp''も同じホーナー法で求めてHalley法にする
+  (レーンの計算はp''までなので、HOUSEHOLDERはHALLEYとして扱う)
+・(多項式, 始点BATCH_CHUNK個)を1つの仕事としてスレッドプールで並列に処理する
+--- --- --- --- */
+class NewtonBatch{
+private:
+    ThreadPool* pool; //NULLなら呼び出したスレッドだけで実行する
+    newton::Method method = newton::NEWTON;
+    std::atomic<long long> iterations; //全レーンの反復回数の合計
+    std::atomic<long long> converged; //収束した始点の数
+    std::atomic<long long> failed; //導関数が0、発散、反復上限、残差が大きいことで止めた始点の数
+    void solveChunk(const std::vector<double>& polynomial, const double* starts, size_t amount, std::vector<double>& roots);
+public:
+    NewtonBatch(ThreadPool* pool = NULL);//コンストラクター
+    void setMethod(newton::Method method);
+    //polynomials: 各多項式の係数(昇べきの順)
+    //starts: 多項式ごとの始点(要素が1つなら全ての多項式で共通の始点とする)
+    std::vector<std::vector<double> > run(const std::vector<std::vector<double> >& polynomials, const std::vector<std::vector<double> >& starts);
+    static std::vector<double> deduplicate(std::vector<double> roots);
+    long long getIterations(); //以下は直前のrunの値
+    long long getConverged();
+    long long getFailed();
+};
+
+
+//コンストラクター
+inline void Newton::set(int division, std::vector<int> coefficients){
+    Newton::set(division, std::vector<long double>(coefficients.begin(), coefficients.end()));
+}
+
+inline void Newton::set(int division, std::vector<long double> coefficients){
+    this->division = division;
+    this->coefficients = coefficients;
+}
+
+inline void Newton::setMethod(newton::Method method){
+    this->method = method;
+}
+
+//保持している情報から関数の多項式表示
+inline void Newton::printFunction(){
+    printf("f(x) = ");
+    for(int d = division; d >= 0; d--){
+        long double c = coefficients.at(d);
+        if(c == 0){
+            continue;
+        }else if(c > 0 && d != division){
+            printf(" + ");
+        }else if(c < 0 && d != division){
+            printf(" - ");
+        }
+
+        if(c == 1){
+            printf("x^%d", d);
+        }else if(d == 0){
+            printf("%Lg", fabsl(c));
+        }else{
+            printf("%Lgx^%d", fabsl(c), d);
+        }
+    }
+    printf("\n");
+}
+
+//関数から値を返す
+inline long double Newton::function(long double x){
+    return horner::evaluate(coefficients.data(), division, x);
+}
+
+//導関数の値を返す
+inline long double Newton::differentiatedFunction(long double x){
+    long double dp;
+    horner::evaluate(coefficients.data(), division, x, &dp);
+    return dp;
+}
+
+//Newton法の実行(roop_counter回目から始める。再帰せずにループで反復する)
+inline long double Newton::run(long double a, int roop_counter){
+    TRACE_SOLVE("newton");
+    loop_count = 0;
+    evaluations = 0;
+    for(; roop_counter <= newton::ETERNAL_ROOP_LIMIT; roop_counter++){
+        long double t[4] = {0, 0, 0, 0};
+        horner::taylor(coefficients.data(), division, a, t, method); //p(a), p'(a), ...を1回のホーナー法で求める
+        loop_count++;
+        evaluations += method + 1;
+        TRACE_COUNT("newton.iterations", 1);
+        TRACE_COUNT("newton.evaluations", method + 1);
+        TRACE_FLOPS(2LL * (method + 1) * division);
+        if(t[1] == 0){ //Halley法などでも補正量が0になり、停留点で止まってしまう
+            std::cerr << "error : 導関数が0になりました" << std::endl;
+            return a;
+        }
+        long double b = a - newton::correction(t, method); //Newton法ならaの接線とx軸との交点
+        if(!std::isfinite(b)){
+            std::cerr << "error : 反復が発散しました" << std::endl;
+            return a;
+        }
+        long double r = a - b; //区間の差
+        r = r > 0 ? r : -r; //絶対値
+        if(r < newton::EPSILON){ //誤差EPSILON以下は終了
+            if(horner::relativeResidual(coefficients.data(), division, b) > newton::RESIDUAL_TOLERANCE){
+                std::cerr << "error : 解でない点で補正量が小さくなりました" << std::endl;
+            }
+            return b;
+        }
+        a = b;
+    }
+    std::cerr << "error : 繰り返し回数が上限に達しました" << std::endl;
+    return 0;
+}
+
+inline int Newton::getLoopCount(){
+    return loop_count;
+}
+
+inline long long Newton::getEvaluations(){
+    return evaluations;
+}
+
+
+//コンストラクター
+template<class F> inline NewtonSolver<F>::NewtonSolver(F function, newton::Method method) : function(function){
+    this->method = method;
+}
+
+template<class F> inline void NewtonSolver<F>::setMethod(newton::Method method){
+    this->method = method;
+}
+
+//Newton法の実行(|Δx| < epsilonで終了)
+template<class F> inline long double NewtonSolver<F>::run(long double a, long double epsilon, int max_iteration){
+    converged = false;
+    evaluations = 0;
+    long double scale = 1; //残差の判定に使う max(1, |f(始点)|)
+    for(loop_count = 0; loop_count < max_iteration; loop_count++){
+        long double t[4] = {0, 0, 0, 0};
+        derivatives(function, a, method, t); //f(a), f'(a), ...を1回で求める
+        t[2] /= 2; //テイラー係数にする
+        t[3] /= 6;
+        evaluations += method + 1;
+        if(loop_count == 0){
+            scale = std::max(1.0L, fabsl(t[0]));
+        }
+        if(t[1] == 0){ //Halley法などでも補正量が0になり、停留点で止まってしまう
+            std::cerr << "error : 導関数が0になりました" << std::endl;
+            return a;
+        }
+        long double b = a - newton::correction(t, method); //Newton法ならaの接線とx軸との交点
+        if(!std::isfinite(b)){
+            std::cerr << "error : 反復が発散しました" << std::endl;
+            return a;
+        }
+        long double r = fabsl(a - b);
+        a = b;
+        if(r < epsilon){
+            loop_count++;
+            evaluations++;
+            converged = fabsl((long double)function(a)) <= newton::RESIDUAL_TOLERANCE * scale;
+            if(!converged){
+                std::cerr << "error : 解でない点で補正量が小さくなりました" << std::endl;
+            }
+            return a;
+        }
+    }
+    std::cerr << "error : 繰り返し回数が上限に達しました" << std::endl;
+    return a;
+}
+
+template<class F> inline int NewtonSolver<F>::getLoopCount(){
+    return loop_count;
+}
+
+template<class F> inline long long NewtonSolver<F>::getEvaluations(){
+    return evaluations;
+}
+
+template<class F> inline bool NewtonSolver<F>::isConverged(){
+    return converged;
+}
+
+
+//コンストラクター
+inline NewtonBatch::NewtonBatch(ThreadPool* pool) : iterations(0), converged(0), failed(0){
+    this->pool = pool;
+}
+
+inline void NewtonBatch::setMethod(newton::Method method){
+    this->method = method;
+}
+
+//1つの多項式について始点amount個をLANES個ずつ並べて解く
+inline void NewtonBatch::solveChunk(const std::vector<double>& polynomial, const double* starts, size_t amount, std::vector<double>& roots){
+    const int L = horner::LANES;
+    int degree = polynomial.size() - 1;
+    const double* c = polynomial.data();
+    double x[L], p[L], dp[L];
+    int steps[L];
+    bool busy[L];
+    size_t next = 0; //次にレーンへ詰める始点
+    long long local_iterations = 0, local_converged = 0, local_failed = 0;
+    bool halley = method != newton::NEWTON;
+    double ddp[L];
+
+    for(int l = 0; l < L; l++){
+        busy[l] = next < amount;
+        x[l] = busy[l] ? starts[next++] : 0;
+        steps[l] = 0;
+    }
+    while(true){
+        bool any = false;
+        for(int l = 0; l < L; l++){
+            any = any || busy[l];
+        }
+        if(!any){
+            break;
+        }
+        //p(x)とp'(x)(Halley法ならp''(x)も)を同時にホーナー法で求める(レーン方向にベクトル化される)
+        if(halley){
+            horner::evaluateLanes(c, degree, x, p, dp, ddp);
+            for(int l = 0; l < L; l++){
+                double step = 2 * p[l] * dp[l] / (2 * dp[l] * dp[l] - p[l] * ddp[l]);
+                x[l] -= step;
+                p[l] = step; //収束判定用に残す
+            }
+        }else{
+            horner::evaluateLanes(c, degree, x, p, dp, NULL);
+            for(int l = 0; l < L; l++){
+                double step = p[l] / dp[l];
+                x[l] -= step;
+                p[l] = step; //収束判定用に残す
+            }
+        }
+        //収束・失敗したレーンを片付けて次の始点を詰める
+        for(int l = 0; l < L; l++){
+            if(!busy[l]){
+                continue;
+            }
+            steps[l]++;
+            local_iterations++;
+            double step = fabs(p[l]);
+            //p' = 0 の始点はHalley法でも補正量が0になるので、収束ではなく失敗とする
+            bool broken = dp[l] == 0 || !std::isfinite(x[l]) || steps[l] >= newton::BATCH_MAX_ITERATION;
+            bool done = !broken && step <= newton::BATCH_EPSILON * fmax(1.0, fabs(x[l]));
+            if(done && horner::relativeResidual(c, degree, x[l]) > newton::RESIDUAL_TOLERANCE){
+                done = false; //解でない点で補正量が小さくなった
+                broken = true;
+            }
+            if(done){
+                roots.push_back(x[l]);
+                local_converged++;
+            }else if(broken){
+                local_failed++;
+            }else{
+                continue;
+            }
+            busy[l] = next < amount;
+            x[l] = busy[l] ? starts[next++] : 0;
+            steps[l] = 0;
+        }
+    }
+    iterations += local_iterations;
+    TRACE_COUNT("newtonBatch.iterations", local_iterations);
+    TRACE_FLOPS(2LL * (method + 1) * degree * local_iterations);
+    converged += local_converged;
+    failed += local_failed;
+}
+
+inline std::vector<std::vector<double> > NewtonBatch::run(const std::vector<std::vector<double> >& polynomials, const std::vector<std::vector<double> >& starts){
+    TRACE_SOLVE("newtonBatch");
+    //数えるのはこの呼び出しの分だけ(同じインスタンスで何度呼んでも足し込まない)
+    iterations = 0;
+    converged = 0;
+    failed = 0;
+    //仕事(多項式, 始点の範囲)に分ける
+    struct Task{
+        size_t polynomial;
+        const double* starts;
+        size_t amount;
+    };
+    std::vector<Task> tasks;
+    for(size_t i = 0; i < polynomials.size(); i++){
+        const std::vector<double>& s = starts.size() == 1 ? starts.at(0) : starts.at(i);
+        for(size_t from = 0; from < s.size(); from += newton::BATCH_CHUNK){
+            tasks.push_back(Task{i, s.data() + from, std::min<size_t>(newton::BATCH_CHUNK, s.size() - from)});
+        }
+    }
+    std::vector<std::vector<double> > found(tasks.size());
+    auto solve = [&](size_t t){
+        const Task& task = tasks.at(t);
+        if(polynomials.at(task.polynomial).size() >= 2){
+            solveChunk(polynomials.at(task.polynomial), task.starts, task.amount, found.at(t));
+        }
+    };
+    if(pool != NULL){
+        pool->parallelFor(0, tasks.size(), solve);
+    }else{
+        for(size_t t = 0; t < tasks.size(); t++){
+            solve(t);
+        }
+    }
+
+    //多項式ごとに集めて重複を除く
+    std::vector<std::vector<double> > roots(polynomials.size());
+    for(size_t t = 0; t < tasks.size(); t++){
+        std::vector<double>& r = roots.at(tasks.at(t).polynomial);
+        r.insert(r.end(), found.at(t).begin(), found.at(t).end());
+    }
+    for(std::vector<double>& r : roots){
+        r = deduplicate(r);
+    }
+    return roots;
+}
+
+//整列して、隣との相対距離がROOT_TOLERANCE以下のものを1つにまとめる
+inline std::vector<double> NewtonBatch::deduplicate(std::vector<double> roots){
+    std::sort(roots.begin(), roots.end());
+    std::vector<double> unique;
+    for(double r : roots){
+        if(unique.empty() || fabs(r - unique.back()) > newton::ROOT_TOLERANCE * fmax(1.0, fabs(r))){
+            unique.push_back(r);
+        }
+    }
+    return unique;
+}
+
+inline long long NewtonBatch::getIterations(){
+    return iterations;
+}
+
+inline long long NewtonBatch::getConverged(){
+    return converged;
+}
+
+inline long long NewtonBatch::getFailed(){
+    return failed;
+}
+
+#endif
@@ -1,87 +1,7 @@
 #include<stdio.h>
 #include<iostream>
 #include<vector>
-
-namespace nibun{
-    const int ROOT = 0; // 関数の解(X軸の位置)
-    const long double EPSILON = 0.0001; //許容誤差範囲
-}
-
-
-class Nibun{
-private:
-    int division; //関数の次元
-    std::vector<int> coefficients; //係数行列(昇べきの順)
-public:
-    void set(int division, std::vector<int> coefficients);
-    void printFunction(); //関数表示用メソッド
-    long double function(long double x);
-    long double run(long double range_lower, long double range_higher);
-};
-
-//コンストラクター
-void Nibun::set(int division, std::vector<int> coefficients){
-    this->division = division;
-    this->coefficients = coefficients;
-}
-
-//保持している情報から関数の多項式表示
-void Nibun::printFunction(){
-    printf("f(x) = ");
-    for(int d = division; d >= 0; d--){
-        int c = coefficients.at(d);
-        if(c == 0){
-            continue;
-        }else if(c > 0 && d != division){
-            printf(" + ");
-        }else if(c < 0 && d != division){
-            printf(" - ");
-        }
-        
-        if(c == 1){
-            printf("x^%d", d);
-        }else if(d == 0){
-            printf("%d", abs(c));
-        }else{
-            printf("%dx^%d", abs(c), d);
-        }
-    }
-    printf("\n");
-}
-
-//関数から値を返す
-long double Nibun::function(long double x){
-    long double result = 0;
-    long double weight = 1.0;
-    for(int c : coefficients){
-        result += c * weight;
-        weight *= x;
-    }
-    return result;
-}
-
-//二分法の実行
-long double Nibun::run(long double range_lower, long double range_higher){
-    long double c = (range_higher + range_lower) / 2; //区間の中点
-    long double fa = Nibun::function(range_lower); //区間下限の関数値
-    long double fb = Nibun::function(range_higher); //区間上限の関数値
-    long double fc = Nibun::function(c); // 中点の関数値
-    long double r = range_higher - range_lower; //区間の差
-    r = r > 0 ? r : -r; //絶対値
-    // debug log(begin) ----
-    std::cerr << "(a, c, b) = " << "(" << range_lower << ", " << c << ", " << range_higher << ")" << std::endl;
-    // ---- debug log(end)
-    if(r < nibun::EPSILON){ //誤差EPSILON以下は終了
-        return c;
-    }
-    if(fc > nibun::ROOT){
-        return Nibun::run(range_lower, c);
-    }else if(fc < nibun::ROOT){
-        return Nibun::run(c, range_higher);
-    }else {
-        return c;
-    }
-}
+#include"nibun.h"
 
 int main(){
     //関数の指定
@@ -102,6 +22,43 @@ int main(){
 
     fx.printFunction();
     printf("近似解 = %Lf\n", fx.run(range_lower, range_higher));
+    printf("\t二分法     : 評価 %lld 回\n", fx.getEvaluations());
+    long double x = fx.runKSection(range_lower, range_higher);
+    printf("\tk分割法    : %Lf, 評価 %lld 回 (k = %d, 並列に評価した回数 %lld)\n", x, fx.getEvaluations(), nibun::SECTIONS, (fx.getEvaluations() - 2) / nibun::SECTIONS);
+    x = fx.runBrent(range_lower, range_higher);
+    printf("\tブレント法 : %Lf, 評価 %lld 回\n", x, fx.getEvaluations());
+
+    //任意の関数: e^x = 3x (区間[0, 1])
+    NibunSolver exponential([](long double x){ return expl(x) - 3 * x; });
+    x = exponential.runBrent(0, 1, 1e-15L);
+    printf("e^x = 3x の近似解 = %.15Lf (評価 %lld 回)\n", x, exponential.getEvaluations());
+
+    //全ての実数解: (x+3)(x-1)^2(x-2)(x-2.001)(x^2+1)
+    std::vector<long double> factors = {1};
+    auto multiply = [&](std::vector<long double> g){
+        std::vector<long double> h(factors.size() + g.size() - 1, 0);
+        for(size_t i = 0; i < factors.size(); i++){
+            for(size_t j = 0; j < g.size(); j++){
+                h.at(i + j) += factors.at(i) * g.at(j);
+            }
+        }
+        factors = h;
+    };
+    multiply({3, 1});
+    multiply({-1, 1});
+    multiply({-1, 1});
+    multiply({-2, 1});
+    multiply({-2.001L, 1});
+    multiply({1, 0, 1});
+    Nibun all;
+    all.set(factors.size() - 1, factors);
+    all.printFunction();
+    ThreadPool pool;
+    std::vector<long double> roots = all.runAll(&pool);
+    printf("実数解 %zu 個 (探索区間 ±%Lg):\n", roots.size(), all.rootBound());
+    for(long double r : roots){
+        printf("\tx = %.15Lf\n", r);
+    }
 
     return 0;
 }
@@ -0,0 +1,523 @@
+#ifndef NIBUN_H
+#define NIBUN_H
+
+#include<stdio.h>
+#include<math.h>
+#include<float.h>
+#include<iostream>
+#include<vector>
+#include<utility>
+#include<algorithm>
+#include<atomic>
+#include"horner.h"
+#include"threadPool.h"
+#include"trace.h"
+
+namespace nibun{
+    const int ROOT = 0; // 関数の解(X軸の位置)
+    const long double EPSILON = 0.0001; //許容誤差範囲
+
+    inline long double REFINE_EPSILON = 1e-15; //全ての実数解を求めるときの相対許容誤差
+    inline long double ZERO_TOLERANCE = 1e-12; //スツルム列の剰余で、最大係数に対してこれ以下の係数は0とみなす
+    const int ISOLATION_DEPTH_LIMIT = 200; //根の分離で区間を半分にする最大回数(これを超えた区間は近接した根の塊として返す)
+
+    const int SECTIONS = 4; //k分割法で1回に評価する内点の数k
+    const int BRENT_MAX_ITERATION = 200; //ブレント法の最大繰り返し回数
+
+    //ブレント法: 区間[lower, upper]を保ちながら逆2次補間・割線法を使い、だめな時は二分法にする(functionは呼び出せる物なら何でもよい)
+    template<class F> inline long double brent(F& function, long double lower, long double upper, long double epsilon){
+        long double a = lower, b = upper, c = upper;
+        long double fa = function(a);
+        long double fb = function(b);
+        if((fa < 0) == (fb < 0) && fa != 0 && fb != 0){
+            std::cerr << "error : 区間の両端で関数の符号が変わりません" << std::endl;
+            return NAN;
+        }
+        long double fc = fb;
+        long double d = b - a, e = d; //直前とその前の更新幅
+        for(int loop = 0; loop < nibun::BRENT_MAX_ITERATION; loop++){
+            if((fb > 0 && fc > 0) || (fb < 0 && fc < 0)){ //解を挟むようにcを選び直す
+                c = a;
+                fc = fa;
+                d = b - a;
+                e = d;
+            }
+            if(fabsl(fc) < fabsl(fb)){ //bを最良の近似にする
+                a = b; b = c; c = a;
+                fa = fb; fb = fc; fc = fa;
+            }
+            long double tolerance = 2 * LDBL_EPSILON * fabsl(b) + epsilon / 2;
+            long double m = (c - b) / 2;
+            if(fabsl(m) <= tolerance || fb == 0){
+                return b;
+            }
+            if(fabsl(e) >= tolerance && fabsl(fa) > fabsl(fb)){
+                long double s = fb / fa;
+                long double p, q;
+                if(a == c){ //割線法
+                    p = 2 * m * s;
+                    q = 1 - s;
+                }else{ //逆2次補間
+                    long double qa = fa / fc;
+                    long double r = fb / fc;
+                    p = s * (2 * m * qa * (qa - r) - (b - a) * (r - 1));
+                    q = (qa - 1) * (r - 1) * (s - 1);
+                }
+                if(p > 0){
+                    q = -q;
+                }
+                p = fabsl(p);
+                if(2 * p < fminl(3 * m * q - fabsl(tolerance * q), fabsl(e * q))){ //補間を採用
+                    e = d;
+                    d = p / q;
+                }else{ //縮み方が悪いので二分法
+                    d = m;
+                    e = d;
+                }
+            }else{
+                d = m;
+                e = d;
+            }
+            a = b;
+            fa = fb;
+            b += fabsl(d) > tolerance ? d : (m > 0 ? tolerance : -tolerance);
+            fb = function(b);
+        }
+        std::cerr << "error : 繰り返し回数が上限に達しました" << std::endl;
+        return b;
+    }
+}
+
+/* --- --- スツルム列による実数解の分離 --- ---
+f_0 = f, f_1 = f', f_{k+1} = -(f_{k-1} を f_k で割った余り) を定数になるまで続ける(スツルム列)。
+点xでの列の符号変化の数をV(x)とすると、区間(a, b]にある相異なる実数解の数は V(a) - V(b) になる。
+(1) 解の上界(コーシーの上界) 1 + max|a_i / a_n| で探索区間を決める
+(2) 解を含む区間を半分に分けることを、各区間の解が1つになるまで繰り返す(根の分離)
+(3) 分離した区間をスレッドプールで並列に絞り込む
+    区間の両端で符号が変われば二分法、重解などで符号が変わらなければ解の数V(a) - V(b)を使って二分する
+--- --- --- --- */
+/* --- --- 評価回数を減らす解法 --- ---
+関数の評価が高くつく場合のために、区間の両端の関数値を保持して使い回す2つの解法を用意する。
+どちらも区間の両端で符号が変わる(f(lower)*f(upper) < 0)ことが前提で、解の許容誤差はepsilon。
+・runKSection : 区間にk個の内点を等間隔に置いて(スレッドプールがあれば並列に)評価し、
+                符号が変わる小区間に絞る。1回で区間は1/(k+1)になる
+・runBrent    : 逆2次補間・割線法で超一次収束させ、縮み方が悪い時だけ二分法に戻す(ブレント法)
+評価回数は解法ごとに数え直し、getEvaluations()で直前の解法の回数が分かる。
+--- --- --- --- */
+class Nibun{
+private:
+    int division; //関数の次元
+    std::vector<long double> coefficients; //係数行列(昇べきの順)
+    std::vector<std::vector<long double> > sturm; //スツルム列(各多項式は昇べきの順)
+    std::atomic<long long> evaluations{0}; //直前の解法での関数の評価回数
+    void buildSturmSequence();
+    int signChanges(long double x);
+    long double refine(long double lower, long double upper);
+public:
+    void set(int division, std::vector<int> coefficients);
+    void set(int division, std::vector<long double> coefficients);
+    void printFunction(); //関数表示用メソッド
+    long double function(long double x);
+    long double run(long double range_lower, long double range_higher);
+    long double rootBound(); //全ての解の絶対値の上界
+    int countRoots(long double lower, long double upper); //区間(lower, upper]にある相異なる実数解の数
+    std::vector<std::pair<long double, long double> > isolateRoots(long double lower, long double upper);
+    std::vector<long double> runAll(ThreadPool* pool = NULL); //全ての実数解(昇順)
+    std::vector<long double> runAll(long double lower, long double upper, ThreadPool* pool = NULL);
+    long double runKSection(long double lower, long double upper, int k = nibun::SECTIONS, ThreadPool* pool = NULL, long double epsilon = nibun::EPSILON);
+    long double runBrent(long double lower, long double upper, long double epsilon = nibun::EPSILON);
+    long long getEvaluations();
+};
+
+//コンストラクター
+inline void Nibun::set(int division, std::vector<int> coefficients){
+    Nibun::set(division, std::vector<long double>(coefficients.begin(), coefficients.end()));
+}
+
+inline void Nibun::set(int division, std::vector<long double> coefficients){
+    this->division = division;
+    this->coefficients = coefficients;
+    this->sturm.clear();
+}
+
+//保持している情報から関数の多項式表示
+inline void Nibun::printFunction(){
+    printf("f(x) = ");
+    for(int d = division; d >= 0; d--){
+        long double c = coefficients.at(d);
+        if(c == 0){
+            continue;
+        }else if(c > 0 && d != division){
+            printf(" + ");
+        }else if(c < 0 && d != division){
+            printf(" - ");
+        }
+
+        if(c == 1){
+            printf("x^%d", d);
+        }else if(d == 0){
+            printf("%Lg", fabsl(c));
+        }else{
+            printf("%Lgx^%d", fabsl(c), d);
+        }
+    }
+    printf("\n");
+}
+
+//関数から値を返す
+inline long double Nibun::function(long double x){
+    evaluations++;
+    TRACE_COUNT("nibun.evaluations", 1);
+    TRACE_FLOPS(2LL * division);
+    return horner::evaluate(coefficients.data(), division, x);
+}
+
+//二分法の実行
+inline long double Nibun::run(long double range_lower, long double range_higher){
+    TRACE_SOLVE("nibun");
+    evaluations = 0;
+    while(true){
+        long double c = (range_higher + range_lower) / 2; //区間の中点
+        long double fc = Nibun::function(c); // 中点の関数値
+        long double r = range_higher - range_lower; //区間の差
+        r = r > 0 ? r : -r; //絶対値
+        TRACE_DEBUG(std::cerr << "(a, c, b) = " << "(" << range_lower << ", " << c << ", " << range_higher << ")" << std::endl);
+        if(r < nibun::EPSILON){ //誤差EPSILON以下は終了
+            return c;
+        }
+        if(fc > nibun::ROOT){
+            range_higher = c;
+        }else if(fc < nibun::ROOT){
+            range_lower = c;
+        }else {
+            return c;
+        }
+    }
+}
+
+//コーシーの上界: 全ての解は |x| <= 1 + max|a_i / a_n| にある
+inline long double Nibun::rootBound(){
+    long double leading = fabsl(coefficients.at(division));
+    long double bound = 0;
+    for(int i = 0; i < division; i++){
+        bound = fmaxl(bound, fabsl(coefficients.at(i)) / leading);
+    }
+    return 1 + bound;
+}
+
+//f, f', 以降は -(f_{k-1} mod f_k)
+inline void Nibun::buildSturmSequence(){
+    sturm.clear();
+    std::vector<long double> f(coefficients.begin(), coefficients.begin() + division + 1);
+    std::vector<long double> df;
+    for(int i = 1; i <= division; i++){
+        df.push_back(coefficients.at(i) * i);
+    }
+    sturm.push_back(f);
+    if(df.empty()){
+        return;
+    }
+    sturm.push_back(df);
+    while(sturm.back().size() > 1){
+        std::vector<long double> remainder = sturm.at(sturm.size() - 2);
+        const std::vector<long double>& divisor = sturm.back();
+        int dd = divisor.size() - 1;
+        long double scale = 0;
+        for(long double c : remainder){
+            scale = fmaxl(scale, fabsl(c));
+        }
+        //多項式の割り算(商は要らないので余りだけを残す)
+        for(int k = remainder.size() - 1; k >= dd; k--){
+            long double q = remainder.at(k) / divisor.at(dd);
+            for(int j = 0; j <= dd; j++){
+                remainder.at(k - dd + j) -= q * divisor.at(j);
+            }
+        }
+        remainder.resize(dd);
+        //丸め誤差で残った小さな係数を落とす
+        while(!remainder.empty() && fabsl(remainder.back()) <= nibun::ZERO_TOLERANCE * scale){
+            remainder.pop_back();
+        }
+        if(remainder.empty()){ //割り切れた(重解がある)。最後の多項式が最大公約数になる
+            break;
+        }
+        for(long double& c : remainder){
+            c = -c;
+        }
+        sturm.push_back(remainder);
+    }
+}
+
+//スツルム列のxでの符号変化の数(0は数えない)
+inline int Nibun::signChanges(long double x){
+    int changes = 0;
+    int last = 0;
+    for(const std::vector<long double>& f : sturm){
+        long double v = horner::evaluate(f.data(), (int)f.size() - 1, x);
+        int sign = v > 0 ? 1 : (v < 0 ? -1 : 0);
+        if(sign != 0){
+            if(last != 0 && sign != last){
+                changes++;
+            }
+            last = sign;
+        }
+    }
+    return changes;
+}
+
+inline int Nibun::countRoots(long double lower, long double upper){
+    if(sturm.empty()){
+        buildSturmSequence();
+    }
+    return signChanges(lower) - signChanges(upper);
+}
+
+//区間(lower, upper]を解が1つずつ入る区間に分ける
+inline std::vector<std::pair<long double, long double> > Nibun::isolateRoots(long double lower, long double upper){
+    if(sturm.empty()){
+        buildSturmSequence();
+    }
+    struct Range{
+        long double lower, upper;
+        int lower_changes, upper_changes;
+        int depth;
+    };
+    std::vector<std::pair<long double, long double> > isolated;
+    std::vector<Range> stack;
+    stack.push_back(Range{lower, upper, signChanges(lower), signChanges(upper), 0});
+    while(!stack.empty()){
+        Range r = stack.back();
+        stack.pop_back();
+        int count = r.lower_changes - r.upper_changes;
+        if(count <= 0){
+            continue;
+        }
+        if(count == 1 || r.depth >= nibun::ISOLATION_DEPTH_LIMIT){
+            isolated.push_back(std::make_pair(r.lower, r.upper));
+            continue;
+        }
+        long double middle = (r.lower + r.upper) / 2;
+        int middle_changes = signChanges(middle);
+        stack.push_back(Range{middle, r.upper, middle_changes, r.upper_changes, r.depth + 1});
+        stack.push_back(Range{r.lower, middle, r.lower_changes, middle_changes, r.depth + 1});
+    }
+    std::sort(isolated.begin(), isolated.end());
+    return isolated;
+}
+
+//解が1つだけある区間(lower, upper]を絞り込む
+inline long double Nibun::refine(long double lower, long double upper){
+    long double fl = Nibun::function(lower);
+    long double fu = Nibun::function(upper);
+    if(fu == 0){
+        return upper;
+    }
+    bool bracketed = (fl < 0) != (fu < 0) && fl != 0;
+    int lower_changes = bracketed ? 0 : signChanges(lower);
+    while(upper - lower > nibun::REFINE_EPSILON * fmaxl(1, fmaxl(fabsl(lower), fabsl(upper)))){
+        long double middle = (lower + upper) / 2;
+        if(middle <= lower || middle >= upper){ //これ以上分けられない
+            break;
+        }
+        if(bracketed){ //両端で符号が変わる: 二分法
+            long double fm = Nibun::function(middle);
+            if(fm == 0){
+                return middle;
+            }
+            if((fm < 0) == (fl < 0)){
+                lower = middle;
+                fl = fm;
+            }else{
+                upper = middle;
+            }
+        }else{ //偶数重の解など: 解の数で二分する
+            int middle_changes = signChanges(middle);
+            if(lower_changes - middle_changes >= 1){
+                upper = middle;
+            }else{
+                lower = middle;
+                lower_changes = middle_changes;
+            }
+        }
+    }
+    return (lower + upper) / 2;
+}
+
+inline std::vector<long double> Nibun::runAll(ThreadPool* pool){
+    long double bound = rootBound();
+    return Nibun::runAll(-bound, bound, pool);
+}
+
+//区間(lower, upper]にある全ての相異なる実数解を昇順に返す
+inline std::vector<long double> Nibun::runAll(long double lower, long double upper, ThreadPool* pool){
+    if(division <= 0){
+        return std::vector<long double>();
+    }
+    TRACE_SOLVE("nibun.all");
+    evaluations = 0;
+    std::vector<std::pair<long double, long double> > isolated;
+    {
+        TRACE_SCOPE("nibun.isolate");
+        isolated = Nibun::isolateRoots(lower, upper);
+    }
+    std::vector<long double> roots(isolated.size());
+    auto solve = [&](size_t i){
+        roots.at(i) = refine(isolated.at(i).first, isolated.at(i).second);
+    };
+    if(pool != NULL){
+        pool->parallelFor(0, isolated.size(), solve);
+    }else{
+        for(size_t i = 0; i < isolated.size(); i++){
+            solve(i);
+        }
+    }
+    return roots;
+}
+
+//k分割法: k個の内点の評価で区間を1/(k+1)にする
+inline long double Nibun::runKSection(long double lower, long double upper, int k, ThreadPool* pool, long double epsilon){
+    evaluations = 0;
+    if(!(epsilon > 0)){
+        std::cerr << "error : 許容誤差は正の値にしてください" << std::endl;
+        return NAN;
+    }
+    long double fl = Nibun::function(lower);
+    long double fu = Nibun::function(upper);
+    if(fl == 0){
+        return lower;
+    }else if(fu == 0){
+        return upper;
+    }else if((fl < 0) == (fu < 0)){
+        std::cerr << "error : 区間の両端で関数の符号が変わりません" << std::endl;
+        return NAN;
+    }
+    k = std::max(1, k);
+    std::vector<long double> x(k), fx(k);
+    while(upper - lower >= epsilon){
+        long double h = (upper - lower) / (k + 1);
+        for(int i = 0; i < k; i++){
+            x.at(i) = lower + h * (i + 1);
+        }
+        //内点が端点に丸められるほど区間が狭ければ、これ以上縮まないので止める
+        if(x.at(0) <= lower || x.at(k - 1) >= upper){
+            break;
+        }
+        auto evaluate = [&](size_t i){
+            fx.at(i) = Nibun::function(x.at(i));
+        };
+        if(pool != NULL && k > 1){
+            pool->parallelFor(0, k, evaluate);
+        }else{
+            for(int i = 0; i < k; i++){
+                evaluate(i);
+            }
+        }
+        //下端から見て最初に符号が変わる小区間を選ぶ
+        long double next_lower = x.at(k - 1), next_fl = fx.at(k - 1), next_upper = upper;
+        for(int i = 0; i < k; i++){
+            if(fx.at(i) == 0){
+                return x.at(i);
+            }
+            if((fx.at(i) < 0) != (fl < 0)){
+                next_lower = i == 0 ? lower : x.at(i - 1);
+                next_fl = i == 0 ? fl : fx.at(i - 1);
+                next_upper = x.at(i);
+                break;
+            }
+        }
+        lower = next_lower;
+        fl = next_fl;
+        upper = next_upper;
+    }
+    return (lower + upper) / 2;
+}
+
+inline long double Nibun::runBrent(long double lower, long double upper, long double epsilon){
+    evaluations = 0;
+    auto f = [this](long double x){
+        return Nibun::function(x);
+    };
+    return nibun::brent(f, lower, upper, epsilon);
+}
+
+inline long long Nibun::getEvaluations(){
+    return evaluations;
+}
+
+
+/* --- --- 任意の関数の二分法 --- ---
+多項式に限らず、呼び出せる物(ラムダ式など) f(x) の解を求める。
+関数の型をテンプレート引数にするので、呼び出しはインライン展開され仮想関数の呼び出しも無い。
+区間の両端の関数値を保持するので、二分法の1回の更新で評価は1回だけになる。
+--- --- --- --- */
+template<class F> class NibunSolver{
+private:
+    F function;
+    long long evaluations = 0; //直前の解法での関数の評価回数
+    long double evaluate(long double x);
+public:
+    NibunSolver(F function);//コンストラクター
+    long double run(long double lower, long double upper, long double epsilon = nibun::EPSILON);
+    long double runBrent(long double lower, long double upper, long double epsilon = nibun::EPSILON);
+    long long getEvaluations();
+};
+
+//コンストラクター
+template<class F> inline NibunSolver<F>::NibunSolver(F function) : function(function){
+}
+
+template<class F> inline long double NibunSolver<F>::evaluate(long double x){
+    evaluations++;
+    return function(x);
+}
+
+//二分法の実行(f(lower)とf(upper)の符号が異なること)
+template<class F> inline long double NibunSolver<F>::run(long double lower, long double upper, long double epsilon){
+    evaluations = 0;
+    if(!(epsilon > 0)){
+        std::cerr << "error : 許容誤差は正の値にしてください" << std::endl;
+        return NAN;
+    }
+    long double fl = evaluate(lower);
+    long double fu = evaluate(upper);
+    if(fl == 0){
+        return lower;
+    }else if(fu == 0){
+        return upper;
+    }else if((fl < 0) == (fu < 0)){
+        std::cerr << "error : 区間の両端で関数の符号が変わりません" << std::endl;
+        return NAN;
+    }
+    while(upper - lower >= epsilon){
+        long double c = (lower + upper) / 2; //区間の中点
+        //中点が端点に丸められるほど区間が狭ければ、これ以上縮まないので止める
+        if(c <= lower || c >= upper){
+            break;
+        }
+        long double fc = evaluate(c);
+        if(fc == 0){
+            return c;
+        }
+        if((fc < 0) == (fl < 0)){
+            lower = c;
+            fl = fc;
+        }else{
+            upper = c;
+        }
+    }
+    return (lower + upper) / 2;
+}
+
+template<class F> inline long double NibunSolver<F>::runBrent(long double lower, long double upper, long double epsilon){
+    evaluations = 0;
+    auto f = [this](long double x){
+        return evaluate(x);
+    };
+    return nibun::brent(f, lower, upper, epsilon);
+}
+
+template<class F> inline long long NibunSolver<F>::getEvaluations(){
+    return evaluations;
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include<vector>
+#include<chrono>
+#include"orthogonal.h"
+#include"leastSquare.h"
+
+int main(int argc, char* argv[]){
+    //[0, 10]のN点に f(x) = sin(x) + cos(3x)/2 を次数degreeで当てはめ、基底ごとの最大誤差を比べる
+    int degree = argc > 1 ? atoi(argv[1]) : 20;
+    size_t amount = 20000;
+    std::vector<double> x(amount), y(amount), fitted(amount);
+    for(size_t i = 0; i < amount; i++){
+        x[i] = 10.0 * i / (amount - 1);
+        y[i] = sin(x[i]) + cos(3 * x[i]) / 2;
+    }
+    auto maxError = [&](){
+        double error = 0;
+        for(size_t i = 0; i < amount; i++){
+            error = std::max(error, fabs(fitted[i] - y[i]));
+        }
+        return error;
+    };
+
+    //単項式の正規方程式(long double)
+    LeastSquare normal(degree);
+    normal.add(x.data(), y.data(), amount);
+    std::vector<long double> a = normal.fit();
+    if(!a.empty()){
+        for(size_t i = 0; i < amount; i++){
+            fitted[i] = horner::evaluate<long double>(a.data(), degree, x[i]);
+        }
+        printf("単項式, 正規方程式(long double): 最大誤差 %.3e\n", maxError());
+    }
+
+    //単項式のQR分解(double)
+    QRLeastSquare qr(degree + 1);
+    qr.addPolynomial(x.data(), y.data(), amount);
+    std::vector<double> b = qr.solve();
+    if(!b.empty()){
+        horner::evaluateMany(b, amount, x.data(), fitted.data());
+        printf("単項式, QR分解(double)         : 最大誤差 %.3e\n", maxError());
+    }
+
+    //点の上で直交する多項式(double)
+    OrthogonalFit orthogonal;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if(orthogonal.fit(x.data(), y.data(), amount, degree)){
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        orthogonal.evaluateMany(x.data(), fitted.data(), amount);
+        printf("直交多項式(double)             : 最大誤差 %.3e, 残差 %.3e, 当てはめ %.3f ミリ秒\n", maxError(), orthogonal.getResidual(), elapsed * 1e3);
+    }
+
+    //チェビシェフ近似: e^{sin(x)} を[-π, π]で40次
+    Chebyshev chebyshev;
+    chebyshev.approximate([](double t){ return exp(sin(t)); }, 40, -M_PI, M_PI);
+    size_t count = 1 << 20;
+    std::vector<double> t(count), value(count);
+    for(size_t i = 0; i < count; i++){
+        t[i] = -M_PI + 2 * M_PI * i / (count - 1);
+    }
+    start = std::chrono::steady_clock::now();
+    chebyshev.evaluateMany(t.data(), value.data(), count);
+    double many = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double error = 0;
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < count; i++){
+        value[i] -= chebyshev.evaluate(t[i]);
+    }
+    double single = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for(size_t i = 0; i < count; i++){
+        error = std::max(error, fabs(chebyshev.evaluate(t[i]) - exp(sin(t[i]))) + fabs(value[i]));
+    }
+    printf("チェビシェフ40次 e^{sin(x)}: 最大誤差 %.3e, %zu 点の評価 まとめて %.3f ミリ秒 / 1点ずつ %.3f ミリ秒\n",
+        error, count, many * 1e3, single * 1e3);
+
+    return 0;
+}
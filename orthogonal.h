@@ -0,0 +1,303 @@
+#ifndef ORTHOGONAL_H
+#define ORTHOGONAL_H
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include "horner.h"
+
+/* --- --- 直交多項式による当てはめと評価 --- ---
+単項式 1, x, x^2, ... の基底では正規方程式がヒルベルト行列のような悪条件になるので、
+直交する基底 p_0, p_1, ... で y ≈ ∑ c_k p_k(x) と表す。基底が直交していれば正規方程式は対角になり、
+   c_k = ∑ y p_k / ∑ p_k^2
+と1つずつ独立に求まる。xは区間[lower, upper]を u = (2x - lower - upper)/(upper - lower) で[-1, 1]に移してから使う。
+
+(1) OrthogonalFit: 与えられた点で直交する多項式(Forsytheの方法)
+      p_0 = 1,  p_1 = (u - α_1),  p_{k+1} = (u - α_{k+1}) p_k - β_k p_{k-1}
+      α_{k+1} = ∑ u p_k^2 / ∑ p_k^2,  β_k = ∑ p_k^2 / ∑ p_{k-1}^2
+    を点の上で漸化式で作る。係数は残差 r ← r - c_k p_k から c_k = ∑ r p_k / ∑ p_k^2 として求める
+    (修正グラム・シュミット法と同じ並べ方で、丸め誤差が溜まりにくい)。計算量はO(N d)、メモリはO(N)。
+(2) Chebyshev: 関数 f をチェビシェフ点 u_j = cos(π(j + 1/2)/n) で標本化すると、
+    T_k はその点の上で離散的に直交するので c_k = (2/n) ∑ f(u_j) T_k(u_j) (c_0は半分)で求まる。
+評価はどちらもClenshawの漸化式(O(d))で行い、多点はhorner::LANES個ずつまとめてSIMD命令にする。
+   b_k = c_k + (u - α_{k+1}) b_{k+1} - β_{k+1} b_{k+2},  f = b_0
+   (チェビシェフでは b_k = c_k + 2u b_{k+1} - b_{k+2},  f = c_0 + u b_1 - b_2)
+--- --- --- --- */
+namespace orthogonal{
+    const int LANES = horner::LANES; //まとめて評価する点の数
+
+    //区間の端から u = scale*x + shift の係数を求める
+    inline void mapping(double lower, double upper, double& scale, double& shift){
+        scale = 2 / (upper - lower);
+        shift = -(upper + lower) / (upper - lower);
+    }
+
+    //Σ a[i]*b[i] (LANES個の部分和に分けて足すのでSIMD命令になる)
+    inline double dot(const double* a, const double* b, size_t amount){
+        double partial[LANES] = {0};
+        size_t i = 0;
+        for(; i + LANES <= amount; i += LANES){
+            for(int l = 0; l < LANES; l++){
+                partial[l] += a[i + l] * b[i + l];
+            }
+        }
+        for(; i < amount; i++){
+            partial[0] += a[i] * b[i];
+        }
+        double sum = 0;
+        for(int l = 0; l < LANES; l++){
+            sum += partial[l];
+        }
+        return sum;
+    }
+}
+
+class OrthogonalFit{
+private:
+    int degree = -1; //近似曲線の次数
+    double scale = 1, shift = 0; //u = scale*x + shift
+    std::vector<double> alpha; //α_k (k = 1, ..., degree)。alpha[k]に置く
+    std::vector<double> beta; //β_k (k = 1, ..., degree-1)。beta[k]に置く
+    std::vector<double> coefficients; //c_k
+    double residual = 0; //|y - ∑ c_k p_k|
+    double clenshaw(double u);
+public:
+    bool fit(const double* x, const double* y, size_t amount, int degree);
+    bool fit(const double* x, const double* y, size_t amount, int degree, double lower, double upper);
+    double evaluate(double x);
+    void evaluateMany(const double* x, double* y, size_t count);
+    std::vector<double> toMonomial(); //xの多項式の係数(昇べきの順)。表示用(高い次数では桁落ちする)
+    std::vector<double> getCoefficients();
+    double getResidual();
+};
+
+class Chebyshev{
+private:
+    double scale = 1, shift = 0; //u = scale*x + shift
+    std::vector<double> coefficients; //c_k
+    double clenshaw(double u);
+public:
+    template<class F> void approximate(F f, int degree, double lower, double upper);
+    double evaluate(double x);
+    void evaluateMany(const double* x, double* y, size_t count);
+    std::vector<double> getCoefficients();
+};
+
+
+//区間を点のxの範囲にして当てはめる
+inline bool OrthogonalFit::fit(const double* x, const double* y, size_t amount, int degree){
+    if(amount == 0){
+        std::cerr << "error : 点がありません" << std::endl;
+        return false;
+    }
+    double lower = *std::min_element(x, x + amount);
+    double upper = *std::max_element(x, x + amount);
+    if(lower == upper){
+        upper = lower + 1;
+    }
+    return fit(x, y, amount, degree, lower, upper);
+}
+
+inline bool OrthogonalFit::fit(const double* x, const double* y, size_t amount, int degree, double lower, double upper){
+    if((size_t)degree + 1 > amount){
+        std::cerr << "error : 点の数が次数+1より少ないです" << std::endl;
+        return false;
+    }
+    this->degree = degree;
+    orthogonal::mapping(lower, upper, scale, shift);
+    alpha.assign(degree + 1, 0);
+    beta.assign(degree + 1, 0);
+    coefficients.assign(degree + 1, 0);
+
+    std::vector<double> u(amount), r(y, y + amount);
+    std::vector<double> current(amount, 1), previous(amount, 0), temporary(amount);
+    for(size_t i = 0; i < amount; i++){
+        u[i] = scale * x[i] + shift;
+    }
+    double norm = amount; //∑ p_k^2
+    double previous_norm = 0;
+    for(int k = 0; k <= degree; k++){
+        if(k > 0){
+            //p_k = (u - α_k) p_{k-1} - β_{k-1} p_{k-2}
+            for(size_t i = 0; i < amount; i++){
+                temporary[i] = u[i] * current[i];
+            }
+            alpha[k] = orthogonal::dot(temporary.data(), current.data(), amount) / norm;
+            double a = alpha[k], b = k > 1 ? norm / previous_norm : 0;
+            if(k > 1){
+                beta[k - 1] = b;
+            }
+            for(size_t i = 0; i < amount; i++){
+                previous[i] = (u[i] - a) * current[i] - b * previous[i];
+            }
+            current.swap(previous);
+            previous_norm = norm;
+            norm = orthogonal::dot(current.data(), current.data(), amount);
+            if(!(norm > 0)){
+                std::cerr << "error : 異なるxの点が次数+1個以上必要です" << std::endl;
+                this->degree = -1;
+                return false;
+            }
+        }
+        //c_k = ∑ r p_k / ∑ p_k^2、r ← r - c_k p_k
+        double c = orthogonal::dot(r.data(), current.data(), amount) / norm;
+        coefficients[k] = c;
+        for(size_t i = 0; i < amount; i++){
+            r[i] -= c * current[i];
+        }
+    }
+    residual = sqrt(orthogonal::dot(r.data(), r.data(), amount));
+    return true;
+}
+
+inline double OrthogonalFit::clenshaw(double u){
+    double b1 = 0, b2 = 0; //b_{k+1}, b_{k+2}
+    for(int k = degree; k >= 0; k--){
+        double a = k < degree ? alpha[k + 1] : 0;
+        double b = k + 1 < degree ? beta[k + 1] : 0;
+        double b0 = coefficients[k] + (u - a) * b1 - b * b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return b1;
+}
+
+inline double OrthogonalFit::evaluate(double x){
+    return clenshaw(scale * x + shift);
+}
+
+//LANES点ずつClenshawの漸化式を進める(最も内側のループが点なのでSIMD命令になる)
+inline void OrthogonalFit::evaluateMany(const double* x, double* y, size_t count){
+    const int L = orthogonal::LANES;
+    size_t i = 0;
+    for(; i + L <= count; i += L){
+        double u[L], b1[L] = {0}, b2[L] = {0};
+        for(int l = 0; l < L; l++){
+            u[l] = scale * x[i + l] + shift;
+        }
+        for(int k = degree; k >= 0; k--){
+            double c = coefficients[k];
+            double a = k < degree ? alpha[k + 1] : 0;
+            double b = k + 1 < degree ? beta[k + 1] : 0;
+            for(int l = 0; l < L; l++){
+                double b0 = c + (u[l] - a) * b1[l] - b * b2[l];
+                b2[l] = b1[l];
+                b1[l] = b0;
+            }
+        }
+        for(int l = 0; l < L; l++){
+            y[i + l] = b1[l];
+        }
+    }
+    for(; i < count; i++){
+        y[i] = evaluate(x[i]);
+    }
+}
+
+//基底をxの多項式として漸化式で作り、係数を掛けて足す
+inline std::vector<double> OrthogonalFit::toMonomial(){
+    std::vector<double> result(degree + 1, 0);
+    if(degree < 0){
+        return result;
+    }
+    std::vector<double> previous(degree + 1, 0), current(degree + 1, 0), next(degree + 1, 0);
+    current[0] = 1; //p_0
+    for(int k = 0; k <= degree; k++){
+        if(k > 0){
+            //p_k = (scale*x + shift - α_k) p_{k-1} - β_{k-1} p_{k-2}
+            double b = k > 1 ? beta[k - 1] : 0;
+            for(int j = 0; j <= degree; j++){
+                next[j] = (shift - alpha[k]) * current[j] - b * previous[j];
+                if(j > 0){
+                    next[j] += scale * current[j - 1];
+                }
+            }
+            previous.swap(current);
+            current.swap(next);
+        }
+        for(int j = 0; j <= k; j++){
+            result[j] += coefficients[k] * current[j];
+        }
+    }
+    return result;
+}
+
+inline std::vector<double> OrthogonalFit::getCoefficients(){
+    return coefficients;
+}
+
+inline double OrthogonalFit::getResidual(){
+    return residual;
+}
+
+
+//チェビシェフ点 degree + 1 個で f を標本化して係数を求める
+template<class F> inline void Chebyshev::approximate(F f, int degree, double lower, double upper){
+    orthogonal::mapping(lower, upper, scale, shift);
+    int n = degree + 1;
+    std::vector<double> values(n);
+    for(int j = 0; j < n; j++){
+        double u = cos(M_PI * (j + 0.5) / n);
+        values[j] = f((u - shift) / scale);
+    }
+    coefficients.assign(n, 0);
+    for(int k = 0; k < n; k++){
+        double sum = 0;
+        for(int j = 0; j < n; j++){
+            sum += values[j] * cos(M_PI * k * (j + 0.5) / n); //T_k(u_j)
+        }
+        coefficients[k] = (k == 0 ? 1.0 : 2.0) * sum / n;
+    }
+}
+
+inline double Chebyshev::clenshaw(double u){
+    int degree = (int)coefficients.size() - 1;
+    if(degree < 0){
+        return 0;
+    }
+    double b1 = 0, b2 = 0;
+    for(int k = degree; k >= 1; k--){
+        double b0 = coefficients[k] + 2 * u * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return coefficients[0] + u * b1 - b2;
+}
+
+inline double Chebyshev::evaluate(double x){
+    return clenshaw(scale * x + shift);
+}
+
+inline void Chebyshev::evaluateMany(const double* x, double* y, size_t count){
+    const int L = orthogonal::LANES;
+    int degree = (int)coefficients.size() - 1;
+    size_t i = 0;
+    for(; i + L <= count && degree >= 0; i += L){
+        double u[L], b1[L] = {0}, b2[L] = {0};
+        for(int l = 0; l < L; l++){
+            u[l] = scale * x[i + l] + shift;
+        }
+        for(int k = degree; k >= 1; k--){
+            double c = coefficients[k];
+            for(int l = 0; l < L; l++){
+                double b0 = c + 2 * u[l] * b1[l] - b2[l];
+                b2[l] = b1[l];
+                b1[l] = b0;
+            }
+        }
+        for(int l = 0; l < L; l++){
+            y[i + l] = coefficients[0] + u[l] * b1[l] - b2[l];
+        }
+    }
+    for(; i < count; i++){
+        y[i] = evaluate(x[i]);
+    }
+}
+
+inline std::vector<double> Chebyshev::getCoefficients(){
+    return coefficients;
+}
+
+#endif
@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "matrixFile.h"
+#include "expression.h"
+#include "threadPool.h"
+
+/* --- --- 外部記憶(Out-of-core)LU分解法の概要 --- ---
+LU.cppと同じ分解 A = LU (Lは対角成分を持つ下三角行列、Uは対角成分が1の上三角行列)を
+メモリに載らない大きさ(n = 6万〜10万)の行列に対して行う。
+
+係数行列は nb*nb のタイルに分割し、タイル単位で連続するようにファイルへ格納して
+mmapで参照する。タイル(I,J)はファイル先頭から ((I*nt + J)*nb*nb) 要素目に置かれる。
+(ntはタイルの行数・列数。端数はゼロ埋めし、対角成分だけ1にして分解に影響しないようにする)
+
+第k段の処理は以下の通り(タイル単位の右見LU分解)
+(1) 対角タイル A_{k,k} = L_{k,k}U_{k,k} を分解する
+(2) 列パネル L_{I,k} = A_{I,k} * U_{k,k}^{-1}  (I > k)
+(3) 各タイル列Jについて
+    U_{k,J}  = L_{k,k}^{-1} * A_{k,J}
+    A_{I,J} -= L_{I,k} * U_{k,J}  (I > k)  (後続行列の更新)
+(3)で列Jを更新している間に、列J+1(次に使うパネル)を先読み用のスレッドで読み込む。
+(スレッドは1つを全段で使い回し、先読みの仕事はそのキューに入れる)
+使い終わったタイル列はページを手放すため、常駐するのは高々4タイル列
+(列パネルk、更新中の列J、先読み中の列J+1、次段のパネルk+1)である。
+よってメモリ予算RAM_BUDGETから nb = RAM_BUDGET / (4 * n * sizeof(double)) としてタイルの大きさを決める。
+
+行列が巨大なため、要素はlong doubleではなくdoubleで持つ。
+--- --- --- --- */
+namespace outOfCoreLU{
+    double EPSILON = 1e-12; //ピボットとして許容する絶対値の下限
+    size_t RAM_BUDGET = 256UL << 20; //常駐させるタイルの上限(バイト)
+    int TILE_ALIGN = 32; //タイルの一辺はこの倍数にする(タイルの大きさがページの倍数になる)
+    int WORKING_PANELS = 4; //同時に常駐するタイル列の数
+}
+
+class OutOfCoreLU{
+private:
+    int variable_amount; //変数数=方程式数
+    int tile_size; //タイルの一辺nb
+    int tile_amount; //タイルの行数・列数nt
+    size_t ram_budget; //メモリ予算(バイト)
+    std::string path; //タイルを格納するファイル
+    int fd; //ファイル記述子
+    double* tiles; //mmapしたタイル列の先頭
+    size_t file_size; //ファイルの大きさ(バイト)
+    size_t page_size;
+    std::vector<double> b_vec; //右辺ベクトル
+    ThreadPool prefetcher; //先読み用のスレッド(1つ)
+public:
+    OutOfCoreLU(int variable_amount, std::string path, size_t ram_budget);//コンストラクター
+    ~OutOfCoreLU();
+    bool open();
+    bool loadRows(std::function<void(int, std::vector<double>&)> row_generator);
+    bool factorize();
+    std::vector<double> solve();
+    std::vector<double> runLU();
+    double* tile(int I, int J);
+    void prefetchPanel(int J, int from_I);
+    void releasePanel(int J, int from_I);
+    void releaseRow(int I, int from_J, int to_J);
+    int getTileSize();
+    int getTileAmount();
+};
+
+//コンストラクター
+OutOfCoreLU::OutOfCoreLU(int variable_amount, std::string path, size_t ram_budget) : prefetcher(1){
+    this->variable_amount = variable_amount;
+    this->path = path;
+    this->ram_budget = ram_budget;
+    this->fd = -1;
+    this->tiles = NULL;
+    this->file_size = 0;
+    this->page_size = sysconf(_SC_PAGESIZE);
+
+    //メモリ予算からタイルの大きさを決める
+    size_t nb = ram_budget / ((size_t)outOfCoreLU::WORKING_PANELS * variable_amount * sizeof(double));
+    nb -= nb % outOfCoreLU::TILE_ALIGN;
+    size_t max_nb = variable_amount + (outOfCoreLU::TILE_ALIGN - variable_amount % outOfCoreLU::TILE_ALIGN) % outOfCoreLU::TILE_ALIGN;
+    this->tile_size = (int)std::min(nb, max_nb);
+    this->tile_amount = tile_size > 0 ? (variable_amount + tile_size - 1) / tile_size : 0;
+}
+
+OutOfCoreLU::~OutOfCoreLU(){
+    if(tiles != NULL){
+        munmap(tiles, file_size);
+    }
+    if(fd >= 0){
+        close(fd);
+    }
+}
+
+//タイル用のファイルを作成してmmapする
+bool OutOfCoreLU::open(){
+    if(tile_size < outOfCoreLU::TILE_ALIGN){
+        std::cerr << "error : メモリ予算が小さすぎます(最低 "
+                  << (size_t)outOfCoreLU::WORKING_PANELS * variable_amount * outOfCoreLU::TILE_ALIGN * sizeof(double)
+                  << " バイト必要)" << std::endl;
+        return false;
+    }
+    file_size = (size_t)tile_amount * tile_amount * tile_size * tile_size * sizeof(double);
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || ftruncate(fd, file_size) != 0){
+        std::cerr << "error : タイルファイルを作成できません: " << path << std::endl;
+        return false;
+    }
+    void* p = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(p == MAP_FAILED){
+        std::cerr << "error : mmapに失敗しました" << std::endl;
+        return false;
+    }
+    tiles = (double*)p;
+    return true;
+}
+
+//タイル(I,J)の先頭(行優先でnb*nb要素)
+double* OutOfCoreLU::tile(int I, int J){
+    return tiles + ((size_t)I * tile_amount + J) * tile_size * tile_size;
+}
+
+//拡大係数行列を1行ずつ受け取り、タイル行(nb行分)ごとにまとめてタイルへ書き込む
+//row_generator(i, row)はrowに(変数数+1)個の要素(最後が右辺)を書き込む
+bool OutOfCoreLU::loadRows(std::function<void(int, std::vector<double>&)> row_generator){
+    if(tiles == NULL && !open()){
+        return false;
+    }
+    int nb = tile_size;
+    b_vec.assign((size_t)tile_amount * nb, 0);
+    std::vector<double> row(variable_amount + 1);
+    for(int I = 0; I < tile_amount; I++){
+        for(int r = 0; r < nb; r++){
+            int i = I * nb + r;
+            if(i < variable_amount){
+                row_generator(i, row);
+                b_vec.at(i) = row.at(variable_amount);
+            }
+            for(int J = 0; J < tile_amount; J++){
+                double* t = tile(I, J) + (size_t)r * nb;
+                for(int c = 0; c < nb; c++){
+                    int j = J * nb + c;
+                    if(i < variable_amount && j < variable_amount){
+                        t[c] = row.at(j);
+                    }else{
+                        t[c] = (i == j) ? 1 : 0; //端数の埋め草
+                    }
+                }
+            }
+        }
+        //書き終えたタイル行は書き出してページを手放す
+        double* begin = tile(I, 0);
+        size_t length = (size_t)tile_amount * nb * nb * sizeof(double);
+        msync(begin, length, MS_ASYNC);
+        madvise(begin, length, MADV_DONTNEED);
+    }
+    return true;
+}
+
+//タイル列Jのfrom_I行目以降を先読みする
+void OutOfCoreLU::prefetchPanel(int J, int from_I){
+    size_t tile_bytes = (size_t)tile_size * tile_size * sizeof(double);
+    for(int I = from_I; I < tile_amount; I++){
+        madvise(tile(I, J), tile_bytes, MADV_WILLNEED);
+    }
+    //ページを実際にマップさせておく
+    volatile double sink = 0;
+    size_t stride = page_size / sizeof(double);
+    for(int I = from_I; I < tile_amount; I++){
+        double* t = tile(I, J);
+        for(size_t e = 0; e < (size_t)tile_size * tile_size; e += stride){
+            sink = sink + t[e];
+        }
+    }
+}
+
+//タイル列Jのfrom_I行目以降のページを手放す(内容はファイルに残る)
+void OutOfCoreLU::releasePanel(int J, int from_I){
+    size_t tile_bytes = (size_t)tile_size * tile_size * sizeof(double);
+    for(int I = from_I; I < tile_amount; I++){
+        msync(tile(I, J), tile_bytes, MS_ASYNC);
+        madvise(tile(I, J), tile_bytes, MADV_DONTNEED);
+    }
+}
+
+//タイル行Iの列from_Jからto_Jの手前までのページを手放す(行の中のタイルは連続している)
+void OutOfCoreLU::releaseRow(int I, int from_J, int to_J){
+    if(from_J >= to_J){
+        return;
+    }
+    size_t length = (size_t)(to_J - from_J) * tile_size * tile_size * sizeof(double);
+    msync(tile(I, from_J), length, MS_ASYNC);
+    madvise(tile(I, from_J), length, MADV_DONTNEED);
+}
+
+//タイル単位のLU分解(結果はタイルファイルに上書きされる)
+bool OutOfCoreLU::factorize(){
+    int nb = tile_size;
+    int nt = tile_amount;
+    prefetchPanel(0, 0);
+    for(int k = 0; k < nt; k++){
+        //(1) 対角タイルの分解(LU.cppと同じくUの対角成分を1とする)
+        double* D = tile(k, k);
+        for(int p = 0; p < nb; p++){
+            double l = D[(size_t)p * nb + p];
+            if(fabs(l) < outOfCoreLU::EPSILON){
+                std::cerr << "error : ピボットが0です(" << k * nb + p << "行目)" << std::endl;
+                return false;
+            }
+            for(int j = p+1; j < nb; j++){
+                D[(size_t)p * nb + j] /= l;
+            }
+            for(int i = p+1; i < nb; i++){
+                double lip = D[(size_t)i * nb + p];
+                for(int j = p+1; j < nb; j++){
+                    D[(size_t)i * nb + j] -= lip * D[(size_t)p * nb + j];
+                }
+            }
+        }
+
+        //(2) 列パネル L_{I,k} = A_{I,k} * U_{k,k}^{-1}
+        for(int I = k+1; I < nt; I++){
+            double* A = tile(I, k);
+            for(int i = 0; i < nb; i++){
+                double* a = A + (size_t)i * nb;
+                for(int m = 0; m < nb; m++){
+                    double am = a[m];
+                    for(int j = m+1; j < nb; j++){
+                        a[j] -= am * D[(size_t)m * nb + j];
+                    }
+                }
+            }
+        }
+
+        //(3) 各タイル列の更新。列J+1の先読みを列Jの更新と並行して行う
+        if(k+1 < nt){
+            prefetcher.submit([this, k](){ prefetchPanel(k+1, k); });
+        }
+        for(int J = k+1; J < nt; J++){
+            prefetcher.wait(); //列Jの先読みが終わるまで待つ
+            if(J+1 < nt){
+                prefetcher.submit([this, J, k](){ prefetchPanel(J+1, k); });
+            }
+
+            // U_{k,J} = L_{k,k}^{-1} * A_{k,J}
+            double* U = tile(k, J);
+            for(int i = 0; i < nb; i++){
+                double* u = U + (size_t)i * nb;
+                for(int m = 0; m < i; m++){
+                    double lim = D[(size_t)i * nb + m];
+                    double* um = U + (size_t)m * nb;
+                    for(int j = 0; j < nb; j++){
+                        u[j] -= lim * um[j];
+                    }
+                }
+                double lii = D[(size_t)i * nb + i];
+                for(int j = 0; j < nb; j++){
+                    u[j] /= lii;
+                }
+            }
+
+            // A_{I,J} -= L_{I,k} * U_{k,J}
+            for(int I = k+1; I < nt; I++){
+                double* A = tile(I, J);
+                double* L = tile(I, k);
+                for(int i = 0; i < nb; i++){
+                    double* a = A + (size_t)i * nb;
+                    for(int m = 0; m < nb; m++){
+                        double lim = L[(size_t)i * nb + m];
+                        double* um = U + (size_t)m * nb;
+                        for(int j = 0; j < nb; j++){
+                            a[j] -= lim * um[j];
+                        }
+                    }
+                }
+            }
+            //次段のパネル(列k+1)は残し、それ以外の列は手放す
+            if(J != k+1){
+                releasePanel(J, k);
+            }
+        }
+        prefetcher.wait();
+        releasePanel(k, 0);
+    }
+    return true;
+}
+
+//分解済みのタイルを1タイル行ずつ読みながら Ly = b, Ux = y を解く
+std::vector<double> OutOfCoreLU::solve(){
+    int nb = tile_size;
+    int nt = tile_amount;
+    std::vector<double> y_vec(b_vec);
+
+    //(1) Ly = bのyを求める
+    for(int I = 0; I < nt; I++){
+        double* y = y_vec.data() + (size_t)I * nb;
+        for(int J = 0; J < I; J++){
+            double* L = tile(I, J);
+            double* yj = y_vec.data() + (size_t)J * nb;
+            for(int i = 0; i < nb; i++){
+                double s = 0;
+                for(int m = 0; m < nb; m++){
+                    s += L[(size_t)i * nb + m] * yj[m];
+                }
+                y[i] -= s;
+            }
+        }
+        double* D = tile(I, I);
+        for(int i = 0; i < nb; i++){
+            double s = 0;
+            for(int m = 0; m < i; m++){
+                s += D[(size_t)i * nb + m] * y[m];
+            }
+            y[i] = (y[i] - s) / D[(size_t)i * nb + i];
+        }
+        releaseRow(I, 0, I+1); //読み終えたタイル(I, 0..I)を手放す
+    }
+
+    //(2) Ux = yとしてxを求める
+    std::vector<double> x_vec(y_vec);
+    for(int I = nt-1; I >= 0; I--){
+        double* x = x_vec.data() + (size_t)I * nb;
+        for(int J = I+1; J < nt; J++){
+            double* U = tile(I, J);
+            double* xj = x_vec.data() + (size_t)J * nb;
+            for(int i = 0; i < nb; i++){
+                double s = 0;
+                for(int m = 0; m < nb; m++){
+                    s += U[(size_t)i * nb + m] * xj[m];
+                }
+                x[i] -= s;
+            }
+        }
+        double* D = tile(I, I);
+        for(int i = nb-1; i >= 0; i--){
+            double s = 0;
+            for(int m = i+1; m < nb; m++){
+                s += D[(size_t)i * nb + m] * x[m];
+            }
+            x[i] -= s;
+        }
+        releaseRow(I, I, nt); //読み終えたタイル(I, I..nt-1)を手放す
+    }
+    x_vec.resize(variable_amount);
+    return x_vec;
+}
+
+std::vector<double> OutOfCoreLU::runLU(){
+    if(!factorize()){
+        std::vector<double> v;
+        return v;
+    }
+    return solve();
+}
+
+int OutOfCoreLU::getTileSize(){
+    return tile_size;
+}
+
+int OutOfCoreLU::getTileAmount(){
+    return tile_amount;
+}
+
+
+int main(int argc, char* argv[]){
+    //連立方程式の定義(対角優位な行列で、解が全て1になるように右辺を作る)
+    //第1引数が数値でなければバイナリ形式(.namx)の行列ファイルとして読み込む
+    MatrixFile file;
+    bool from_file = argc > 1 && !isdigit((unsigned char)argv[1][0]);
+    int variable_amount = argc > 1 && !from_file ? atoi(argv[1]) : 2000;
+    size_t ram_budget = argc > 2 ? (size_t)atol(argv[2]) << 20 : outOfCoreLU::RAM_BUDGET;
+    std::string path = argc > 3 ? argv[3] : "outOfCoreLU.tiles";
+    std::function<void(int, std::vector<double>&)> generator = [variable_amount](int i, std::vector<double>& row){
+        double b = 0;
+        for(int j = 0; j < variable_amount; j++){
+            row.at(j) = (i == j) ? variable_amount : 1.0 / (1 + abs(i - j));
+            b += row.at(j);
+        }
+        row.at(variable_amount) = b;
+    };
+    if(from_file){
+        if(!file.open(argv[1])){
+            return 1;
+        }
+        if(file.rows() != file.cols() || !file.hasRhs()){
+            std::cerr << "error : 右辺を持つ正方行列が必要です" << std::endl;
+            return 1;
+        }
+        variable_amount = file.rows();
+        generator = [&file, variable_amount](int i, std::vector<double>& row){
+            file.getRow(i, row.data());
+            row.at(variable_amount) = file.rhs()[i];
+        };
+    }
+
+    //関数作成
+    OutOfCoreLU simultaneous_equations(variable_amount, path, ram_budget);
+    printf("n = %d, タイル = %d x %d (%d x %d 個)\n", variable_amount,
+        simultaneous_equations.getTileSize(), simultaneous_equations.getTileSize(),
+        simultaneous_equations.getTileAmount(), simultaneous_equations.getTileAmount());
+    if(!simultaneous_equations.loadRows(generator)){
+        return 1;
+    }
+    //外部記憶LU分解法の実行
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> answer = simultaneous_equations.runLU();
+    auto end = std::chrono::steady_clock::now();
+    unlink(path.c_str());
+    if(answer.empty()){
+        return 1;
+    }
+
+    if(from_file){
+        //残差 max|b - Ax| (mmapした値をそのまま1回だけ読む。CSRなら非零要素だけ)
+        expression::Vector<double> b = expression::vector(file.rhs(), variable_amount);
+        expression::Vector<double> x = expression::vector(answer);
+        double max_residual = file.isDense()
+            ? expression::normInf(b - expression::dense(file.values(), variable_amount, variable_amount) * x)
+            : expression::normInf(b - expression::sparse(file.values(), file.rowPointers(), file.columnIndices(), variable_amount) * x);
+        printf("最大残差 = %e\n", max_residual);
+    }else{
+        double max_error = 0;
+        for(double x : answer){
+            max_error = fmax(max_error, fabs(x - 1));
+        }
+        printf("最大誤差 = %e\n", max_error);
+    }
+    printf("実行時間 = %.3f 秒\n", std::chrono::duration<double>(end - start).count());
+    return 0;
+}
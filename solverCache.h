@@ -0,0 +1,222 @@
+#ifndef SOLVER_CACHE_H
+#define SOLVER_CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <limits>
+
+/* --- --- 分解結果のキャッシュ --- ---
+同じ係数行列に右辺ベクトルだけ変えて何度も解く場合、LU分解やガウスジョルダン法の消去、
+SORのω調整などの前処理は毎回同じ結果になる。
+そこで係数行列(拡大係数行列の右辺を除いた部分)の内容のハッシュ値をキーとして前処理の結果を保持する。
+・使用メモリの上限(バイト)を超えると最も長く使われていないものから捨てる(LRU)
+・呼び出し側が行列に固有のIDを持っている場合はkeyFor(id)でハッシュ計算を省ける
+--- --- --- --- */
+namespace solverCache{
+    inline size_t CAPACITY = 64UL << 20; //既定の使用メモリ上限(バイト)
+}
+
+//1つの係数行列に対して保持する前処理の結果
+struct CachedSetup{
+    //LU分解(LU.cpp)
+    std::vector<std::vector<long double> > L_matrix;
+    std::vector<std::vector<long double> > U_matrix;
+    //ガウスジョルダン法の消去手順(gaussJordan.cpp)
+    std::vector<int> pivot_rows; //pivot段目で入れ替えた行
+    std::vector<std::vector<long double> > pivot_scales; //pivot段目で各行を割った係数(0なら何もしない)
+    std::vector<std::vector<long double> > reduced_matrix; //消去後の上三角行列(対角成分は1)
+    //反復法(jacobi.cpp, gaussSeidel.cpp, SOR.cpp)
+    std::vector<long double> inverted_diagonal; //対角成分の逆数
+    bool has_omega = false;
+    long double omega = 0; //調整済みの加速パラメータ
+
+    size_t bytes() const;
+};
+
+class SolverCache{
+public:
+    //キャッシュのキー(内容のハッシュ値、または呼び出し側が与えるID)
+    struct Key{
+        uint64_t value = 0;
+        int variable_amount = 0;
+        bool by_id = false;
+        bool operator==(const Key& other) const{
+            return value == other.value && variable_amount == other.variable_amount && by_id == other.by_id;
+        }
+    };
+private:
+    struct KeyHash{
+        size_t operator()(const Key& key) const{
+            return key.value ^ ((uint64_t)key.variable_amount << 1) ^ key.by_id;
+        }
+    };
+    typedef std::pair<Key, std::shared_ptr<CachedSetup> > Item;
+    size_t capacity; //使用メモリ上限(バイト)
+    size_t used = 0; //使用中のメモリ(バイト)
+    std::list<Item> items; //先頭ほど最近使われたもの
+    std::unordered_map<Key, std::list<Item>::iterator, KeyHash> index;
+    std::unordered_map<Key, size_t, KeyHash> sizes;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    std::mutex mutex;
+    void evict();
+public:
+    SolverCache(size_t capacity = solverCache::CAPACITY);//コンストラクター
+    static uint64_t hash(const std::vector<std::vector<long double> >& coefficient_matrix, int variable_amount);
+    static Key keyFor(const std::vector<std::vector<long double> >& coefficient_matrix, int variable_amount);
+    static Key keyFor(uint64_t matrix_id, int variable_amount);
+    std::shared_ptr<CachedSetup> find(const Key& key); //無ければnullptr
+    void store(const Key& key, std::shared_ptr<CachedSetup> setup); //追加・更新(大きさを数え直す)
+    void clear();
+    size_t getHits();
+    size_t getMisses();
+    size_t getEvictions();
+    size_t getUsedBytes();
+    void printStatistics();
+};
+
+
+inline size_t CachedSetup::bytes() const{
+    size_t total = sizeof(CachedSetup);
+    for(const std::vector<std::vector<long double> >* m : {&L_matrix, &U_matrix, &pivot_scales, &reduced_matrix}){
+        for(const std::vector<long double>& row : *m){
+            total += sizeof(row) + row.capacity() * sizeof(long double);
+        }
+    }
+    total += pivot_rows.capacity() * sizeof(int);
+    total += inverted_diagonal.capacity() * sizeof(long double);
+    return total;
+}
+
+
+//コンストラクター
+inline SolverCache::SolverCache(size_t capacity){
+    this->capacity = capacity;
+}
+
+//係数行列(右辺を除く)の内容のハッシュ値
+//long doubleは有効なビット(x86では仮数64ビットと符号・指数16ビット)だけを使う
+inline uint64_t SolverCache::hash(const std::vector<std::vector<long double> >& coefficient_matrix, int variable_amount){
+    const uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+    uint64_t h = PRIME_1 ^ (uint64_t)variable_amount;
+    for(int i = 0; i < variable_amount; i++){
+        const long double* row = coefficient_matrix.at(i).data();
+        for(int j = 0; j < variable_amount; j++){
+            uint64_t mantissa = 0;
+            uint64_t exponent = 0;
+            if(std::numeric_limits<long double>::digits == 64){
+                memcpy(&mantissa, &row[j], 8);
+                memcpy(&exponent, (const char*)&row[j] + 8, 2);
+            }else{
+                double d = (double)row[j];
+                memcpy(&mantissa, &d, 8);
+            }
+            h ^= mantissa * PRIME_2;
+            h = ((h << 31) | (h >> 33)) * PRIME_1;
+            h ^= exponent;
+        }
+    }
+    h ^= h >> 33;
+    h *= PRIME_2;
+    h ^= h >> 29;
+    return h;
+}
+
+inline SolverCache::Key SolverCache::keyFor(const std::vector<std::vector<long double> >& coefficient_matrix, int variable_amount){
+    Key key;
+    key.value = hash(coefficient_matrix, variable_amount);
+    key.variable_amount = variable_amount;
+    key.by_id = false;
+    return key;
+}
+
+//呼び出し側が行列の同一性を保証するID(ハッシュを計算しない)
+inline SolverCache::Key SolverCache::keyFor(uint64_t matrix_id, int variable_amount){
+    Key key;
+    key.value = matrix_id;
+    key.variable_amount = variable_amount;
+    key.by_id = true;
+    return key;
+}
+
+inline std::shared_ptr<CachedSetup> SolverCache::find(const Key& key){
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if(it == index.end()){
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    items.splice(items.begin(), items, it->second); //最近使われたものとして先頭へ
+    return it->second->second;
+}
+
+inline void SolverCache::store(const Key& key, std::shared_ptr<CachedSetup> setup){
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if(it != index.end()){
+        used -= sizes.at(key);
+        items.erase(it->second);
+    }
+    items.push_front(std::make_pair(key, setup));
+    index[key] = items.begin();
+    sizes[key] = setup->bytes();
+    used += sizes.at(key);
+    evict();
+}
+
+//上限を超えている間、最も古いものを捨てる(直前に追加したものは残す)
+inline void SolverCache::evict(){
+    while(used > capacity && items.size() > 1){
+        Key key = items.back().first;
+        used -= sizes.at(key);
+        sizes.erase(key);
+        index.erase(key);
+        items.pop_back();
+        evictions++;
+    }
+}
+
+inline void SolverCache::clear(){
+    std::lock_guard<std::mutex> lock(mutex);
+    items.clear();
+    index.clear();
+    sizes.clear();
+    used = 0;
+}
+
+inline size_t SolverCache::getHits(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+inline size_t SolverCache::getMisses(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+inline size_t SolverCache::getEvictions(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return evictions;
+}
+
+inline size_t SolverCache::getUsedBytes(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+inline void SolverCache::printStatistics(){
+    std::lock_guard<std::mutex> lock(mutex);
+    printf("キャッシュ: ヒット %zu, ミス %zu, 追い出し %zu, 使用 %zu / %zu バイト\n",
+        hits, misses, evictions, used, capacity);
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "solverProtocol.h"
+
+/* --- --- 常駐ソルバーの負荷生成クライアント --- ---
+solverDaemonに対角優位な連立方程式(解が全て1)を送り続け、応答までの時間を測る。
+同時に送っておく問題数(window)を超えないように送信スレッドを待たせる。
+--- --- --- --- */
+namespace solverClient{
+    int REQUESTS = 10000; //送る問題数
+    int WINDOW = 256; //応答を待たずに送っておける問題数
+    unsigned SEED = 1;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+//次元nの対角優位な連立方程式を作る(解が全て1になるように右辺を決める)
+void makeProblem(int n, std::mt19937_64& random, std::vector<double>& a, std::vector<double>& b){
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    a.resize((size_t)n * n);
+    b.assign(n, 0);
+    for(int i = 0; i < n; i++){
+        for(int j = 0; j < n; j++){
+            a[(size_t)i * n + j] = (i == j) ? n : distribution(random);
+            b[i] += a[(size_t)i * n + j];
+        }
+    }
+}
+
+double percentile(std::vector<double>& values, double p){
+    if(values.empty()){
+        return 0;
+    }
+    size_t k = std::min(values.size() - 1, (size_t)(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+int main(int argc, char* argv[]){
+    //引数: <socket path> [問題数] [次元のリスト(カンマ区切り)] [window]
+    if(argc < 2){
+        fprintf(stderr, "usage: %s <socket path> [requests] [sizes e.g. 3,8,200] [window]\n", argv[0]);
+        return 1;
+    }
+    int requests = argc > 2 ? atoi(argv[2]) : solverClient::REQUESTS;
+    std::vector<int> sizes;
+    std::stringstream list(argc > 3 ? argv[3] : "3,8,16,100");
+    for(std::string item; std::getline(list, item, ',');){
+        sizes.push_back(atoi(item.c_str()));
+    }
+    int window = argc > 4 ? atoi(argv[4]) : solverClient::WINDOW;
+
+    sockaddr_un address;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || !solverProtocol::fillAddress(argv[1], address) || connect(fd, (sockaddr*)&address, sizeof(address)) != 0){
+        std::cerr << "error : 接続できません: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::mutex mutex;
+    std::condition_variable space;
+    int outstanding = 0;
+    std::map<uint64_t, Clock::time_point> sent_at;
+
+    //送信スレッド
+    Clock::time_point start = Clock::now();
+    std::thread sender([&](){
+        std::mt19937_64 random(solverClient::SEED);
+        std::vector<double> a, b;
+        for(int r = 0; r < requests; r++){
+            int n = sizes.at(r % sizes.size());
+            makeProblem(n, random, a, b);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                space.wait(lock, [&](){ return outstanding < window; });
+                outstanding++;
+                sent_at[r] = Clock::now();
+            }
+            solverProtocol::RequestHeader header;
+            header.magic = solverProtocol::REQUEST_MAGIC;
+            header.variable_amount = n;
+            header.request_id = r;
+            if(!solverProtocol::writeFully(fd, &header, sizeof(header))
+                || !solverProtocol::writeFully(fd, a.data(), a.size() * sizeof(double))
+                || !solverProtocol::writeFully(fd, b.data(), b.size() * sizeof(double))){
+                std::cerr << "error : 送信に失敗しました" << std::endl;
+                return;
+            }
+        }
+    });
+
+    //受信(応答は順不同)
+    std::vector<double> round_trip_us, queue_us, solve_us;
+    std::map<int, std::vector<double> > round_trip_by_size;
+    double batch_total = 0;
+    double max_error = 0;
+    int failures = 0;
+    std::vector<double> x;
+    for(int r = 0; r < requests; r++){
+        solverProtocol::ResponseHeader header;
+        if(!solverProtocol::readFully(fd, &header, sizeof(header)) || header.magic != solverProtocol::RESPONSE_MAGIC){
+            std::cerr << "error : 応答を受信できません" << std::endl;
+            break;
+        }
+        if(header.status == solverProtocol::OK){
+            x.resize(header.variable_amount);
+            if(!solverProtocol::readFully(fd, x.data(), x.size() * sizeof(double))){
+                break;
+            }
+            for(double v : x){
+                max_error = fmax(max_error, fabs(v - 1));
+            }
+        }else{
+            failures++;
+        }
+        Clock::time_point now = Clock::now();
+        double us;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            us = std::chrono::duration<double, std::micro>(now - sent_at.at(header.request_id)).count();
+            sent_at.erase(header.request_id);
+            outstanding--;
+        }
+        space.notify_one();
+        round_trip_us.push_back(us);
+        round_trip_by_size[header.variable_amount].push_back(us);
+        queue_us.push_back(header.queue_ns / 1000.0);
+        solve_us.push_back(header.solve_ns / 1000.0);
+        batch_total += header.batch_size;
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    sender.join();
+    close(fd);
+
+    size_t received = round_trip_us.size();
+    printf("問題数 %zu, %.3f 秒, %.0f 問/秒, 平均バッチ %.1f, 失敗 %d, 最大誤差 %e\n",
+        received, elapsed, received / elapsed, received ? batch_total / received : 0, failures, max_error);
+    printf("往復[us]   p50 %9.1f  p90 %9.1f  p99 %9.1f  max %9.1f\n",
+        percentile(round_trip_us, 0.5), percentile(round_trip_us, 0.9), percentile(round_trip_us, 0.99), percentile(round_trip_us, 1.0));
+    printf("待ち[us]   p50 %9.1f  p99 %9.1f\n", percentile(queue_us, 0.5), percentile(queue_us, 0.99));
+    printf("計算[us]   p50 %9.1f  p99 %9.1f\n", percentile(solve_us, 0.5), percentile(solve_us, 0.99));
+    for(auto& group : round_trip_by_size){
+        printf("  n = %4d: 往復 p50 %9.1f us, p99 %9.1f us\n", group.first,
+            percentile(group.second, 0.5), percentile(group.second, 0.99));
+    }
+    return 0;
+}
@@ -0,0 +1,435 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <map>
+#include <memory>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <signal.h>
+#include "threadPool.h"
+#include "solverProtocol.h"
+
+/* --- --- 常駐ソルバー --- ---
+問題ごとにプロセスを起動する代わりに、常駐して連立方程式 Ax = b を受け付け続ける。
+通信形式はsolverProtocol.hを参照。
+
+・次元がSMALL_LIMIT以下の問題は同じ次元ごとに溜め、BATCH_SIZE個揃うか
+  最初の問題からBATCH_WAIT_USマイクロ秒経ったらまとめて解く。
+  バッチ内の問題を最も内側のループに並べる(要素(i,j)のB問題分が連続する)ことで
+  消去の計算がベクトル化される。各問題の消去はピボット選択をしないため、
+  残差が大きい問題だけを部分ピボット選択付きのガウスの消去法で解き直す。
+・それより大きい問題は受け取った順にスレッドプールで1問ずつ解く。
+・解と一緒に待ち時間と計算時間を返す。負荷の測定にはsolverClient.cppを使う。
+--- --- --- --- */
+namespace solverDaemon{
+    int SMALL_LIMIT = 32; //この次元以下はバッチで解く
+    int BATCH_SIZE = 64; //バッチの最大問題数
+    int BATCH_WAIT_US = 200; //バッチが揃うのを待つ最大時間(マイクロ秒)
+    double RESIDUAL_LIMIT = 1e-9; //バッチで解いた解の相対残差の上限
+    size_t MAX_REQUEST_BYTES = 256UL << 20; //1つの要求の係数行列と右辺のバイト数の上限(--max-mbで変える)
+
+    //要求の A と b のバイト数 8(n^2 + n)
+    inline size_t requestBytes(uint64_t variable_amount){
+        return sizeof(double) * (variable_amount * variable_amount + variable_amount);
+    }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+//1つの接続(応答の書き込みは複数スレッドから行われるので排他する)
+struct Connection{
+    int in_fd;
+    int out_fd;
+    bool owns_fd;
+    std::mutex write_mutex;
+    ~Connection(){
+        if(owns_fd){
+            close(in_fd);
+        }
+    }
+};
+
+//受け取った問題
+struct Problem{
+    std::shared_ptr<Connection> connection;
+    uint64_t request_id;
+    int variable_amount;
+    std::vector<double> a; //係数行列(行優先)
+    std::vector<double> b; //右辺ベクトル
+    Clock::time_point received;
+};
+
+class SolverDaemon{
+private:
+    ThreadPool pool;
+    std::mutex batch_mutex;
+    std::condition_variable batch_ready;
+    std::map<int, std::vector<Problem> > pending; //次元ごとに溜めている問題
+    bool stopping;
+    std::thread flusher;
+    void flushLoop();
+    void submitBatch(std::vector<Problem> batch);
+    void solveBatch(std::vector<Problem>& batch);
+    void solveSingle(Problem& problem);
+    void respond(Problem& problem, uint32_t status, const double* x, Clock::time_point started, uint64_t solve_ns, uint32_t batch_size);
+public:
+    SolverDaemon(int threads);//コンストラクター
+    ~SolverDaemon();
+    void enqueue(Problem problem);
+    void drain();
+    void serveStream(std::shared_ptr<Connection> connection);
+    bool serveSocket(std::string path);
+    static bool solvePivoted(int variable_amount, std::vector<double> a, std::vector<double>& x);
+};
+
+//コンストラクター
+SolverDaemon::SolverDaemon(int threads) : pool(threads){
+    this->stopping = false;
+    this->flusher = std::thread(&SolverDaemon::flushLoop, this);
+}
+
+SolverDaemon::~SolverDaemon(){
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        stopping = true;
+    }
+    batch_ready.notify_all();
+    flusher.join();
+}
+
+void SolverDaemon::enqueue(Problem problem){
+    if(problem.variable_amount > solverDaemon::SMALL_LIMIT){
+        std::shared_ptr<Problem> p = std::make_shared<Problem>(std::move(problem));
+        pool.submit([this, p](){ solveSingle(*p); });
+        return;
+    }
+    std::vector<Problem> full;
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        std::vector<Problem>& group = pending[problem.variable_amount];
+        group.push_back(std::move(problem));
+        if((int)group.size() >= solverDaemon::BATCH_SIZE){
+            full.swap(group);
+        }
+    }
+    if(!full.empty()){
+        submitBatch(std::move(full));
+    }else{
+        batch_ready.notify_one();
+    }
+}
+
+void SolverDaemon::submitBatch(std::vector<Problem> batch){
+    std::shared_ptr<std::vector<Problem> > b = std::make_shared<std::vector<Problem> >(std::move(batch));
+    pool.submit([this, b](){ solveBatch(*b); });
+}
+
+//待ち時間を過ぎたバッチを揃っていなくても解き始める
+void SolverDaemon::flushLoop(){
+    std::unique_lock<std::mutex> lock(batch_mutex);
+    while(!stopping){
+        Clock::time_point now = Clock::now();
+        Clock::time_point next = now + std::chrono::hours(1);
+        std::vector<std::vector<Problem> > due;
+        for(auto& group : pending){
+            if(group.second.empty()){
+                continue;
+            }
+            Clock::time_point deadline = group.second.front().received + std::chrono::microseconds(solverDaemon::BATCH_WAIT_US);
+            if(deadline <= now){
+                due.push_back(std::move(group.second));
+                group.second.clear();
+            }else{
+                next = std::min(next, deadline);
+            }
+        }
+        if(!due.empty()){
+            lock.unlock();
+            for(std::vector<Problem>& batch : due){
+                submitBatch(std::move(batch));
+            }
+            lock.lock();
+            continue;
+        }
+        batch_ready.wait_until(lock, next);
+    }
+}
+
+//溜まっている問題を全て解き終えるまで待つ
+void SolverDaemon::drain(){
+    std::vector<std::vector<Problem> > rest;
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        for(auto& group : pending){
+            if(!group.second.empty()){
+                rest.push_back(std::move(group.second));
+                group.second.clear();
+            }
+        }
+    }
+    for(std::vector<Problem>& batch : rest){
+        submitBatch(std::move(batch));
+    }
+    pool.wait();
+}
+
+/* バッチの解法
+要素(i,j)について問題lの値を a[(i*n + j)*B + l] に置き、
+ピボット選択なしのガウスの消去法の各操作を全ての問題に同時に行う。
+*/
+void SolverDaemon::solveBatch(std::vector<Problem>& batch){
+    Clock::time_point started = Clock::now();
+    int B = batch.size();
+    int n = batch.front().variable_amount;
+    std::vector<double> a((size_t)n * n * B);
+    std::vector<double> b((size_t)n * B);
+    std::vector<double> f(B);
+    for(int l = 0; l < B; l++){
+        for(int k = 0; k < n * n; k++){
+            a[(size_t)k * B + l] = batch.at(l).a[k];
+        }
+        for(int i = 0; i < n; i++){
+            b[(size_t)i * B + l] = batch.at(l).b[i];
+        }
+    }
+
+    //前進消去
+    for(int p = 0; p < n; p++){
+        double* ap = &a[((size_t)p * n) * B];
+        for(int l = 0; l < B; l++){
+            f[l] = 1.0 / ap[(size_t)p * B + l];
+        }
+        //pivot行を対角成分で割る
+        for(int j = p; j < n; j++){
+            for(int l = 0; l < B; l++){
+                ap[(size_t)j * B + l] *= f[l];
+            }
+        }
+        for(int l = 0; l < B; l++){
+            b[(size_t)p * B + l] *= f[l];
+        }
+        for(int i = p+1; i < n; i++){
+            double* ai = &a[((size_t)i * n) * B];
+            for(int l = 0; l < B; l++){
+                f[l] = ai[(size_t)p * B + l];
+            }
+            for(int j = p; j < n; j++){
+                for(int l = 0; l < B; l++){
+                    ai[(size_t)j * B + l] -= f[l] * ap[(size_t)j * B + l];
+                }
+            }
+            for(int l = 0; l < B; l++){
+                b[(size_t)i * B + l] -= f[l] * b[(size_t)p * B + l];
+            }
+        }
+    }
+    //後退代入(bに解を上書きする)
+    for(int i = n-1; i >= 0; i--){
+        for(int j = i+1; j < n; j++){
+            for(int l = 0; l < B; l++){
+                b[(size_t)i * B + l] -= a[((size_t)i * n + j) * B + l] * b[(size_t)j * B + l];
+            }
+        }
+    }
+    uint64_t solve_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+
+    //残差を確かめ、大きいものは部分ピボット選択付きで解き直す(その時間もその問題の計算時間に含める)
+    std::vector<double> x(n);
+    for(int l = 0; l < B; l++){
+        Clock::time_point checked = Clock::now();
+        Problem& problem = batch.at(l);
+        double residual = 0, scale = 0;
+        for(int i = 0; i < n; i++){
+            x[i] = b[(size_t)i * B + l];
+        }
+        for(int i = 0; i < n; i++){
+            double r = problem.b[i];
+            double s = fabs(problem.b[i]);
+            for(int j = 0; j < n; j++){
+                r -= problem.a[(size_t)i * n + j] * x[j];
+                s += fabs(problem.a[(size_t)i * n + j] * x[j]);
+            }
+            residual = fmax(residual, fabs(r));
+            scale = fmax(scale, s);
+        }
+        uint32_t status = solverProtocol::OK;
+        if(!(residual <= solverDaemon::RESIDUAL_LIMIT * scale)){
+            status = solvePivoted(n, problem.a, x) ? solverProtocol::OK : solverProtocol::SINGULAR;
+        }
+        uint64_t check_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - checked).count();
+        respond(problem, status, x.data(), started, solve_ns + check_ns, B);
+    }
+}
+
+void SolverDaemon::solveSingle(Problem& problem){
+    Clock::time_point started = Clock::now();
+    std::vector<double> x(problem.b);
+    bool ok = solvePivoted(problem.variable_amount, problem.a, x);
+    uint64_t solve_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+    respond(problem, ok ? solverProtocol::OK : solverProtocol::SINGULAR, x.data(), started, solve_ns, 1);
+}
+
+//部分ピボット選択付きのガウスの消去法(xに右辺を渡し、解が上書きされる)
+bool SolverDaemon::solvePivoted(int n, std::vector<double> a, std::vector<double>& x){
+    for(int p = 0; p < n; p++){
+        int r = p;
+        for(int i = p+1; i < n; i++){
+            if(fabs(a[(size_t)i * n + p]) > fabs(a[(size_t)r * n + p])){
+                r = i;
+            }
+        }
+        if(a[(size_t)r * n + p] == 0){
+            return false;
+        }
+        if(r != p){
+            std::swap_ranges(a.begin() + (size_t)p * n, a.begin() + (size_t)(p+1) * n, a.begin() + (size_t)r * n);
+            std::swap(x[p], x[r]);
+        }
+        double inv = 1.0 / a[(size_t)p * n + p];
+        for(int i = p+1; i < n; i++){
+            double f = a[(size_t)i * n + p] * inv;
+            if(f == 0){
+                continue;
+            }
+            for(int j = p; j < n; j++){
+                a[(size_t)i * n + j] -= f * a[(size_t)p * n + j];
+            }
+            x[i] -= f * x[p];
+        }
+    }
+    for(int i = n-1; i >= 0; i--){
+        double s = x[i];
+        for(int j = i+1; j < n; j++){
+            s -= a[(size_t)i * n + j] * x[j];
+        }
+        x[i] = s / a[(size_t)i * n + i];
+    }
+    return true;
+}
+
+void SolverDaemon::respond(Problem& problem, uint32_t status, const double* x, Clock::time_point started, uint64_t solve_ns, uint32_t batch_size){
+    solverProtocol::ResponseHeader header;
+    header.magic = solverProtocol::RESPONSE_MAGIC;
+    header.status = status;
+    header.request_id = problem.request_id;
+    header.queue_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(started - problem.received).count();
+    header.solve_ns = solve_ns;
+    header.variable_amount = problem.variable_amount;
+    header.batch_size = batch_size;
+    std::lock_guard<std::mutex> lock(problem.connection->write_mutex);
+    solverProtocol::writeFully(problem.connection->out_fd, &header, sizeof(header));
+    if(status == solverProtocol::OK){
+        solverProtocol::writeFully(problem.connection->out_fd, x, sizeof(double) * problem.variable_amount);
+    }
+}
+
+//接続が閉じられるまで要求フレームを読み続ける
+void SolverDaemon::serveStream(std::shared_ptr<Connection> connection){
+    while(true){
+        solverProtocol::RequestHeader header;
+        if(!solverProtocol::readFully(connection->in_fd, &header, sizeof(header))){
+            return;
+        }
+        if(header.magic != solverProtocol::REQUEST_MAGIC || header.variable_amount == 0
+            || header.variable_amount > solverProtocol::MAX_VARIABLES){
+            std::cerr << "error : 不正な要求フレームです" << std::endl;
+            return;
+        }
+        //確保する前に大きさを確かめる(後に続く本体を読み飛ばせないので接続を閉じる)
+        if(solverDaemon::requestBytes(header.variable_amount) > solverDaemon::MAX_REQUEST_BYTES){
+            std::cerr << "error : 要求が大きすぎます(n = " << header.variable_amount << ", "
+                << solverDaemon::requestBytes(header.variable_amount) << " バイト, 上限 " << solverDaemon::MAX_REQUEST_BYTES << " バイト)" << std::endl;
+            return;
+        }
+        Problem problem;
+        problem.connection = connection;
+        problem.request_id = header.request_id;
+        problem.variable_amount = header.variable_amount;
+        problem.a.resize((size_t)header.variable_amount * header.variable_amount);
+        problem.b.resize(header.variable_amount);
+        if(!solverProtocol::readFully(connection->in_fd, problem.a.data(), problem.a.size() * sizeof(double))
+            || !solverProtocol::readFully(connection->in_fd, problem.b.data(), problem.b.size() * sizeof(double))){
+            return;
+        }
+        problem.received = Clock::now();
+        enqueue(std::move(problem));
+    }
+}
+
+//Unixドメインソケットで接続を受け付ける(接続ごとに読み込みスレッドを立てる)
+bool SolverDaemon::serveSocket(std::string path){
+    sockaddr_un address;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0 || !solverProtocol::fillAddress(path, address)){
+        std::cerr << "error : ソケットを作成できません: " << path << std::endl;
+        return false;
+    }
+    unlink(path.c_str());
+    if(bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0){
+        std::cerr << "error : ソケットで待ち受けできません: " << path << std::endl;
+        close(listener);
+        return false;
+    }
+    printf("待ち受け中: %s\n", path.c_str());
+    fflush(stdout);
+    while(true){
+        int fd = accept(listener, NULL, NULL);
+        if(fd < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            break;
+        }
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+        connection->in_fd = fd;
+        connection->out_fd = fd;
+        connection->owns_fd = true;
+        std::thread(&SolverDaemon::serveStream, this, connection).detach();
+    }
+    close(listener);
+    return true;
+}
+
+
+int main(int argc, char* argv[]){
+    //引数: --stdio または --socket <path>、続けて [スレッド数]。どこにでも --max-mb <MB>(1つの要求の上限)を置ける
+    signal(SIGPIPE, SIG_IGN);
+    std::vector<char*> args;
+    for(int i = 0; i < argc; i++){
+        if(std::string(argv[i]) == "--max-mb" && i + 1 < argc){
+            solverDaemon::MAX_REQUEST_BYTES = (size_t)atol(argv[++i]) << 20;
+        }else{
+            args.push_back(argv[i]);
+        }
+    }
+    argc = args.size();
+    argv = args.data();
+    if(argc < 2){
+        fprintf(stderr, "usage: %s --stdio [threads] | --socket <path> [threads] [--max-mb MB]\n", argv[0]);
+        return 1;
+    }
+    std::string mode = argv[1];
+    if(mode == "--stdio"){
+        int threads = argc > 2 ? atoi(argv[2]) : threadPool::THREADS;
+        SolverDaemon daemon(threads);
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+        connection->in_fd = 0;
+        connection->out_fd = 1;
+        connection->owns_fd = false;
+        daemon.serveStream(connection);
+        daemon.drain();
+        return 0;
+    }else if(mode == "--socket" && argc > 2){
+        int threads = argc > 3 ? atoi(argv[3]) : threadPool::THREADS;
+        SolverDaemon daemon(threads);
+        return daemon.serveSocket(argv[2]) ? 0 : 1;
+    }
+    fprintf(stderr, "usage: %s --stdio [threads] | --socket <path> [threads] [--max-mb MB]\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,107 @@
+#include <math.h>
+#include <vector>
+#include "solverLibrary.h"
+#include "LU.h"
+#include "gaussJordan.h"
+#include "horner.h"
+#include "leastSquare.h"
+
+/* --- --- solverLibrary.hの実装 --- ---
+各関数はC++の例外を捕まえて状態コードに変える(ctypesからはC++の例外を扱えない)。
+スレッドプールは最初に使うときに1つだけ作り、呼び出しの間で使い回す。
+--- --- --- --- */
+namespace solverLibrary{
+    inline ThreadPool& pool(){
+        static ThreadPool shared;
+        return shared;
+    }
+
+    //行優先の a と b から拡大係数行列を作る
+    inline std::vector<std::vector<long double> > augmented(int n, const double* a, const double* b){
+        std::vector<std::vector<long double> > matrix(n, std::vector<long double>(n + 1));
+        for(int i = 0; i < n; i++){
+            for(int j = 0; j < n; j++){
+                matrix[i][j] = a[(size_t)i * n + j];
+            }
+            matrix[i][n] = b[i];
+        }
+        return matrix;
+    }
+
+    inline int copyAnswer(const std::vector<long double>& answer, int n, double* x){
+        if((int)answer.size() != n){
+            return SOLVER_SINGULAR;
+        }
+        for(int i = 0; i < n; i++){
+            if(!std::isfinite(answer[i])){
+                return SOLVER_SINGULAR;
+            }
+            x[i] = answer[i];
+        }
+        return SOLVER_OK;
+    }
+}
+
+extern "C" int solver_abi_version(void){
+    return SOLVER_ABI_VERSION;
+}
+
+extern "C" int solver_lu(int n, const double* a, const double* b, double* x){
+    if(n <= 0 || a == NULL || b == NULL || x == NULL){
+        return SOLVER_INVALID;
+    }
+    try{
+        LU solver(n, solverLibrary::augmented(n, a, b));
+        Workspace workspace(LU::workspaceSize(n));
+        std::vector<long double> answer(n);
+        if(!solver.runLU(workspace, answer.data())){
+            return SOLVER_FAILED;
+        }
+        return solverLibrary::copyAnswer(answer, n, x);
+    }catch(...){
+        return SOLVER_FAILED;
+    }
+}
+
+extern "C" int solver_gauss_jordan(int n, const double* a, const double* b, double* x){
+    if(n <= 0 || a == NULL || b == NULL || x == NULL){
+        return SOLVER_INVALID;
+    }
+    try{
+        GaussJordan solver(n, solverLibrary::augmented(n, a, b));
+        solver.setVerbose(false);
+        return solverLibrary::copyAnswer(solver.runGaussJordan(), n, x);
+    }catch(...){
+        return SOLVER_FAILED;
+    }
+}
+
+extern "C" void solver_polyval(const double* c, int degree, size_t count, const double* x, double* y){
+    if(c == NULL || x == NULL || y == NULL || degree < 0){
+        return;
+    }
+    horner::evaluateMany(c, degree, count, x, y);
+}
+
+extern "C" int solver_polyfit(int degree, size_t count, const double* x, const double* y, double* coefficients, int method){
+    if(degree < 0 || x == NULL || y == NULL || coefficients == NULL){
+        return SOLVER_INVALID;
+    }
+    try{
+        if(method == SOLVER_FIT_NORMAL){
+            LeastSquare fitter(degree, &solverLibrary::pool());
+            fitter.add(x, y, count);
+            std::vector<long double> answer = fitter.fit();
+            return solverLibrary::copyAnswer(answer, degree + 1, coefficients);
+        }
+        if(method != SOLVER_FIT_QR){
+            return SOLVER_INVALID;
+        }
+        QRLeastSquare fitter(degree + 1, &solverLibrary::pool());
+        fitter.addPolynomial(x, y, count);
+        std::vector<double> answer = fitter.solve();
+        return solverLibrary::copyAnswer(std::vector<long double>(answer.begin(), answer.end()), degree + 1, coefficients);
+    }catch(...){
+        return SOLVER_FAILED;
+    }
+}
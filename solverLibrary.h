@@ -0,0 +1,44 @@
+#ifndef SOLVER_LIBRARY_H
+#define SOLVER_LIBRARY_H
+
+#include <stddef.h>
+
+/* --- --- ソルバーのCインターフェース(共有ライブラリ) --- ---
+C++のクラスをC言語の関数として公開し、Python(ctypes)などから呼べるようにする。
+作り方: g++ -std=c++17 -O2 -shared -fPIC -pthread solverLibrary.cpp -o libsolver.so
+・配列は全てdoubleの連続した領域へのポインタで受け取り、コピーせずに読む(NumPyの配列のバッファをそのまま渡せる)
+・結果は呼び出し側が用意した領域へ書く(ライブラリ側でメモリを確保して返すことはしない)
+・戻り値は状態コード(SOLVER_OKなど)。例外はライブラリの外へ出さない
+・関数を増やすときは既存の関数の引数を変えずに新しい名前で追加し、SOLVER_ABI_VERSIONを上げる
+--- --- --- --- */
+#define SOLVER_ABI_VERSION 1
+
+#define SOLVER_OK 0
+#define SOLVER_SINGULAR 1 //解が一意に定まらない(ピボットが0、階数落ち)
+#define SOLVER_INVALID 2 //引数が不正
+#define SOLVER_FAILED 3 //その他の失敗(メモリ不足など)
+
+#define SOLVER_FIT_QR 0 //ハウスホルダーQR(TSQR)
+#define SOLVER_FIT_NORMAL 1 //べき和の正規方程式(コレスキー分解)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int solver_abi_version(void);
+
+//n元連立方程式 Ax = b (aは行優先 n*n)
+int solver_lu(int n, const double* a, const double* b, double* x); //LU分解法(ピボット選択なし)
+int solver_gauss_jordan(int n, const double* a, const double* b, double* x); //ガウスジョルダン法(行の入れ替えあり)
+
+//多項式 c_0 + c_1 x + ... + c_d x^d を count 点で評価する
+void solver_polyval(const double* c, int degree, size_t count, const double* x, double* y);
+
+//count点に degree 次多項式を当てはめ、coefficients に degree + 1 個の係数(昇べきの順)を書く
+int solver_polyfit(int degree, size_t count, const double* x, const double* y, double* coefficients, int method);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef SOLVER_PROTOCOL_H
+#define SOLVER_PROTOCOL_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* --- --- 常駐ソルバー(solverDaemon.cpp)との通信形式 --- ---
+Unixドメインソケット、または標準入出力の上でフレームを順に送る。数値は全てリトルエンディアン。
+
+要求フレーム(クライアント -> デーモン)
+    RequestHeader(16バイト)
+    double A[n*n]  係数行列(行優先)
+    double b[n]    右辺ベクトル
+応答フレーム(デーモン -> クライアント)。応答は要求の順とは限らないのでrequest_idで対応をとる
+    ResponseHeader(40バイト)
+    double x[n]    解(statusがOKの場合のみ)
+--- --- --- --- */
+namespace solverProtocol{
+    const uint32_t REQUEST_MAGIC  = 0x5153414E; //"NASQ"
+    const uint32_t RESPONSE_MAGIC = 0x5253414E; //"NASR"
+    const uint32_t OK = 0;
+    const uint32_t SINGULAR = 1; //解が一意に定まらない
+    const uint32_t MAX_VARIABLES = 1 << 16; //形式上の上限。デーモンはバイト数の上限(solverDaemon::MAX_REQUEST_BYTES)でさらに制限する
+
+    struct RequestHeader{
+        uint32_t magic;
+        uint32_t variable_amount;
+        uint64_t request_id;
+    };
+
+    struct ResponseHeader{
+        uint32_t magic;
+        uint32_t status;
+        uint64_t request_id;
+        uint64_t queue_ns; //受信してから解き始めるまでの時間
+        uint64_t solve_ns; //解くのにかかった時間(バッチの場合はバッチ全体と、その問題の残差の確認・解き直し)
+        uint32_t variable_amount;
+        uint32_t batch_size; //一緒に解いた問題数(1なら単独)
+    };
+    static_assert(sizeof(RequestHeader) == 16, "request header must be 16 bytes");
+    static_assert(sizeof(ResponseHeader) == 40, "response header must be 40 bytes");
+
+    //全て読み切るまで繰り返す(相手が閉じたらfalse)
+    inline bool readFully(int fd, void* buffer, size_t bytes){
+        char* p = (char*)buffer;
+        while(bytes > 0){
+            ssize_t r = read(fd, p, bytes);
+            if(r < 0 && errno == EINTR){
+                continue;
+            }
+            if(r <= 0){
+                return false;
+            }
+            p += r;
+            bytes -= r;
+        }
+        return true;
+    }
+
+    inline bool writeFully(int fd, const void* buffer, size_t bytes){
+        const char* p = (const char*)buffer;
+        while(bytes > 0){
+            ssize_t r = write(fd, p, bytes);
+            if(r < 0 && errno == EINTR){
+                continue;
+            }
+            if(r <= 0){
+                return false;
+            }
+            p += r;
+            bytes -= r;
+        }
+        return true;
+    }
+
+    inline bool fillAddress(std::string path, sockaddr_un& address){
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(address.sun_path)){
+            return false;
+        }
+        strcpy(address.sun_path, path.c_str());
+        return true;
+    }
+}
+
+#endif
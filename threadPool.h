@@ -0,0 +1,127 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+/* --- --- スレッドプール --- ---
+起動したスレッドを使い回して仕事(関数)を順に実行する。
+parallelForは区間[begin, end)をスレッド数で分けて実行し、全て終わるまで待つ。
+(プールの仕事の中からparallelForを呼ぶと、空きスレッドが無くなり止まることがあるので呼ばないこと)
+--- --- --- --- */
+namespace threadPool{
+    inline int THREADS = std::max(1u, std::thread::hardware_concurrency()); //既定のスレッド数
+}
+
+class ThreadPool{
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > tasks;
+    std::mutex mutex;
+    std::condition_variable task_ready;
+    std::condition_variable all_done;
+    size_t active = 0; //実行中の仕事の数
+    bool stopping = false;
+    void work();
+public:
+    ThreadPool(int threads = threadPool::THREADS);//コンストラクター
+    ~ThreadPool();
+    void submit(std::function<void()> task);
+    void wait(); //投入した全ての仕事が終わるまで待つ
+    int size();
+    template<class F> void parallelFor(size_t begin, size_t end, F f); //f(i)を各iについて実行する
+};
+
+
+//コンストラクター
+inline ThreadPool::ThreadPool(int threads){
+    for(int t = 0; t < std::max(1, threads); t++){
+        workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+}
+
+inline ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_ready.notify_all();
+    for(std::thread& w : workers){
+        w.join();
+    }
+}
+
+inline void ThreadPool::work(){
+    while(true){
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_ready.wait(lock, [this](){ return stopping || !tasks.empty(); });
+            if(tasks.empty()){
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            active++;
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active--;
+            if(active == 0 && tasks.empty()){
+                all_done.notify_all();
+            }
+        }
+    }
+}
+
+inline void ThreadPool::submit(std::function<void()> task){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    task_ready.notify_one();
+}
+
+inline void ThreadPool::wait(){
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [this](){ return active == 0 && tasks.empty(); });
+}
+
+inline int ThreadPool::size(){
+    return workers.size();
+}
+
+template<class F>
+inline void ThreadPool::parallelFor(size_t begin, size_t end, F f){
+    if(begin >= end){
+        return;
+    }
+    size_t chunks = std::min<size_t>(workers.size(), end - begin);
+    size_t step = (end - begin + chunks - 1) / chunks;
+    std::mutex done_mutex;
+    std::condition_variable done;
+    size_t remaining = chunks;
+    for(size_t c = 0; c < chunks; c++){
+        size_t from = begin + c * step;
+        size_t to = std::min(end, from + step);
+        submit([&, from, to](){
+            for(size_t i = from; i < to; i++){
+                f(i);
+            }
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if(--remaining == 0){
+                done.notify_all();
+            }
+        });
+    }
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&](){ return remaining == 0; });
+}
+
+#endif
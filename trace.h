@@ -0,0 +1,302 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/* --- --- 計測(トレース) --- ---
+ソルバーの内側のループに置く計測用のマクロ。SOLVER_TRACEを定義してコンパイルしたときだけ有効になり、
+定義しなければ全て空の文になる(引数も評価しないので、通常のビルドでは計測の費用が0になる)。
+    g++ -std=c++17 -O2 -DSOLVER_TRACE SOR.cpp
+
+TRACE_SOLVE(name)    : そのスコープを1回の解法とし、終わったときに下の値の増分をプロファイルとして記録する
+TRACE_SCOPE(name)    : そのスコープの実行時間と回数を区間nameに足す
+TRACE_COUNT(name, n) : カウンターnameにnを足す(反復回数、関数の評価回数など)
+TRACE_FLOPS(n)       : 浮動小数点演算数のカウンター"flops"にnを足す
+TRACE_DEBUG(...)     : 途中経過の表示などの文。trace::VERBOSEのときだけ実行する
+各名前の記録は最初に通ったときに1度だけ登録し、以後は原子的な足し算だけをする(スレッドプールの中からも使える)。
+Linuxでは TRACE_SOLVE の間、perf_event_open でそのスレッドのサイクル数、命令数、キャッシュミス、分岐予測ミスも数える
+(権限が無いなどで開けなければ記録しない。プールの他のスレッドの分は入らない)。
+プロファイルはプログラムの終了時に環境変数 SOLVER_TRACE_OUTPUT のファイル(無ければ標準エラー出力)へJSONで書く。
+--- --- --- --- */
+#ifdef SOLVER_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <string>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace trace{
+    inline bool VERBOSE = true; //TRACE_DEBUGの文を実行する
+    inline bool HARDWARE = true; //ハードウェアカウンターを読む
+    const int HARDWARE_COUNTERS = 4;
+    const char* const HARDWARE_NAMES[HARDWARE_COUNTERS] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+    //区間(phase)なら value は合計のナノ秒、calls は回数。カウンターなら value だけを使う
+    struct Entry{
+        const char* name;
+        bool phase;
+        std::atomic<long long> value{0};
+        std::atomic<long long> calls{0};
+        Entry(const char* name, bool phase) : name(name), phase(phase){}//コンストラクター
+    };
+
+    //1回の解法の記録
+    struct Profile{
+        std::string name;
+        double seconds = 0;
+        std::vector<std::pair<std::string, long long> > counters;
+        std::vector<std::pair<std::string, std::pair<double, long long> > > phases; //(秒, 回数)
+        bool hardware = false;
+        long long hardware_values[HARDWARE_COUNTERS] = {0};
+    };
+
+    void writeProfiles(FILE* fp, const std::vector<Profile>& list);
+
+    struct Registry{
+        std::mutex mutex;
+        std::deque<Entry> entries; //伸ばしても要素の場所が変わらないのでEntry&を持ち続けられる
+        std::vector<Profile> profiles;
+        ~Registry(){
+            if(profiles.empty()){
+                return;
+            }
+            const char* path = getenv("SOLVER_TRACE_OUTPUT");
+            FILE* fp = path != NULL ? fopen(path, "w") : NULL;
+            writeProfiles(fp != NULL ? fp : stderr, profiles);
+            if(fp != NULL){
+                fclose(fp);
+            }
+        }
+    };
+
+    inline Registry& registry(){
+        static Registry shared;
+        return shared;
+    }
+
+    inline Entry& entry(const char* name, bool phase){
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for(Entry& e : r.entries){
+            if(e.phase == phase && strcmp(e.name, name) == 0){
+                return e;
+            }
+        }
+        r.entries.emplace_back(name, phase);
+        return r.entries.back();
+    }
+
+    inline long long now(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    class Scope{
+    private:
+        Entry& target;
+        long long start;
+    public:
+        Scope(Entry& target) : target(target), start(now()){}//コンストラクター
+        ~Scope(){
+            target.value.fetch_add(now() - start, std::memory_order_relaxed);
+            target.calls.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    //呼び出したスレッドのハードウェアカウンター
+    class Hardware{
+    private:
+        int fd[HARDWARE_COUNTERS];
+    public:
+        Hardware();//コンストラクター
+        ~Hardware();
+        bool read(long long* values);
+    };
+
+    inline Hardware::Hardware(){
+        for(int i = 0; i < HARDWARE_COUNTERS; i++){
+            fd[i] = -1;
+        }
+#ifdef __linux__
+        if(!HARDWARE){
+            return;
+        }
+        const unsigned long long config[HARDWARE_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for(int i = 0; i < HARDWARE_COUNTERS; i++){
+            perf_event_attr attribute;
+            memset(&attribute, 0, sizeof(attribute));
+            attribute.type = PERF_TYPE_HARDWARE;
+            attribute.size = sizeof(attribute);
+            attribute.config = config[i];
+            attribute.exclude_kernel = 1;
+            attribute.exclude_hv = 1;
+            fd[i] = syscall(SYS_perf_event_open, &attribute, 0, -1, -1, 0);
+        }
+#endif
+    }
+
+    inline Hardware::~Hardware(){
+#ifdef __linux__
+        for(int i = 0; i < HARDWARE_COUNTERS; i++){
+            if(fd[i] >= 0){
+                close(fd[i]);
+            }
+        }
+#endif
+    }
+
+    //全てのカウンターが読めたときだけtrue
+    inline bool Hardware::read(long long* values){
+#ifdef __linux__
+        for(int i = 0; i < HARDWARE_COUNTERS; i++){
+            if(fd[i] < 0 || ::read(fd[i], &values[i], sizeof(long long)) != (ssize_t)sizeof(long long)){
+                return false;
+            }
+        }
+        return true;
+#else
+        (void)values;
+        return false;
+#endif
+    }
+
+    //開始時と終了時の値の差をプロファイルにする(入れ子にしてもよい)
+    class Solve{
+    private:
+        const char* name;
+        long long start;
+        std::vector<std::pair<long long, long long> > before; //entriesの順の(value, calls)
+        Hardware hardware;
+        long long hardware_before[HARDWARE_COUNTERS];
+        bool hardware_valid;
+        std::vector<std::pair<long long, long long> > snapshot();
+    public:
+        Solve(const char* name);//コンストラクター
+        ~Solve();
+    };
+
+    inline std::vector<std::pair<long long, long long> > Solve::snapshot(){
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::vector<std::pair<long long, long long> > values;
+        values.reserve(r.entries.size());
+        for(Entry& e : r.entries){
+            values.push_back(std::make_pair(e.value.load(), e.calls.load()));
+        }
+        return values;
+    }
+
+    inline Solve::Solve(const char* name) : name(name){
+        before = snapshot();
+        hardware_valid = hardware.read(hardware_before);
+        start = now();
+    }
+
+    inline Solve::~Solve(){
+        long long elapsed = now() - start;
+        long long hardware_after[HARDWARE_COUNTERS];
+        hardware_valid = hardware_valid && hardware.read(hardware_after);
+        std::vector<std::pair<long long, long long> > after = snapshot();
+
+        Profile profile;
+        profile.name = name;
+        profile.seconds = elapsed * 1e-9;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for(size_t i = 0; i < after.size(); i++){
+            std::pair<long long, long long> base = i < before.size() ? before[i] : std::make_pair(0LL, 0LL);
+            long long value = after[i].first - base.first, calls = after[i].second - base.second;
+            const Entry& e = r.entries[i];
+            if(e.phase && calls > 0){
+                profile.phases.push_back(std::make_pair(std::string(e.name), std::make_pair(value * 1e-9, calls)));
+            }else if(!e.phase && value != 0){
+                profile.counters.push_back(std::make_pair(std::string(e.name), value));
+            }
+        }
+        if(hardware_valid){
+            profile.hardware = true;
+            for(int i = 0; i < HARDWARE_COUNTERS; i++){
+                profile.hardware_values[i] = hardware_after[i] - hardware_before[i];
+            }
+        }
+        r.profiles.push_back(profile);
+    }
+
+    inline std::vector<Profile> profiles(){
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        return r.profiles;
+    }
+
+    //記録したプロファイルを消す(終了時に書き出さなくなる)
+    inline void clear(){
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.profiles.clear();
+    }
+
+    inline void writeProfiles(FILE* fp, const std::vector<Profile>& list){
+        fprintf(fp, "{\n  \"profiles\": [\n");
+        for(size_t p = 0; p < list.size(); p++){
+            const Profile& profile = list[p];
+            fprintf(fp, "    {\"solver\": \"%s\", \"seconds\": %.9g, \"counters\": {", profile.name.c_str(), profile.seconds);
+            for(size_t i = 0; i < profile.counters.size(); i++){
+                fprintf(fp, "%s\"%s\": %lld", i > 0 ? ", " : "", profile.counters[i].first.c_str(), profile.counters[i].second);
+            }
+            fprintf(fp, "}, \"phases\": {");
+            for(size_t i = 0; i < profile.phases.size(); i++){
+                fprintf(fp, "%s\"%s\": {\"seconds\": %.9g, \"calls\": %lld}", i > 0 ? ", " : "",
+                    profile.phases[i].first.c_str(), profile.phases[i].second.first, profile.phases[i].second.second);
+            }
+            fprintf(fp, "}");
+            if(profile.hardware){
+                fprintf(fp, ", \"hardware\": {");
+                for(int i = 0; i < HARDWARE_COUNTERS; i++){
+                    fprintf(fp, "%s\"%s\": %lld", i > 0 ? ", " : "", HARDWARE_NAMES[i], profile.hardware_values[i]);
+                }
+                fprintf(fp, "}");
+            }
+            fprintf(fp, "}%s\n", p + 1 < list.size() ? "," : "");
+        }
+        fprintf(fp, "  ]\n}\n");
+    }
+
+    inline void exportJSON(FILE* fp){
+        writeProfiles(fp, profiles());
+    }
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SOLVE(name) trace::Solve TRACE_CONCAT(trace_solve_, __LINE__)(name)
+#define TRACE_SCOPE(name) \
+    static trace::Entry& TRACE_CONCAT(trace_phase_, __LINE__) = trace::entry(name, true); \
+    trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(TRACE_CONCAT(trace_phase_, __LINE__))
+#define TRACE_COUNT(name, n) do{ \
+        static trace::Entry& trace_counter = trace::entry(name, false); \
+        trace_counter.value.fetch_add((long long)(n), std::memory_order_relaxed); \
+    }while(0)
+#define TRACE_FLOPS(n) TRACE_COUNT("flops", n)
+#define TRACE_DEBUG(...) do{ if(trace::VERBOSE){ __VA_ARGS__; } }while(0)
+
+#else
+
+#define TRACE_SOLVE(name) ((void)0)
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_COUNT(name, n) ((void)0)
+#define TRACE_FLOPS(n) ((void)0)
+#define TRACE_DEBUG(...) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <memory>
+#include <iostream>
+
+/* --- --- 作業領域(アリーナ) --- ---
+ソルバーが1回の実行で使う一時的な配列を、呼び出し側が用意した1つの領域から切り出す。
+    Workspace workspace(SOR::workspaceSize(n)); //一度だけ確保する
+    for(...){ solver.setRightHandSide(b); solver.runSOR(workspace, x); } //以後の実行ではヒープ確保をしない
+・allocateは先頭から順に切り出すだけ(ALIGNMENTバイト境界にそろえる)で、個別には解放しない
+・各ソルバーの run(workspace, ...) は始めに mark を取り、終わるときに release で元に戻す(WorkspaceScope)
+・必要な大きさは各ソルバーの静的関数 workspaceSize(次元) で求める(bytesFor<T>(個数)の和)
+・足りなければ "error : ..." を表示してNULLを返し、ソルバーは失敗として扱う(途中で伸ばすと切り出した領域が無効になるため)
+SOLVER_TRACEを定義したビルドでは計測の記録にヒープを使うので、確保が0になるのは通常のビルドだけ。
+--- --- --- --- */
+namespace workspace{
+    const size_t ALIGNMENT = 64; //キャッシュラインの大きさ
+}
+
+class Workspace{
+private:
+    std::unique_ptr<unsigned char[]> buffer;
+    unsigned char* base = NULL; //bufferのALIGNMENTにそろえた先頭
+    size_t size = 0; //使えるバイト数
+    size_t offset = 0; //使用中のバイト数
+    size_t peak = 0; //使用中のバイト数の最大
+public:
+    Workspace(size_t bytes = 0);//コンストラクター
+    void reserve(size_t bytes); //bytes以上にする(切り出した領域は全て無効になる)
+    template<class T> T* allocate(size_t count);
+    size_t mark();
+    void release(size_t mark); //markの時点まで戻す
+    void reset();
+    size_t capacity();
+    size_t used();
+    size_t getPeak();
+    template<class T> static size_t bytesFor(size_t count); //allocate<T>(count)が使うバイト数
+};
+
+//コンストラクターでmarkを取り、デストラクターで戻す
+class WorkspaceScope{
+private:
+    Workspace& workspace;
+    size_t saved;
+public:
+    WorkspaceScope(Workspace& workspace) : workspace(workspace), saved(workspace.mark()){}//コンストラクター
+    ~WorkspaceScope(){
+        workspace.release(saved);
+    }
+};
+
+
+//コンストラクター
+inline Workspace::Workspace(size_t bytes){
+    reserve(bytes);
+}
+
+inline void Workspace::reserve(size_t bytes){
+    if(bytes <= size && base != NULL){
+        offset = 0;
+        return;
+    }
+    buffer.reset(new unsigned char[bytes + workspace::ALIGNMENT]);
+    uintptr_t address = (uintptr_t)buffer.get();
+    base = buffer.get() + (workspace::ALIGNMENT - address % workspace::ALIGNMENT) % workspace::ALIGNMENT;
+    size = bytes;
+    offset = 0;
+}
+
+template<class T> inline T* Workspace::allocate(size_t count){
+    size_t bytes = bytesFor<T>(count);
+    if(bytes > size - offset){
+        std::cerr << "error : 作業領域が足りません(" << offset + bytes << " バイト必要, " << size << " バイト)" << std::endl;
+        return NULL;
+    }
+    T* result = reinterpret_cast<T*>(base + offset);
+    offset += bytes;
+    if(offset > peak){
+        peak = offset;
+    }
+    return result;
+}
+
+inline size_t Workspace::mark(){
+    return offset;
+}
+
+inline void Workspace::release(size_t mark){
+    if(mark <= offset){
+        offset = mark;
+    }
+}
+
+inline void Workspace::reset(){
+    offset = 0;
+}
+
+inline size_t Workspace::capacity(){
+    return size;
+}
+
+inline size_t Workspace::used(){
+    return offset;
+}
+
+inline size_t Workspace::getPeak(){
+    return peak;
+}
+
+template<class T> inline size_t Workspace::bytesFor(size_t count){
+    size_t bytes = count * sizeof(T);
+    return (bytes + workspace::ALIGNMENT - 1) / workspace::ALIGNMENT * workspace::ALIGNMENT;
+}
+
+#endif